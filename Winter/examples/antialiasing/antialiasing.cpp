@@ -20,6 +20,7 @@
 
 #include "camera.h"
 #include "fpsCounter.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -91,7 +92,7 @@ int main()
     // For easy MSAA
 	// ------------------------------------
 	//glfwWindowHint(GLFW_SAMPLES, 4);
-	//glEnable(GL_MULTISAMPLE);
+	// then GLState::enable(GL_MULTISAMPLE); once the context is current
 	// ------------------------------------
 #ifdef __APPLE__
     // MAC only line to enable forward compatibility
@@ -118,7 +119,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -165,7 +166,7 @@ int main()
     unsigned int VAOpoints, VBOpoints;
     glGenVertexArrays(1, &VAOpoints);
     glGenBuffers(1, &VBOpoints);
-	glBindVertexArray(VAOpoints);
+	GLState::bindVertexArray(VAOpoints);
 	glBindBuffer(GL_ARRAY_BUFFER, VBOpoints);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(points), points, GL_STATIC_DRAW);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*) 0);
@@ -173,23 +174,23 @@ int main()
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*) (2 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 
     // FBO
 	// ------------------------------------
     unsigned int fbo;
 	glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
 
     // Attachment Color Buffer Multisampling anti-aliasing
     int samples = 4;
     unsigned int textureFBOMSAA;
     glGenTextures(1, &textureFBOMSAA);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, textureFBOMSAA);
+    GLState::bindTexture(GL_TEXTURE_2D_MULTISAMPLE, textureFBOMSAA);
     glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, GL_RGB, WINDOW_WIDTH, WINDOW_HEIGHT, GL_TRUE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    GLState::bindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
     
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, textureFBOMSAA, 0);
 
@@ -207,23 +208,23 @@ int main()
 		std::cout << "Failed to create Framebuffer" << std::endl;
         return -1;
 	}
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	// Intermediary fbo for multisampling
     unsigned int fboIntermediary;
     glGenFramebuffers(1, &fboIntermediary);
-    glBindFramebuffer(GL_FRAMEBUFFER, fboIntermediary);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, fboIntermediary);
 
     // Attachment Color Buffer Multisampling anti-aliasing
     unsigned int textureFBOIntermediary;
     glGenTextures(1, &textureFBOIntermediary);
-    glBindTexture(GL_TEXTURE_2D, textureFBOIntermediary);
+    GLState::bindTexture(GL_TEXTURE_2D, textureFBOIntermediary);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
 
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureFBOIntermediary, 0);
 
@@ -278,14 +279,14 @@ int main()
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         
         // matrixes
         glm::mat4 view = camera.getViewMatrix();
@@ -298,7 +299,7 @@ int main()
 
         // Draw scene
 		// ------------------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
         glClearColor(0.1f, 0.4f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT); 
 
@@ -308,14 +309,14 @@ int main()
         unlitShader.setMat4("model", value_ptr(model));
         cubeModel.draw(unlitShader);
 
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fboIntermediary);
+		GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+		GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, fboIntermediary);
 		glBlitFramebuffer(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		glDisable(GL_DEPTH_TEST);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, textureFBOIntermediary);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::disable(GL_DEPTH_TEST);
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_2D, textureFBOIntermediary);
 		screenShader.use();
 		screenShader.setInt("screenTexture", 0);
 		quad.draw(screenShader);
@@ -329,9 +330,9 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteTextures(1, &containerTexture);
-    glDeleteFramebuffers(1, &fbo);
-	glDeleteFramebuffers(1, &fboIntermediary);
+    GLState::deleteTextures(1, &containerTexture);
+    GLState::deleteFramebuffers(1, &fbo);
+	GLState::deleteFramebuffers(1, &fboIntermediary);
 
     glfwTerminate();
 
@@ -380,7 +381,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
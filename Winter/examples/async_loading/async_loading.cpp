@@ -0,0 +1,153 @@
+﻿// Benchmark: Asynchronous model loading
+// Loads a model in the middle of a render loop and reports the frame time spikes, either with a blocking load or with Model::loadAsync.
+// Usage: async_loading [sync|async] [model path]
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "meshCache.h"
+#include "model.h"
+#include "pathManager.h"
+#include "textureCache.h"
+
+void printFrameReport(const std::string& mode, std::vector<double> frameTimesMs, double loadMs);
+
+int main(int argc, char* argv[])
+{
+    // Init Paths
+    PathManager::projectPath = std::filesystem::current_path().string() + "/";
+
+    // DATA
+    // ------------------------------------
+    const std::string WINDOW_TITLE = "Async Loading Benchmark";
+    const int SCR_WIDTH = 800;
+    const int SCR_HEIGHT = 600;
+    const int NB_FRAMES = 600;
+    const int LOAD_FRAME = 10;
+
+    const bool isAsync = argc < 2 || std::string(argv[1]) != "sync";
+    const std::string modelPath = argc >= 3 ? argv[2] : PathManager::getModelsPath() + "nanosuit/nanosuit.obj";
+    if (!std::filesystem::exists(modelPath))
+    {
+        std::cout << "Missing model: " << modelPath << std::endl;
+        return -1;
+    }
+    // cold start, the import has to go through assimp
+    std::filesystem::remove(MeshCache::getCachePath(modelPath));
+
+    // INIT GLFW
+    // ------------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    // MAC only line to enable forward compatibility
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, WINDOW_TITLE.c_str(), nullptr, nullptr);
+    if (window == nullptr)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    // no vsync, the frame times have to show the cost of the frame itself
+    glfwSwapInterval(0);
+
+    // Init GLAD
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // RENDER LOOP
+    // ------------------------------------
+    std::vector<double> frameTimesMs;
+    frameTimesMs.reserve(NB_FRAMES);
+    std::future<Model> asyncModel;
+    std::vector<Model> models;
+    std::chrono::high_resolution_clock::time_point loadStart;
+    double loadMs = 0.0;
+
+    auto lastFrame = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < NB_FRAMES && !glfwWindowShouldClose(window); frame++)
+    {
+        if (frame == LOAD_FRAME)
+        {
+            loadStart = std::chrono::high_resolution_clock::now();
+            if (isAsync)
+            {
+                asyncModel = Model::loadAsync(modelPath);
+            }
+            else
+            {
+                models.emplace_back(modelPath);
+                loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+            }
+        }
+
+        Model::updateAsyncLoads();
+        if (asyncModel.valid() && asyncModel.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            models.push_back(asyncModel.get());
+            loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+        }
+
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        // wait for the GPU so that the uploads are counted in the frame that issued them
+        glFinish();
+
+        const auto currentFrame = std::chrono::high_resolution_clock::now();
+        frameTimesMs.push_back(std::chrono::duration<double, std::milli>(currentFrame - lastFrame).count());
+        lastFrame = currentFrame;
+    }
+
+    if (models.empty())
+    {
+        std::cout << "The model was not loaded within " << NB_FRAMES << " frames" << std::endl;
+    }
+    printFrameReport(isAsync ? "async" : "sync", frameTimesMs, loadMs);
+    TextureCache::showStats();
+
+    // CLEANUP
+    // ------------------------------------
+    models.clear();
+    glfwTerminate();
+
+    return 0;
+}
+
+void printFrameReport(const std::string& mode, std::vector<double> frameTimesMs, double loadMs)
+{
+    if (frameTimesMs.empty())
+    {
+        return;
+    }
+
+    const double SPIKE_THRESHOLD_MS = 33.3;
+    const size_t nbSpikes = std::count_if(frameTimesMs.begin(), frameTimesMs.end(), [SPIKE_THRESHOLD_MS](double ms) { return ms > SPIKE_THRESHOLD_MS; });
+    std::sort(frameTimesMs.begin(), frameTimesMs.end());
+    const double medianMs = frameTimesMs[frameTimesMs.size() / 2];
+    const double p99Ms = frameTimesMs[std::min(frameTimesMs.size() - 1, frameTimesMs.size() * 99 / 100)];
+    const double maxMs = frameTimesMs.back();
+
+    std::cout << "Mode: " << mode << std::endl;
+    std::cout << "Load time: " << loadMs << " ms" << std::endl;
+    std::cout << "Frame time: median " << medianMs << " ms, 99th percentile " << p99Ms << " ms, max " << maxMs << " ms" << std::endl;
+    std::cout << "Frames over " << SPIKE_THRESHOLD_MS << " ms: " << nbSpikes << " / " << frameTimesMs.size() << std::endl;
+}
@@ -8,12 +8,13 @@
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 
+#include "glState.h"
 #include "shader.h"
 #include "pathManager.h"
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void processInput(GLFWwindow* window)
@@ -66,7 +67,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
 
     // SHADERS
@@ -92,7 +93,7 @@ int main()
     glGenBuffers(1, &EBO);
     glGenVertexArrays(1, &VAO);
     // 1. bind Vertex Array Object (IMPORTANT FIRST, to bind VBO to it)
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
     // 2. copy our vertices array in a buffer for OpenGL to use
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -125,7 +126,7 @@ int main()
         //glUniform4f(vertexColorLocation, 0.0f, greenValue, 0.0f, 1.0f);
 
         // Draw VAO (object)
-        glBindVertexArray(VAO);
+        GLState::bindVertexArray(VAO);
         //glDrawElements(GL_TRIANGLES, sizeof(indices), GL_UNSIGNED_INT, 0);
 		glDrawArrays(GL_TRIANGLES, 0, 3);
 
@@ -136,7 +137,7 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteVertexArrays(1, &VAO);
+    GLState::deleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
 
@@ -9,12 +9,13 @@
 #include "GLFW/glfw3.h"
 #include "stb_image.h"
 
+#include "glState.h"
 #include "pathManager.h"
 #include "shader.h"
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void processInput(GLFWwindow* window, float& mixValue)
@@ -75,7 +76,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // SHADERS
     // ------------------------------------
@@ -94,7 +95,7 @@ int main()
     unsigned char* data = stbi_load(PATH_TEXTURE1.c_str(), & width, & height, & nrChannels, 0);
     unsigned int texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    GLState::bindTexture(GL_TEXTURE_2D, texture);
     // set the texture wrapping/filtering options (on the currently bound texture object)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -118,7 +119,7 @@ int main()
     unsigned char* data2 = stbi_load(PATH_TEXTURE2.c_str(), &width2, &height2, &nrChannels2, 0);
     unsigned int texture2;
     glGenTextures(1, &texture2);
-    glBindTexture(GL_TEXTURE_2D, texture2);
+    GLState::bindTexture(GL_TEXTURE_2D, texture2);
     // set the texture wrapping/filtering options (on the currently bound texture object)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -157,7 +158,7 @@ int main()
     glGenBuffers(1, &EBO);
     glGenVertexArrays(1, &VAO);
     // 1. bind Vertex Array Object (IMPORTANT FIRST, to bind VBO to it)
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
     // 2. copy our vertices array in a buffer for OpenGL to use
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -194,12 +195,12 @@ int main()
 		shader.setFloat("mixValue", mixValue);
 
         // Draw VAO (object)
-        glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture);
-        glActiveTexture(GL_TEXTURE0 + 1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
+        GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_2D, texture);
+        GLState::activeTexture(GL_TEXTURE0 + 1);
+        GLState::bindTexture(GL_TEXTURE_2D, texture2);
 
-        glBindVertexArray(VAO);
+        GLState::bindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, sizeof(indices)/sizeof(unsigned int), GL_UNSIGNED_INT, 0);
 		//glDrawArrays(GL_TRIANGLES, 0, 3);
 
@@ -210,11 +211,11 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteVertexArrays(1, &VAO);
+    GLState::deleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
-    glDeleteTextures(1, &texture);
-    glDeleteTextures(1, &texture2);
+    GLState::deleteTextures(1, &texture);
+    GLState::deleteTextures(1, &texture2);
 
     glfwTerminate();
 
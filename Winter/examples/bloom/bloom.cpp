@@ -20,8 +20,10 @@
 
 #include "camera.h"
 #include "fpsCounter.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
+#include "profiler.h"
 #include "shader.h"
 #include "texture.h"
 
@@ -107,7 +109,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    // For easy MSAA Don't forget to call: glEnable(GL_MULTISAMPLE);
+    // For easy MSAA Don't forget to call: GLState::enable(GL_MULTISAMPLE);
 	// ------------------------------------
 	glfwWindowHint(GLFW_SAMPLES, 4);
 	// ------------------------------------
@@ -136,7 +138,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -178,13 +180,13 @@ int main()
 
     unsigned int hdrFBO;
     glGenFramebuffers(1, &hdrFBO);
-	glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
     // create floating point color buffer
     unsigned int colorBuffers[2];
 	glGenTextures(2, colorBuffers);
     for (int i = 0; i < 2; i++)
     {
-		glBindTexture(GL_TEXTURE_2D, colorBuffers[i]);
+		GLState::bindTexture(GL_TEXTURE_2D, colorBuffers[i]);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -202,13 +204,13 @@ int main()
     glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, WINDOW_WIDTH, WINDOW_HEIGHT);
     // attach buffers
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
     {
         std::cout << "Framebuffer not complete!" << std::endl;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
     
     unsigned int pingpongFBO[2];
     unsigned int pingpongBuffers[2];
@@ -216,8 +218,8 @@ int main()
     glGenTextures(2, pingpongBuffers);
     for (int i = 0; i < 2; i++)
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[i]);
-        glBindTexture(GL_TEXTURE_2D, pingpongBuffers[i]);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[i]);
+        GLState::bindTexture(GL_TEXTURE_2D, pingpongBuffers[i]);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -279,24 +281,25 @@ int main()
 		if (frameCount % 60 == 0)
 		{
 			fpsCounter.showFPS();
+			Profiler::showStats();
 		}
         // input
         processInput(window);
 
         // rendering commands
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glEnable(GL_MULTISAMPLE);
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_MULTISAMPLE);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
         // matrixes
 		glm::mat4 model = glm::mat4(1.0f);
@@ -324,7 +327,8 @@ int main()
         shader.setFloat("material.shininess", shininessMat);
 
         // Render to HDR buffer
-        glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+        Profiler::beginScope("Scene");
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         // set lighting uniforms
 
@@ -360,39 +364,45 @@ int main()
         shader.setFloat("material.shininess", 128.0f);
         woodQuad.draw(shader);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+        Profiler::endScope();
 
+        Profiler::beginScope("Bloom blur");
         bool horizontal = true;
         int blurCount = 8;
         gaussianBlurShader.use();
         unsigned int curTexBuffer = colorBuffers[1];
         for (unsigned int i = 0; i < blurCount; i++)
         {
-            glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[horizontal]);
+            GLState::bindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[horizontal]);
             gaussianBlurShader.setInt("horizontal", horizontal);
-            glBindTexture(GL_TEXTURE_2D, curTexBuffer);
+            GLState::bindTexture(GL_TEXTURE_2D, curTexBuffer);
             renderQuad();
 
             curTexBuffer = pingpongBuffers[horizontal];
             horizontal = !horizontal;
         }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+        Profiler::endScope();
 
         // Render to quad
+        Profiler::beginScope("Tone mapping");
         hdrShader.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, colorBuffers[0]);
 		hdrShader.setInt("hdrBuffer", 0);
-        glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, curTexBuffer);
+        GLState::activeTexture(GL_TEXTURE1);
+		GLState::bindTexture(GL_TEXTURE_2D, curTexBuffer);
 		hdrShader.setInt("bloomBlur", 1);
         hdrShader.setInt("hdr", 1);
         float exposure = 1.0f;
         hdrShader.setFloat("exposure", exposure);
         quad.draw(hdrShader);
+        Profiler::endScope();
 
         // check and call events and swap the buffers
         glfwSwapBuffers(window);
+        Profiler::nextFrame();
         glfwPollEvents();
 
         lastFrameTime = curFrameTime;
@@ -400,11 +410,12 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteTextures(1, &containerTexture);
-    glDeleteTextures(1, &container2Texture);
-    glDeleteTextures(1, &container2Specular);
-	glDeleteTextures(1, &woodTexture);
-	glDeleteTextures(1, &woodTextureSpec);
+    GLState::deleteTextures(1, &containerTexture);
+    GLState::deleteTextures(1, &container2Texture);
+    GLState::deleteTextures(1, &container2Specular);
+	GLState::deleteTextures(1, &woodTexture);
+	GLState::deleteTextures(1, &woodTextureSpec);
+    Profiler::release();
 
     glfwTerminate();
 
@@ -453,7 +464,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -609,7 +620,7 @@ void renderQuad()
         // configure plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        GLState::bindVertexArray(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -623,7 +634,7 @@ void renderQuad()
         glEnableVertexAttribArray(4);
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GLState::bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
\ No newline at end of file
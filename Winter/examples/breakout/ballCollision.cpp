@@ -0,0 +1,147 @@
+#include "ballCollision.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// bounces handled in a single move, the rest of the displacement is dropped
+const unsigned int MAX_BALL_BOUNCES = 4;
+
+SweepHit SweepCircleAABB(glm::vec2 center, float radius, glm::vec2 displacement, glm::vec2 boxMin, glm::vec2 boxMax)
+{
+    const SweepHit NO_HIT = { false, 1.0f, glm::vec2(0.0f) };
+
+    // already overlapping: pushed out along the closest point, or the shallowest axis when the center is inside
+    const glm::vec2 closest = glm::clamp(center, boxMin, boxMax);
+    const glm::vec2 offset = center - closest;
+    const float distance2 = glm::dot(offset, offset);
+    if (distance2 < radius * radius)
+    {
+        glm::vec2 normal;
+        if (distance2 > 0.0f)
+            normal = offset / std::sqrt(distance2);
+        else
+        {
+            const glm::vec2 toMin = center - boxMin;
+            const glm::vec2 toMax = boxMax - center;
+            const float penetrations[4] = { toMin.x, toMax.x, toMin.y, toMax.y };
+            const glm::vec2 normals[4] = { glm::vec2(-1.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(0.0f, -1.0f), glm::vec2(0.0f, 1.0f) };
+            normal = normals[std::min_element(penetrations, penetrations + 4) - penetrations];
+        }
+        if (glm::dot(displacement, normal) < 0.0f)
+            return { true, 0.0f, normal };
+        return NO_HIT;
+    }
+
+    // slabs of the box grown by the radius
+    const glm::vec2 grownMin = boxMin - radius;
+    const glm::vec2 grownMax = boxMax + radius;
+    float enter = -std::numeric_limits<float>::max();
+    float exit = std::numeric_limits<float>::max();
+    glm::vec2 normal(0.0f);
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (displacement[axis] == 0.0f)
+        {
+            if (center[axis] < grownMin[axis] || center[axis] > grownMax[axis])
+                return NO_HIT;
+            continue;
+        }
+        const float inverse = 1.0f / displacement[axis];
+        float near = (grownMin[axis] - center[axis]) * inverse;
+        float far = (grownMax[axis] - center[axis]) * inverse;
+        float side = -1.0f;
+        if (near > far)
+        {
+            std::swap(near, far);
+            side = 1.0f;
+        }
+        if (near > enter)
+        {
+            enter = near;
+            normal = glm::vec2(0.0f);
+            normal[axis] = side;
+        }
+        exit = std::min(exit, far);
+    }
+    if (enter > exit || enter > 1.0f || exit <= 0.0f)
+        return NO_HIT;
+
+    // entering along a side, or in a corner region where the grown box is rounded
+    const glm::vec2 contact = center + displacement * std::max(enter, 0.0f);
+    const bool alongX = contact.x >= boxMin.x && contact.x <= boxMax.x;
+    const bool alongY = contact.y >= boxMin.y && contact.y <= boxMax.y;
+    if (alongX || alongY)
+    {
+        // starting inside the grown box without overlapping the box: touching it and moving towards it
+        if (enter < 0.0f)
+            return { true, 0.0f, offset / std::sqrt(distance2) };
+        return { true, enter, normal };
+    }
+
+    const glm::vec2 corner = glm::clamp(contact, boxMin, boxMax);
+    const glm::vec2 fromCorner = center - corner;
+    // |fromCorner + t * displacement| = radius, first root while moving towards the corner
+    const float a = glm::dot(displacement, displacement);
+    const float b = glm::dot(fromCorner, displacement);
+    const float c = glm::dot(fromCorner, fromCorner) - radius * radius;
+    const float discriminant = b * b - a * c;
+    if (b >= 0.0f || discriminant < 0.0f)
+        return NO_HIT;
+    const float time = std::max((-b - std::sqrt(discriminant)) / a, 0.0f);
+    if (time > 1.0f)
+        return NO_HIT;
+    return { true, time, glm::normalize(fromCorner + displacement * time) };
+}
+
+void MoveBallThroughLevel(BallObject& ball, glm::vec2 start, GameLevel& level, std::vector<unsigned int>& hitBricks,
+    std::vector<unsigned int>& candidates, bool useGrid)
+{
+    glm::vec2 center = start + ball.Radius;
+    glm::vec2 displacement = ball.Position - start;
+    for (unsigned int bounce = 0; bounce < MAX_BALL_BOUNCES && displacement != glm::vec2(0.0f); bounce++)
+    {
+        // broad phase: the bricks of the tiles under the swept circle's bounds
+        candidates.clear();
+        const glm::vec2 end = center + displacement;
+        if (useGrid)
+            level.FindBricks(glm::min(center, end) - ball.Radius, glm::max(center, end) + ball.Radius, candidates);
+        else
+            for (unsigned int i = 0; i < level.Bricks.size(); ++i)
+                if (!level.Bricks[i].Destroyed)
+                    candidates.push_back(i);
+
+        // narrow phase: the earliest hit
+        SweepHit first = { false, std::numeric_limits<float>::max(), glm::vec2(0.0f) };
+        unsigned int firstBrick = 0;
+        for (const unsigned int brick : candidates)
+        {
+            const GameObject& box = level.Bricks[brick];
+            const SweepHit hit = SweepCircleAABB(center, ball.Radius, displacement, box.Position, box.Position + box.Size);
+            if (hit.Hit && hit.Time < first.Time)
+            {
+                first = hit;
+                firstBrick = brick;
+            }
+        }
+        if (!first.Hit)
+        {
+            center = end;
+            break;
+        }
+
+        GameObject& box = level.Bricks[firstBrick];
+        hitBricks.push_back(firstBrick);
+        if (!box.IsSolid)
+            box.Destroyed = true;
+        center += displacement * first.Time;
+        displacement *= 1.0f - first.Time;
+        // don't do collision resolution on non-solid bricks if pass-through is activated
+        if (!(ball.PassThrough && !box.IsSolid))
+        {
+            ball.Velocity = glm::reflect(ball.Velocity, first.Normal);
+            displacement = glm::reflect(displacement, first.Normal);
+        }
+    }
+    ball.Position = center - ball.Radius;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ballObject.h"
+#include "gameLevel.h"
+
+// Time of impact of a moving circle on a box
+struct SweepHit {
+    bool      Hit;
+    float     Time;   // fraction of the displacement travelled before the contact, in [0, 1]
+    glm::vec2 Normal; // from the box towards the circle at the contact
+};
+
+// Continuous test of a circle moving by displacement against the box [boxMin, boxMax]:
+// the circle's center is swept against the box grown by the radius, with rounded corners.
+// A circle already overlapping the box only hits it while moving towards it.
+SweepHit SweepCircleAABB(glm::vec2 center, float radius, glm::vec2 displacement, glm::vec2 boxMin, glm::vec2 boxMax);
+
+// Moves the ball from start to its current position through the level's bricks, so that a fast ball does not
+// tunnel through them: the ball bounces on the first brick hit and goes on with the rest of its displacement.
+// The bricks hit are destroyed unless solid, their indices are appended to hitBricks.
+// The candidates come from the level's tile grid, or from all its bricks without it (to compare),
+// candidates is only a scratch buffer kept by the caller from one call to the next.
+void MoveBallThroughLevel(BallObject& ball, glm::vec2 start, GameLevel& level, std::vector<unsigned int>& hitBricks,
+    std::vector<unsigned int>& candidates, bool useGrid = true);
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "collisionBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "ballCollision.h"
+#include "ballObject.h"
+#include "game.h"
+#include "gameLevel.h"
+
+// frames replayed against every brick, the brute force is too slow for the whole run
+const unsigned int COMPARED_FRAMES = 3;
+
+struct CollisionRun {
+    double                    TimeMs;
+    // bricks hit, in the order of the ball steps, and how many each step hit
+    std::vector<unsigned int> HitBricks;
+    std::vector<unsigned int> StepHits;
+};
+
+std::vector<BallObject> CreateBenchmarkBalls(unsigned int width, unsigned int height, unsigned int ballCount)
+{
+    // below the bricks, in every direction at up to several times the game's speed
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> x(0.0f, width - 2.0f * BALL_RADIUS);
+    std::uniform_real_distribution<float> y(height / 2.0f, height - 2.0f * BALL_RADIUS);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> speed(200.0f, 2000.0f);
+    std::vector<BallObject> balls;
+    balls.reserve(ballCount);
+    for (unsigned int i = 0; i < ballCount; ++i)
+    {
+        const float direction = angle(generator);
+        const glm::vec2 velocity = glm::vec2(std::cos(direction), std::sin(direction)) * speed(generator);
+        balls.emplace_back(glm::vec2(x(generator), y(generator)), BALL_RADIUS, velocity, Texture2D());
+        balls.back().Stuck = false;
+    }
+    return balls;
+}
+
+CollisionRun SimulateBalls(std::vector<BallObject>& balls, GameLevel& level, unsigned int width, unsigned int height, unsigned int frames, bool useGrid)
+{
+    const float dt = 1.0f / 60.0f;
+    CollisionRun run;
+    std::vector<unsigned int> candidates;
+    run.StepHits.reserve(static_cast<size_t>(frames) * balls.size());
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int frame = 0; frame < frames; ++frame)
+    {
+        for (BallObject& ball : balls)
+        {
+            const glm::vec2 ballStart = ball.Position;
+            ball.Move(dt, width);
+            // the balls bounce on the bottom edge too
+            if (ball.Position.y + ball.Size.y >= height)
+            {
+                ball.Velocity.y = -ball.Velocity.y;
+                ball.Position.y = height - ball.Size.y;
+            }
+            const size_t hitCount = run.HitBricks.size();
+            MoveBallThroughLevel(ball, ballStart, level, run.HitBricks, candidates, useGrid);
+            run.StepHits.push_back(static_cast<unsigned int>(run.HitBricks.size() - hitCount));
+        }
+    }
+    run.TimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return run;
+}
+
+// balls overlapping a brick at the end of the run, a swept ball never ends up inside one
+unsigned int CountTunneledBalls(const std::vector<BallObject>& balls, const GameLevel& level)
+{
+    unsigned int tunneled = 0;
+    std::vector<unsigned int> bricks;
+    for (const BallObject& ball : balls)
+    {
+        const glm::vec2 center = ball.Position + ball.Radius;
+        bricks.clear();
+        level.FindBricks(ball.Position, ball.Position + ball.Size, bricks);
+        for (const unsigned int brick : bricks)
+        {
+            const GameObject& box = level.Bricks[brick];
+            const glm::vec2 offset = center - glm::clamp(center, box.Position, box.Position + box.Size);
+            // a ball resting against a brick touches it, it is inside once it overlaps by a pixel
+            if (glm::length(offset) < ball.Radius - 1.0f)
+            {
+                tunneled++;
+                break;
+            }
+        }
+    }
+    return tunneled;
+}
+
+void RunCollisionBenchmark(unsigned int width, unsigned int height, unsigned int ballCount, unsigned int brickCount, unsigned int frames)
+{
+    GameLevel generated;
+    generated.Generate(brickCount, width, height / 2);
+    std::cout << "Collision benchmark: " << ballCount << " balls, " << generated.Bricks.size() << " bricks ("
+        << generated.Columns << "x" << generated.Rows << " tiles), " << frames << " frames" << std::endl;
+
+    GameLevel level = generated;
+    std::vector<BallObject> balls = CreateBenchmarkBalls(width, height, ballCount);
+    const CollisionRun run = SimulateBalls(balls, level, width, height, frames, true);
+    unsigned int destroyed = 0;
+    for (const GameObject& brick : level.Bricks)
+        destroyed += brick.Destroyed ? 1 : 0;
+    std::cout << "Tile grid: " << run.TimeMs / frames << " ms per frame, " << run.HitBricks.size() << " bricks hit, " << destroyed << " destroyed, "
+        << CountTunneledBalls(balls, level) << " balls inside a brick" << std::endl;
+
+    // same first frames with both broad phases, every step has to hit the same bricks in the same order
+    const unsigned int comparedFrames = std::min(frames, COMPARED_FRAMES);
+    GameLevel gridLevel = generated;
+    std::vector<BallObject> gridBalls = CreateBenchmarkBalls(width, height, ballCount);
+    const CollisionRun gridRun = SimulateBalls(gridBalls, gridLevel, width, height, comparedFrames, true);
+    GameLevel allLevel = generated;
+    std::vector<BallObject> allBalls = CreateBenchmarkBalls(width, height, ballCount);
+    const CollisionRun allRun = SimulateBalls(allBalls, allLevel, width, height, comparedFrames, false);
+    std::cout << "First " << comparedFrames << " frames: tile grid " << gridRun.TimeMs / comparedFrames << " ms per frame, all bricks "
+        << allRun.TimeMs / comparedFrames << " ms per frame, " << (gridRun.StepHits == allRun.StepHits && gridRun.HitBricks == allRun.HitBricks ? "same hits" : "DIFFERENT HITS") << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+// Balls of the collision benchmark, in a level of DEFAULT_BENCHMARK_BRICK_COUNT bricks
+const unsigned int DEFAULT_COLLISION_BENCHMARK_BALLS = 2000;
+const unsigned int DEFAULT_COLLISION_BENCHMARK_FRAMES = 600;
+
+// Headless benchmark of the ball collisions: fast balls bounce in a large generated level filling the window,
+// their moves are swept through the bricks found by the tile grid, then the same frames are replayed
+// testing every brick to compare. Does not need a GL context.
+void RunCollisionBenchmark(unsigned int width, unsigned int height, unsigned int ballCount, unsigned int brickCount, unsigned int frames);
\ No newline at end of file
@@ -15,33 +15,26 @@
 #include "particleGenerator.h"
 #include "postProcessor.h"
 #include "textRenderer.h"
-
-
-// Game-related State data
-SpriteRenderer* Renderer;
-GameObject* Player;
-BallObject* Ball;
-ParticleGenerator* Particles;
-PostProcessor* Effects;
-TextRenderer* Text;
-
-float ShakeTime = 0.0f;
+#include "ballCollision.h"
 
 
 Game::Game(unsigned int width, unsigned int height)
-    : State(GAME_MENU), Keys(), KeysProcessed(), Width(width), Height(height), Level(0), Lives(3)
+    : State(GAME_MENU), Keys(), KeysProcessed(), Width(width), Height(height), Level(0), Lives(3),
+    Player(nullptr), Ball(nullptr), Renderer(nullptr), Particles(nullptr), Effects(nullptr), Text(nullptr),
+    Shake(false), Confuse(false), Chaos(false), ShakeTime(0.0f), Random(DEFAULT_SIMULATION_SEED),
+    ParticleStress(false), ParticleAmount(DEFAULT_PARTICLE_AMOUNT), BenchmarkBricks(0), SpriteBatching(true)
 {
 
 }
 
 Game::~Game()
 {
-    delete Renderer;
-    delete Player;
-    delete Ball;
-    delete Particles;
-    delete Effects;
-    delete Text;
+    delete this->Player;
+    delete this->Ball;
+    delete this->Renderer;
+    delete this->Particles;
+    delete this->Effects;
+    delete this->Text;
 }
 
 void Game::Init()
@@ -50,6 +43,8 @@ void Game::Init()
 
 	const std::string SPRITE_SHADER_VERTEX_PATH = PATH_PROJECT + "sprite2D.vert";
 	const std::string SPRITE_SHADER_FRAGMENT_PATH = PATH_PROJECT + "sprite2D.frag";
+	const std::string SPRITE_BATCH_SHADER_VERTEX_PATH = PATH_PROJECT + "sprite2DBatch.vert";
+	const std::string SPRITE_BATCH_SHADER_FRAGMENT_PATH = PATH_PROJECT + "sprite2DBatch.frag";
 	const std::string PARTICLE_SHADER_VERTEX_PATH = PATH_PROJECT + "particle.vert";
 	const std::string PARTICLE_SHADER_FRAGMENT_PATH = PATH_PROJECT + "particle.frag";
 	const std::string POST_PROCESSING_VERTEX_PATH = PATH_PROJECT + "postProcessGame.vert";
@@ -70,13 +65,9 @@ void Game::Init()
 
 	const std::string FONT_PATH = PathManager::getFontsPath() + "Arial.ttf";
 
-	const std::string LEVEL_ONE_PATH = PathManager::getResourcesPath() + "levels/one.lvl";
-	const std::string LEVEL_TWO_PATH = PathManager::getResourcesPath() + "levels/two.lvl";
-	const std::string LEVEL_THREE_PATH = PathManager::getResourcesPath() + "levels/three.lvl";
-	const std::string LEVEL_FOUR_PATH = PathManager::getResourcesPath() + "levels/four.lvl";
-
     // load shaders
     Shader spriteShader = ResourceManager::LoadShader(SPRITE_SHADER_VERTEX_PATH, SPRITE_SHADER_FRAGMENT_PATH, "", "sprite");
+    Shader spriteBatchShader = ResourceManager::LoadShader(SPRITE_BATCH_SHADER_VERTEX_PATH, SPRITE_BATCH_SHADER_FRAGMENT_PATH, "", "spriteBatch");
     Shader particleShader = ResourceManager::LoadShader(PARTICLE_SHADER_VERTEX_PATH, PARTICLE_SHADER_FRAGMENT_PATH, "", "particle");
     Shader postProcessShader = ResourceManager::LoadShader(POST_PROCESSING_VERTEX_PATH, POST_PROCESSING_FRAGMENT_PATH, "", "postprocessing");
     // configure shaders
@@ -84,6 +75,9 @@ void Game::Init()
     spriteShader.use();
     spriteShader.setInt("sprite", 0);
     spriteShader.setMat4("projection", value_ptr(projection));
+    spriteBatchShader.use();
+    spriteBatchShader.setInt("image", 0);
+    spriteBatchShader.setMat4("projection", value_ptr(projection));
     particleShader.use();
     particleShader.setInt("sprite", 0);
     particleShader.setMat4("projection", value_ptr(projection));
@@ -101,13 +95,28 @@ void Game::Init()
     ResourceManager::LoadTexture(POWERUP_CHAOS_TEXTURE_PATH, true, "powerup_chaos");
     ResourceManager::LoadTexture(POWERUP_PASSTHROUGH_TEXTURE_PATH, true, "powerup_passthrough");
     // set render-specific controls
-    Renderer = new SpriteRenderer(spriteShader);
-    Particles = new ParticleGenerator(particleShader, ResourceManager::GetTexture("particle"), 500);
+    Renderer = new SpriteRenderer(spriteShader, spriteBatchShader);
+    Renderer->SetBatching(this->SpriteBatching);
+    Particles = new ParticleGenerator(particleShader, ResourceManager::GetTexture("particle"), this->ParticleAmount);
     Effects = new PostProcessor(postProcessShader, this->Width, this->Height);
     Text = new TextRenderer(this->Width, this->Height);
     Text->Load(FONT_PATH, 24);
+    // the game objects take the textures loaded above
+    this->InitSimulation();
+}
+
+void Game::InitSimulation(unsigned int seed)
+{
+    const std::string LEVEL_ONE_PATH = PathManager::getResourcesPath() + "levels/one.lvl";
+    const std::string LEVEL_TWO_PATH = PathManager::getResourcesPath() + "levels/two.lvl";
+    const std::string LEVEL_THREE_PATH = PathManager::getResourcesPath() + "levels/three.lvl";
+    const std::string LEVEL_FOUR_PATH = PathManager::getResourcesPath() + "levels/four.lvl";
+
+    this->Random.seed(seed);
     // load levels
     GameLevel one; one.Load(LEVEL_ONE_PATH, this->Width, this->Height / 2);
+    if (this->BenchmarkBricks > 0)
+        one.Generate(this->BenchmarkBricks, this->Width, this->Height / 2);
     GameLevel two; two.Load(LEVEL_TWO_PATH, this->Width, this->Height / 2);
     GameLevel three; three.Load(LEVEL_THREE_PATH, this->Width, this->Height / 2);
     GameLevel four; four.Load(LEVEL_FOUR_PATH, this->Width, this->Height / 2);
@@ -118,27 +127,26 @@ void Game::Init()
     this->Level = 0;
     // configure game objects
     glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
-    Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
+    this->Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
     glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
-    Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
+    this->Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
 }
 
 void Game::Update(float dt)
 {
     // update objects
+    const glm::vec2 ballStart = Ball->Position;
     Ball->Move(dt, this->Width);
     // check for collisions
-    this->DoCollisions();
-    // update particles
-    Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2.0f));
+    this->DoCollisions(ballStart);
     // update PowerUps
     this->UpdatePowerUps(dt);
     // reduce shake time
-    if (ShakeTime > 0.0f)
+    if (this->ShakeTime > 0.0f)
     {
-        ShakeTime -= dt;
-        if (ShakeTime <= 0.0f)
-            Effects->Shake = false;
+        this->ShakeTime -= dt;
+        if (this->ShakeTime <= 0.0f)
+            this->Shake = false;
     }
     // check loss condition
     if (Ball->Position.y >= this->Height) // did ball reach bottom edge?
@@ -157,11 +165,22 @@ void Game::Update(float dt)
     {
         this->ResetLevel();
         this->ResetPlayer();
-        Effects->Chaos = true;
+        this->Chaos = true;
         this->State = GAME_WIN;
     }
 }
 
+void Game::UpdateParticles(float dt)
+{
+    unsigned int newParticles = 2;
+    if (this->ParticleStress)
+    {
+        // the particles live for a second
+        newParticles = std::min(this->ParticleAmount, static_cast<unsigned int>(this->ParticleAmount * dt) + 1);
+    }
+    Particles->Update(dt, *Ball, newParticles, glm::vec2(Ball->Radius / 2.0f));
+}
+
 
 void Game::ProcessInput(float dt)
 {
@@ -192,7 +211,7 @@ void Game::ProcessInput(float dt)
         if (this->Keys[GLFW_KEY_ENTER])
         {
             this->KeysProcessed[GLFW_KEY_ENTER] = true;
-            Effects->Chaos = false;
+            this->Chaos = false;
             this->State = GAME_MENU;
         }
     }
@@ -229,23 +248,33 @@ void Game::Render()
     {
         // begin rendering to postprocessing framebuffer
         Effects->BeginRender();
+        Renderer->BeginFrame();
+        Text->BeginFrame();
         // draw background
         auto texture = ResourceManager::GetTexture("background");
         Renderer->DrawSprite(texture, glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
         // draw level
+        Renderer->SetLayer(1);
         this->Levels[this->Level].Draw(*Renderer);
         // draw player
+        Renderer->SetLayer(2);
         Player->Draw(*Renderer);
         // draw PowerUps
         for (PowerUp& powerUp : this->PowerUps)
             if (!powerUp.Destroyed)
                 powerUp.Draw(*Renderer);
+        // the particles are drawn over the sprites so far and under the ball
+        Renderer->Flush();
         // draw particles	
         Particles->Draw();
         // draw ball
         Ball->Draw(*Renderer);
+        Renderer->Flush();
         // end rendering to postprocessing framebuffer
         Effects->EndRender();
+        Effects->Shake = this->Shake;
+        Effects->Confuse = this->Confuse;
+        Effects->Chaos = this->Chaos;
         // render postprocessing quad
         Effects->Render(glfwGetTime());
         // render text (don't include in postprocessing)
@@ -265,6 +294,13 @@ void Game::Render()
 }
 
 
+void Game::ShowStats() const
+{
+    Particles->ShowStats();
+    Renderer->ShowStats();
+    Text->ShowStats();
+}
+
 void Game::ResetLevel()
 {
     const std::string LEVEL_ONE_PATH = PathManager::getResourcesPath() + "levels/one.lvl";
@@ -272,7 +308,9 @@ void Game::ResetLevel()
     const std::string LEVEL_THREE_PATH = PathManager::getResourcesPath() + "levels/three.lvl";
     const std::string LEVEL_FOUR_PATH = PathManager::getResourcesPath() + "levels/four.lvl";
 
-    if (this->Level == 0)
+    if (this->Level == 0 && this->BenchmarkBricks > 0)
+        this->Levels[0].Generate(this->BenchmarkBricks, this->Width, this->Height / 2);
+    else if (this->Level == 0)
         this->Levels[0].Load(LEVEL_ONE_PATH, this->Width, this->Height / 2);
     else if (this->Level == 1)
         this->Levels[1].Load(LEVEL_TWO_PATH, this->Width, this->Height / 2);
@@ -291,7 +329,7 @@ void Game::ResetPlayer()
     Player->Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
     Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
     // also disable all active powerups
-    Effects->Chaos = Effects->Confuse = false;
+    this->Chaos = this->Confuse = false;
     Ball->PassThrough = Ball->Sticky = false;
     Player->Color = glm::vec3(1.0f);
     Ball->Color = glm::vec3(1.0f);
@@ -335,14 +373,14 @@ void Game::UpdatePowerUps(float dt)
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "confuse"))
                     {	// only reset if no other PowerUp of type confuse is active
-                        Effects->Confuse = false;
+                        this->Confuse = false;
                     }
                 }
                 else if (powerUp.Type == "chaos")
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "chaos"))
                     {	// only reset if no other PowerUp of type chaos is active
-                        Effects->Chaos = false;
+                        this->Chaos = false;
                     }
                 }
             }
@@ -355,28 +393,28 @@ void Game::UpdatePowerUps(float dt)
     ), this->PowerUps.end());
 }
 
-bool ShouldSpawn(unsigned int chance)
+// the raw output of the generator is the same on every platform, unlike rand() and the standard distributions
+bool ShouldSpawn(std::mt19937& random, unsigned int chance)
 {
-    unsigned int random = rand() % chance;
-    return random == 0;
+    return random() % chance == 0;
 }
 void Game::SpawnPowerUps(GameObject& block)
 {
-    if (ShouldSpawn(75)) // 1 in 75 chance
+    if (ShouldSpawn(this->Random, 75)) // 1 in 75 chance
         this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_speed")));
-    if (ShouldSpawn(75))
+    if (ShouldSpawn(this->Random, 75))
         this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture("powerup_sticky")));
-    if (ShouldSpawn(75))
+    if (ShouldSpawn(this->Random, 75))
         this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture("powerup_passthrough")));
-    if (ShouldSpawn(75))
+    if (ShouldSpawn(this->Random, 75))
         this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, block.Position, ResourceManager::GetTexture("powerup_increase")));
-    if (ShouldSpawn(15)) // Negative powerups should spawn more often
+    if (ShouldSpawn(this->Random, 15)) // Negative powerups should spawn more often
         this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_confuse")));
-    if (ShouldSpawn(15))
+    if (ShouldSpawn(this->Random, 15))
         this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_chaos")));
 }
 
-void ActivatePowerUp(PowerUp& powerUp)
+void Game::ActivatePowerUp(PowerUp& powerUp)
 {
     if (powerUp.Type == "speed")
     {
@@ -398,13 +436,13 @@ void ActivatePowerUp(PowerUp& powerUp)
     }
     else if (powerUp.Type == "confuse")
     {
-        if (!Effects->Chaos)
-            Effects->Confuse = true; // only activate if chaos wasn't already active
+        if (!this->Chaos)
+            this->Confuse = true; // only activate if chaos wasn't already active
     }
     else if (powerUp.Type == "chaos")
     {
-        if (!Effects->Confuse)
-            Effects->Chaos = true;
+        if (!this->Confuse)
+            this->Chaos = true;
     }
 }
 
@@ -427,53 +465,20 @@ bool CheckCollision(GameObject& one, GameObject& two);
 Collision CheckCollision(BallObject& one, GameObject& two);
 Direction VectorDirection(glm::vec2 closest);
 
-void Game::DoCollisions()
+void Game::DoCollisions(glm::vec2 ballStart)
 {
-    for (GameObject& box : this->Levels[this->Level].Bricks)
+    // the ball is swept from where it started the frame, through the bricks of the tiles it crosses
+    this->HitBricks.clear();
+    MoveBallThroughLevel(*Ball, ballStart, this->Levels[this->Level], this->HitBricks, this->CollisionCandidates);
+    for (const unsigned int brick : this->HitBricks)
     {
-        if (!box.Destroyed)
-        {
-            Collision collision = CheckCollision(*Ball, box);
-            if (std::get<0>(collision)) // if collision is true
-            {
-                // destroy block if not solid
-                if (!box.IsSolid)
-                {
-                    box.Destroyed = true;
-                    this->SpawnPowerUps(box);
-                }
-                else
-                {   // if block is solid, enable shake effect
-                    ShakeTime = 0.05f;
-                    Effects->Shake = true;
-                }
-                // collision resolution
-                Direction dir = std::get<1>(collision);
-                glm::vec2 diff_vector = std::get<2>(collision);
-                if (!(Ball->PassThrough && !box.IsSolid)) // don't do collision resolution on non-solid bricks if pass-through is activated
-                {
-                    if (dir == LEFT || dir == RIGHT) // horizontal collision
-                    {
-                        Ball->Velocity.x = -Ball->Velocity.x; // reverse horizontal velocity
-                        // relocate
-                        float penetration = Ball->Radius - std::abs(diff_vector.x);
-                        if (dir == LEFT)
-                            Ball->Position.x += penetration; // move ball to right
-                        else
-                            Ball->Position.x -= penetration; // move ball to left;
-                    }
-                    else // vertical collision
-                    {
-                        Ball->Velocity.y = -Ball->Velocity.y; // reverse vertical velocity
-                        // relocate
-                        float penetration = Ball->Radius - std::abs(diff_vector.y);
-                        if (dir == UP)
-                            Ball->Position.y -= penetration; // move ball bback up
-                        else
-                            Ball->Position.y += penetration; // move ball back down
-                    }
-                }
-            }
+        GameObject& box = this->Levels[this->Level].Bricks[brick];
+        if (!box.IsSolid)
+            this->SpawnPowerUps(box);
+        else
+        {   // if block is solid, enable shake effect
+            this->ShakeTime = 0.05f;
+            this->Shake = true;
         }
     }
 
@@ -488,7 +493,7 @@ void Game::DoCollisions()
 
             if (CheckCollision(*Player, powerUp))
             {	// collided with player, now activate powerup
-                ActivatePowerUp(powerUp);
+                this->ActivatePowerUp(powerUp);
                 powerUp.Destroyed = true;
                 powerUp.Activated = true;
             }
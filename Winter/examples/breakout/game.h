@@ -2,13 +2,19 @@
 
 #include <vector>
 #include <tuple>
+#include <random>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "ballObject.h"
 #include "gameLevel.h"
 #include "powerUp.h"
 
+class ParticleGenerator;
+class PostProcessor;
+class TextRenderer;
+
 // Represents the current state of the game
 enum GameState {
     GAME_ACTIVE,
@@ -34,10 +40,24 @@ const float PLAYER_VELOCITY(500.0f);
 const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
 // Radius of the ball object
 const float BALL_RADIUS = 12.5f;
+// Particles of the ball trail, and in stress mode
+const unsigned int DEFAULT_PARTICLE_AMOUNT = 500;
+const unsigned int DEFAULT_STRESS_PARTICLE_AMOUNT = 200000;
+// Bricks of the generated sprite benchmark level
+const unsigned int DEFAULT_BENCHMARK_BRICK_COUNT = 40000;
+// The simulation advances by fixed steps, whatever the frame rate
+const float SIMULATION_TIMESTEP = 1.0f / 120.0f;
+// Steps a single frame may run, a longer frame slows the game down instead of stalling it further
+const unsigned int MAX_SIMULATION_STEPS = 8;
+// Seed of the power-up spawns
+const unsigned int DEFAULT_SIMULATION_SEED = 5489u;
 
 // Game holds all game-related state and functionality.
 // Combines all game-related data into a single class for
 // easy access to each of the components and manageability.
+// The simulation (InitSimulation, ProcessInput, Update) does not touch OpenGL and only draws from its own
+// random generator, so a headless game replays the same input into the same state.
+// Init also creates the renderers, Render and UpdateParticles then need a GL context.
 class Game
 {
 public:
@@ -50,20 +70,52 @@ public:
     std::vector<PowerUp>    PowerUps;
     unsigned int            Level;
     unsigned int            Lives;
+    GameObject*             Player;
+    BallObject*             Ball;
+    // render state, left null by a headless game
+    SpriteRenderer*         Renderer;
+    ParticleGenerator*      Particles;
+    PostProcessor*          Effects;
+    TextRenderer*           Text;
+    // post-processing effects, applied by Render
+    bool                    Shake, Confuse, Chaos;
+    float                   ShakeTime;
+    // draws the power-up spawns
+    std::mt19937            Random;
+    // stress mode: the whole particle pool is respawned every second
+    bool                    ParticleStress;
+    unsigned int            ParticleAmount;
+    // sprite benchmark: the first level is replaced by a generated one of this many bricks, 0 when disabled
+    unsigned int            BenchmarkBricks;
+    // sprites are batched by texture, or drawn one by one to compare
+    bool                    SpriteBatching;
+    // scratch buffers of DoCollisions, kept from one step to the next to not allocate
+    std::vector<unsigned int> HitBricks;
+    std::vector<unsigned int> CollisionCandidates;
     // constructor/destructor
     Game(unsigned int width, unsigned int height);
     ~Game();
+    Game(const Game& other) = delete;
+    Game& operator=(const Game& other) = delete;
     // initialize game state (load all shaders/textures/levels)
     void Init();
-    // game loop
+    // levels and game objects only, called once; the textures are left empty when Init did not load them first
+    void InitSimulation(unsigned int seed = DEFAULT_SIMULATION_SEED);
+    // game loop, the simulation is stepped by SIMULATION_TIMESTEP
     void ProcessInput(float dt);
     void Update(float dt);
+    // the particles only follow the ball, they are updated once per rendered frame
+    void UpdateParticles(float dt);
     void Render();
-    void DoCollisions();
+    // ballStart is the ball's position before its move of the frame
+    void DoCollisions(glm::vec2 ballStart);
     // reset
     void ResetLevel();
     void ResetPlayer();
     // powerups
     void SpawnPowerUps(GameObject& block);
+    void ActivatePowerUp(PowerUp& powerUp);
     void UpdatePowerUps(float dt);
+    // stats
+    void ShowStats() const;
 };
@@ -1,35 +1,85 @@
 #include "gameLevel.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
-#include <sstream>
+#include <iostream>
 
 #include "resourceManager.h"
 
+const char LEVEL_MAGIC[4] = { 'B', 'L', 'V', 'L' };
+
+template<typename T>
+void writeLevelValue(std::ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool readLevelValue(std::ifstream& file, T& value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+glm::vec3 BrickColor(uint8_t code)
+{
+    switch (code)
+    {
+    case 1: return glm::vec3(0.8f, 0.8f, 0.7f);
+    case 2: return glm::vec3(0.2f, 0.6f, 1.0f);
+    case 3: return glm::vec3(0.0f, 0.7f, 0.0f);
+    case 4: return glm::vec3(0.8f, 0.8f, 0.4f);
+    case 5: return glm::vec3(1.0f, 0.5f, 0.0f);
+    default: return glm::vec3(1.0f); // original: white
+    }
+}
+
 void GameLevel::Load(const std::string& file, unsigned int levelWidth, unsigned int levelHeight)
 {
-    // clear old data
-    this->Bricks.clear();
-    // load from file
-    unsigned int tileCode;
-    GameLevel level;
-    std::string line;
-    std::ifstream fstream(file);
-    std::vector<std::vector<unsigned int>> tileData;
-    if (fstream)
+    LevelTiles tiles;
+    if (ReadTiles(file, tiles))
+        this->Build(tiles, levelWidth, levelHeight);
+    else
+        this->clear();
+}
+
+void GameLevel::Build(const LevelTiles& tiles, unsigned int levelWidth, unsigned int levelHeight)
+{
+    this->clear();
+    if (tiles.Columns == 0 || tiles.Rows == 0)
+        return;
+    // calculate dimensions
+    const float unitWidth = levelWidth / static_cast<float>(tiles.Columns);
+    const float unitHeight = levelHeight / static_cast<float>(tiles.Rows);
+    this->Columns = tiles.Columns;
+    this->Rows = tiles.Rows;
+    this->TileSize = glm::vec2(unitWidth, unitHeight);
+    this->tileBricks.assign(tiles.Codes.size(), NO_BRICK);
+    // the bricks are counted first, then built in place
+    this->Bricks.reserve(tiles.Codes.size() - std::count(tiles.Codes.begin(), tiles.Codes.end(), uint8_t(0)));
+    const Texture2D solidTexture = ResourceManager::GetTexture("block_solid");
+    const Texture2D blockTexture = ResourceManager::GetTexture("block");
+    for (unsigned int y = 0; y < tiles.Rows; ++y)
     {
-        while (std::getline(fstream, line)) // read each line from level file
+        for (unsigned int x = 0; x < tiles.Columns; ++x)
         {
-            std::istringstream sstream(line);
-            std::vector<unsigned int> row;
-            while (sstream >> tileCode) // read each word separated by spaces
-                row.push_back(tileCode);
-            tileData.push_back(row);
+            const unsigned int tile = y * tiles.Columns + x;
+            const uint8_t code = tiles.Codes[tile];
+            if (code == 0)
+                continue;
+            this->tileBricks[tile] = static_cast<unsigned int>(this->Bricks.size());
+            GameObject& brick = this->Bricks.emplace_back(glm::vec2(unitWidth * x, unitHeight * y), this->TileSize,
+                code == 1 ? solidTexture : blockTexture, BrickColor(code));
+            brick.IsSolid = code == 1;
         }
-        if (tileData.size() > 0)
-            this->init(tileData, levelWidth, levelHeight);
     }
 }
 
+void GameLevel::Generate(unsigned int columns, unsigned int rows, unsigned int levelWidth, unsigned int levelHeight)
+{
+    this->Build(GenerateTiles(columns, rows), levelWidth, levelHeight);
+}
+
 void GameLevel::Draw(SpriteRenderer& renderer)
 {
     for (GameObject& tile : this->Bricks)
@@ -41,6 +91,34 @@ void GameLevel::Draw(SpriteRenderer& renderer)
     }
 }
 
+void GameLevel::Generate(unsigned int brickCount, unsigned int levelWidth, unsigned int levelHeight)
+{
+    const float aspect = levelWidth / static_cast<float>(levelHeight);
+    const unsigned int columns = std::max(1u, static_cast<unsigned int>(std::round(std::sqrt(brickCount * aspect))));
+    const unsigned int rows = (brickCount + columns - 1) / columns;
+    this->Generate(columns, rows, levelWidth, levelHeight);
+}
+
+void GameLevel::FindBricks(glm::vec2 min, glm::vec2 max, std::vector<unsigned int>& bricks) const
+{
+    if (this->Columns == 0 || this->Rows == 0 || max.x < 0.0f || max.y < 0.0f)
+        return;
+    // tile range of the box, clamped to the level
+    const unsigned int firstColumn = static_cast<unsigned int>(std::max(min.x / this->TileSize.x, 0.0f));
+    const unsigned int firstRow = static_cast<unsigned int>(std::max(min.y / this->TileSize.y, 0.0f));
+    const unsigned int lastColumn = static_cast<unsigned int>(std::min(max.x / this->TileSize.x, this->Columns - 1.0f));
+    const unsigned int lastRow = static_cast<unsigned int>(std::min(max.y / this->TileSize.y, this->Rows - 1.0f));
+    for (unsigned int y = firstRow; y <= lastRow; ++y)
+    {
+        for (unsigned int x = firstColumn; x <= lastColumn; ++x)
+        {
+            const unsigned int brick = this->tileBricks[y * this->Columns + x];
+            if (brick != NO_BRICK && !this->Bricks[brick].Destroyed)
+                bricks.push_back(brick);
+        }
+    }
+}
+
 bool GameLevel::IsCompleted()
 {
     for (GameObject& tile : this->Bricks)
@@ -53,49 +131,118 @@ bool GameLevel::IsCompleted()
     return true;
 }
 
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData,
-    unsigned int lvlWidth, unsigned int lvlHeight)
+bool GameLevel::ReadTiles(const std::string& file, LevelTiles& tiles)
 {
-    // calculate dimensions
-    unsigned int height = tileData.size();
-    unsigned int width = tileData[0].size();
-    float unit_width = lvlWidth / static_cast<float>(width);
-    float unit_height = lvlHeight / static_cast<float>(height);
-    // initialize level tiles based on tileData		
-    for (unsigned int y = 0; y < height; ++y)
+    tiles = LevelTiles();
+    std::ifstream stream(file, std::ios::binary | std::ios::ate);
+    if (!stream)
+    {
+        std::cout << "ERROR::LEVEL: Failed to read level file " << file << std::endl;
+        return false;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(stream.tellg());
+    stream.seekg(0);
+
+    // binary level, the codes are read in bulk
+    char magic[4] = {};
+    uint32_t version = 0;
+    stream.read(magic, sizeof(magic));
+    if (stream && std::equal(std::begin(magic), std::end(magic), std::begin(LEVEL_MAGIC)))
+    {
+        readLevelValue(stream, version);
+        readLevelValue(stream, tiles.Columns);
+        readLevelValue(stream, tiles.Rows);
+        const uint64_t tileCount = static_cast<uint64_t>(tiles.Columns) * tiles.Rows;
+        if (!stream || version != BINARY_VERSION || tileCount > fileSize - static_cast<uint64_t>(stream.tellg()))
+        {
+            std::cout << "ERROR::LEVEL::CORRUPTED: " << file << std::endl;
+            tiles = LevelTiles();
+            return false;
+        }
+        tiles.Codes.resize(tileCount);
+        stream.read(reinterpret_cast<char*>(tiles.Codes.data()), static_cast<std::streamsize>(tileCount));
+        return true;
+    }
+
+    // text level, read whole then parsed in place
+    std::string text(fileSize, '\0');
+    stream.clear();
+    stream.seekg(0);
+    stream.read(text.data(), static_cast<std::streamsize>(fileSize));
+    ParseTiles(text.data(), text.size(), tiles);
+    return true;
+}
+
+void GameLevel::ParseTiles(const char* text, size_t size, LevelTiles& tiles)
+{
+    tiles = LevelTiles();
+    // a tile takes two characters at least
+    tiles.Codes.reserve(size / 2);
+    const char* current = text;
+    const char* const end = text + size;
+    while (current < end)
     {
-        for (unsigned int x = 0; x < width; ++x)
+        // one row per line, anything but digits separates the codes
+        unsigned int rowTiles = 0;
+        for (; current < end && *current != '\n'; ++current)
         {
-            // check block type from level data (2D level array)
-            if (tileData[y][x] == 1) // solid
-            {
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                GameObject obj(pos, size,
-                    ResourceManager::GetTexture("block_solid"),
-                    glm::vec3(0.8f, 0.8f, 0.7f)
-                );
-                obj.IsSolid = true;
-                this->Bricks.push_back(obj);
-            }
-            else if (tileData[y][x] > 1)
-            {
-                glm::vec3 color = glm::vec3(1.0f); // original: white
-                if (tileData[y][x] == 2)
-                    color = glm::vec3(0.2f, 0.6f, 1.0f);
-                else if (tileData[y][x] == 3)
-                    color = glm::vec3(0.0f, 0.7f, 0.0f);
-                else if (tileData[y][x] == 4)
-                    color = glm::vec3(0.8f, 0.8f, 0.4f);
-                else if (tileData[y][x] == 5)
-                    color = glm::vec3(1.0f, 0.5f, 0.0f);
-
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                this->Bricks.push_back(
-                    GameObject(pos, size, ResourceManager::GetTexture("block"), color)
-                );
-            }
+            if (*current < '0' || *current > '9')
+                continue;
+            unsigned int code = 0;
+            for (; current < end && *current >= '0' && *current <= '9'; ++current)
+                code = std::min(code * 10 + (*current - '0'), 255u);
+            if (tiles.Rows == 0 || rowTiles < tiles.Columns)
+                tiles.Codes.push_back(static_cast<uint8_t>(code));
+            rowTiles++;
+            if (current == end || *current == '\n')
+                break;
         }
+        ++current;
+        // blank lines are skipped
+        if (rowTiles == 0)
+            continue;
+        if (tiles.Rows == 0)
+            tiles.Columns = rowTiles;
+        else if (rowTiles < tiles.Columns)
+            tiles.Codes.resize(tiles.Codes.size() + tiles.Columns - rowTiles, 0);
+        tiles.Rows++;
+    }
+}
+
+bool GameLevel::WriteBinaryTiles(const std::string& file, const LevelTiles& tiles)
+{
+    std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        std::cout << "ERROR::LEVEL: Failed to write level file " << file << std::endl;
+        return false;
     }
+    stream.write(LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    writeLevelValue(stream, BINARY_VERSION);
+    writeLevelValue(stream, tiles.Columns);
+    writeLevelValue(stream, tiles.Rows);
+    stream.write(reinterpret_cast<const char*>(tiles.Codes.data()), static_cast<std::streamsize>(tiles.Codes.size()));
+    return static_cast<bool>(stream);
+}
+
+LevelTiles GameLevel::GenerateTiles(unsigned int columns, unsigned int rows)
+{
+    LevelTiles tiles;
+    if (columns == 0 || rows == 0)
+        return tiles;
+    tiles.Columns = columns;
+    tiles.Rows = rows;
+    tiles.Codes.resize(static_cast<size_t>(columns) * rows);
+    for (unsigned int y = 0; y < rows; ++y)
+        for (unsigned int x = 0; x < columns; ++x)
+            tiles.Codes[static_cast<size_t>(y) * columns + x] = static_cast<uint8_t>(1 + (x + y) % 5);
+    return tiles;
+}
+
+void GameLevel::clear()
+{
+    this->Bricks.clear();
+    this->tileBricks.clear();
+    this->Columns = this->Rows = 0;
+    this->TileSize = glm::vec2(0.0f);
 }
\ No newline at end of file
@@ -1,25 +1,58 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "gameObject.h"
 
+// Tile codes of a level, row by row: 0 is empty, 1 a solid brick, 2 and above a brick of a color
+struct LevelTiles {
+    unsigned int         Columns = 0;
+    unsigned int         Rows = 0;
+    std::vector<uint8_t> Codes;
+};
+
 class GameLevel
 {
 public:
+    // binary levels start with the magic and version, then the columns and rows as uint32 and a byte per tile
+    static constexpr uint32_t BINARY_VERSION = 1;
+
     // level state
     std::vector<GameObject> Bricks;
+    // tile grid of the level, also the broad phase of the collisions since a tile holds at most one brick
+    unsigned int Columns, Rows;
+    glm::vec2    TileSize;
     // constructor
-    GameLevel() {}
-    // loads level from file
+    GameLevel() : Columns(0), Rows(0), TileSize(0.0f) {}
+    // loads level from file, a text or binary level
     void Load(const std::string& file, unsigned int levelWidth, unsigned int levelHeight);
+    // builds the bricks of the tiles
+    void Build(const LevelTiles& tiles, unsigned int levelWidth, unsigned int levelHeight);
+    // fills the level with a grid of bricks of every type, to benchmark the rendering of large levels
+    void Generate(unsigned int columns, unsigned int rows, unsigned int levelWidth, unsigned int levelHeight);
+    // same with about square bricks, brickCount of them at least
+    void Generate(unsigned int brickCount, unsigned int levelWidth, unsigned int levelHeight);
     // render level
     void Draw(SpriteRenderer& renderer);
     // check if the level is completed (all non-solid tiles are destroyed)
     bool IsCompleted();
+    // appends the indices of the bricks not destroyed whose tile overlaps the box [min, max]
+    void FindBricks(glm::vec2 min, glm::vec2 max, std::vector<unsigned int>& bricks) const;
+    // reads a level file, binary if it starts with the magic, else text: a row per line, the codes separated by spaces.
+    // Rows are padded with empty tiles or cut to the width of the first one.
+    static bool ReadTiles(const std::string& file, LevelTiles& tiles);
+    // parses the text of a level
+    static void ParseTiles(const char* text, size_t size, LevelTiles& tiles);
+    static bool WriteBinaryTiles(const std::string& file, const LevelTiles& tiles);
+    // diagonal stripes of the codes 1 to 5, so that consecutive bricks alternate textures
+    static LevelTiles GenerateTiles(unsigned int columns, unsigned int rows);
 private:
-    // initialize level from tile data
-    void init(std::vector<std::vector<unsigned int>> tileData,
-        unsigned int levelWidth, unsigned int levelHeight);
+    // index of the brick of each tile, NO_BRICK for the empty ones
+    static constexpr unsigned int NO_BRICK = 0xFFFFFFFF;
+    std::vector<unsigned int> tileBricks;
+
+    // removes all bricks
+    void clear();
 };
\ No newline at end of file
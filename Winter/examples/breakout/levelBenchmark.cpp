@@ -0,0 +1,94 @@
+#include "levelBenchmark.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gameLevel.h"
+
+double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void WriteTextTiles(const std::string& file, const LevelTiles& tiles)
+{
+    std::ofstream stream(file, std::ios::trunc);
+    std::string line;
+    for (unsigned int y = 0; y < tiles.Rows; ++y)
+    {
+        line.clear();
+        for (unsigned int x = 0; x < tiles.Columns; ++x)
+        {
+            line += std::to_string(tiles.Codes[static_cast<size_t>(y) * tiles.Columns + x]);
+            line += ' ';
+        }
+        line += '\n';
+        stream << line;
+    }
+}
+
+// the loader as it was, a line and a string stream per row
+std::vector<std::vector<unsigned int>> ReadTilesWithStreams(const std::string& file)
+{
+    unsigned int tileCode;
+    std::string line;
+    std::ifstream fstream(file);
+    std::vector<std::vector<unsigned int>> tileData;
+    while (std::getline(fstream, line))
+    {
+        std::istringstream sstream(line);
+        std::vector<unsigned int> row;
+        while (sstream >> tileCode)
+            row.push_back(tileCode);
+        tileData.push_back(row);
+    }
+    return tileData;
+}
+
+bool IsSameLevel(const LevelTiles& a, const LevelTiles& b)
+{
+    return a.Columns == b.Columns && a.Rows == b.Rows && a.Codes == b.Codes;
+}
+
+void RunLevelBenchmark(unsigned int size, unsigned int levelWidth, unsigned int levelHeight)
+{
+    const LevelTiles generated = GameLevel::GenerateTiles(size, size);
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string textFile = (directory / "breakout_benchmark.lvl").string();
+    const std::string binaryFile = (directory / "breakout_benchmark.blvl").string();
+    WriteTextTiles(textFile, generated);
+    GameLevel::WriteBinaryTiles(binaryFile, generated);
+    std::cout << "Level benchmark: " << size << "x" << size << " tiles, text " << std::filesystem::file_size(textFile) / 1024
+        << " KB, binary " << std::filesystem::file_size(binaryFile) / 1024 << " KB" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<std::vector<unsigned int>> streamTiles = ReadTilesWithStreams(textFile);
+    const double streamMs = ElapsedMs(start);
+
+    LevelTiles textTiles;
+    start = std::chrono::steady_clock::now();
+    GameLevel::ReadTiles(textFile, textTiles);
+    const double textMs = ElapsedMs(start);
+
+    LevelTiles binaryTiles;
+    start = std::chrono::steady_clock::now();
+    GameLevel::ReadTiles(binaryFile, binaryTiles);
+    const double binaryMs = ElapsedMs(start);
+
+    GameLevel level;
+    start = std::chrono::steady_clock::now();
+    level.Build(binaryTiles, levelWidth, levelHeight);
+    const double buildMs = ElapsedMs(start);
+
+    std::cout << "Streams " << streamMs << " ms (" << streamTiles.size() << " rows), text parser " << textMs << " ms, binary "
+        << binaryMs << " ms, " << (IsSameLevel(textTiles, generated) && IsSameLevel(binaryTiles, generated) ? "same tiles" : "DIFFERENT TILES") << std::endl;
+    std::cout << "Build " << buildMs << " ms, " << level.Bricks.size() << " bricks" << std::endl;
+
+    std::filesystem::remove(textFile);
+    std::filesystem::remove(binaryFile);
+}
\ No newline at end of file
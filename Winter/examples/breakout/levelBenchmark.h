@@ -0,0 +1,9 @@
+#pragma once
+
+// Columns and rows of the level of the benchmark
+const unsigned int DEFAULT_LEVEL_BENCHMARK_SIZE = 1000;
+
+// Headless benchmark of the level loading: a generated level of size x size tiles is written as text and binary files,
+// then read with the streams the loader used before, the text parser and the binary reader, and its bricks built.
+// Does not need a GL context.
+void RunLevelBenchmark(unsigned int size, unsigned int levelWidth, unsigned int levelHeight);
\ No newline at end of file
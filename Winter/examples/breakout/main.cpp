@@ -3,6 +3,7 @@
 // Few modifications were made to the original code
 #include <array>
 #include <algorithm>
+#include <cctype>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -23,13 +24,18 @@
 #include FT_FREETYPE_H
 
 #include "camera.h"
+#include "collisionBenchmark.h"
+#include "simulationBenchmark.h"
 #include "game.h"
+#include "levelBenchmark.h"
 #include "fpsCounter.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "resourceManager.h"
 #include "shader.h"
 #include "texture.h"
+#include "traceRecorder.h"
 
 // Function prototypes
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
@@ -52,6 +58,8 @@ const std::string WINDOW_TITLE = "Breakout";
 // Time
 float deltaTime = 0.0f;
 float lastFrameTime = 0.0f;
+// time not simulated yet, less than a step after each frame
+float simulationLag = 0.0f;
 
 // Input
 bool firstMouseInput = true;
@@ -61,11 +69,76 @@ float lastMouseY = 0.0f;
 // Game
 Game Breakout(WINDOW_WIDTH, WINDOW_HEIGHT);
 
-int main()
+int main(int argc, char* argv[])
 {
     // Init Paths
     PathManager::projectPath = std::filesystem::current_path().string() + "/";
 
+    // --particle-stress [count] fills the particle pool to measure the particles' update and draw
+    // --sprite-benchmark [bricks] replaces the first level by a generated one, --no-sprite-batching draws the sprites one by one
+    // --collision-benchmark [balls] [bricks] runs the headless collision benchmark then exits
+    // --level-benchmark [size] runs the headless level loading benchmark then exits
+    // --simulation-benchmark [frames] runs the game headless on scripted input then exits, with --sprite-benchmark's level if given first
+    // --trace [frames] records the first frames into trace.json, F12 starts and stops a recording at any time
+    unsigned int traceFrames = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--particle-stress")
+        {
+            Breakout.ParticleStress = true;
+            Breakout.ParticleAmount = DEFAULT_STRESS_PARTICLE_AMOUNT;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+            {
+                Breakout.ParticleAmount = static_cast<unsigned int>(std::stoul(argv[++i]));
+            }
+        }
+        else if (std::string(argv[i]) == "--sprite-benchmark")
+        {
+            Breakout.BenchmarkBricks = DEFAULT_BENCHMARK_BRICK_COUNT;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+            {
+                Breakout.BenchmarkBricks = static_cast<unsigned int>(std::stoul(argv[++i]));
+            }
+        }
+        else if (std::string(argv[i]) == "--no-sprite-batching")
+        {
+            Breakout.SpriteBatching = false;
+        }
+        else if (std::string(argv[i]) == "--collision-benchmark")
+        {
+            unsigned int balls = DEFAULT_COLLISION_BENCHMARK_BALLS;
+            unsigned int bricks = DEFAULT_BENCHMARK_BRICK_COUNT;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                balls = static_cast<unsigned int>(std::stoul(argv[++i]));
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                bricks = static_cast<unsigned int>(std::stoul(argv[++i]));
+            RunCollisionBenchmark(WINDOW_WIDTH, WINDOW_HEIGHT, balls, bricks, DEFAULT_COLLISION_BENCHMARK_FRAMES);
+            return 0;
+        }
+        else if (std::string(argv[i]) == "--level-benchmark")
+        {
+            unsigned int size = DEFAULT_LEVEL_BENCHMARK_SIZE;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                size = static_cast<unsigned int>(std::stoul(argv[++i]));
+            RunLevelBenchmark(size, WINDOW_WIDTH, WINDOW_HEIGHT / 2);
+            return 0;
+        }
+        else if (std::string(argv[i]) == "--simulation-benchmark")
+        {
+            unsigned int frames = DEFAULT_SIMULATION_BENCHMARK_FRAMES;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                frames = static_cast<unsigned int>(std::stoul(argv[++i]));
+            RunSimulationBenchmark(WINDOW_WIDTH, WINDOW_HEIGHT, Breakout.BenchmarkBricks, frames);
+            return 0;
+        }
+        else if (std::string(argv[i]) == "--trace")
+        {
+            traceFrames = TraceRecorder::DEFAULT_FRAME_COUNT;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                traceFrames = static_cast<unsigned int>(std::stoul(argv[++i]));
+        }
+    }
+
     // INIT GLFW
     // ------------------------------------
     glfwInit();
@@ -105,20 +178,24 @@ int main()
     if (flags & GL_CONTEXT_FLAG_DEBUG_BIT)
     {
         std::cout << "OpenGL Debug Context is enabled" << std::endl;
-        glEnable(GL_DEBUG_OUTPUT);
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        GLState::enable(GL_DEBUG_OUTPUT);
+        GLState::enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
         glDebugMessageCallback(glDebugOutput, nullptr);
         glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
     }
 
     // OpenGL Config
 	// ------------------------------------
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-    glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::enable(GL_BLEND);
+	GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Game
 	// ------------------------------------
+    if (traceFrames > 0)
+    {
+        TraceRecorder::start(PathManager::projectPath + "trace.json", traceFrames);
+    }
     Breakout.Init();
 
     // Render Loop
@@ -136,32 +213,50 @@ int main()
 		if (frameCount % 60 == 0)
 		{
 			fpsCounter.showFPS();
+			GLState::showStats();
+			Breakout.ShowStats();
 		}
 
         glfwPollEvents();
 
-        // input
-		Breakout.ProcessInput(deltaTime);
-
-        // Update
-		Breakout.Update(deltaTime);
+        // input and update, by fixed steps
+        simulationLag = std::min(simulationLag + deltaTime, MAX_SIMULATION_STEPS * SIMULATION_TIMESTEP);
+        while (simulationLag >= SIMULATION_TIMESTEP)
+        {
+            TraceScope stepScope("Simulation step");
+            Breakout.ProcessInput(SIMULATION_TIMESTEP);
+            Breakout.Update(SIMULATION_TIMESTEP);
+            simulationLag -= SIMULATION_TIMESTEP;
+        }
+        {
+            TraceScope particlesScope("Particles update");
+            Breakout.UpdateParticles(deltaTime);
+        }
 
         // rendering commands
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
         // Draw scene
 		// ------------------------------------
 		// Use shader program
-        Breakout.Render();
+        {
+            TraceScope renderScope("Render");
+            Breakout.Render();
+        }
 
         // check and call events and swap the buffers
-        glfwSwapBuffers(window);
+        {
+            TraceScope swapScope("Swap buffers");
+            glfwSwapBuffers(window);
+        }
+        GLState::nextFrame();
+        TraceRecorder::counter("GL state calls", static_cast<double>(GLState::getStats().issued));
 
         lastFrameTime = curFrameTime;
     }
@@ -182,6 +277,10 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     {
         glfwSetWindowShouldClose(window, true);
     }
+    if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+    {
+        TraceRecorder::toggle(PathManager::projectPath + "trace.json");
+    }
     if (key >= 0 && key < 1024)
     {
         if (action == GLFW_PRESS)
@@ -198,7 +297,7 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 
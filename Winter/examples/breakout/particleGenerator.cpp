@@ -1,63 +1,136 @@
 #include "particleGenerator.h"
 
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include "glState.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BREAKOUT_PARTICLES_SSE
+#include <emmintrin.h>
+#endif
+
+const unsigned int PARTICLE_SIMD_WIDTH = 4;
+const float PARTICLE_FADE_SPEED = 2.5f;
+
 ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-	: particles(), amount(amount), shader(shader), texture(texture), VAO(0)
+	: nextOverwrittenParticle(0), amount(amount), shader(shader), texture(texture), VAO(0), quadVBO(0),
+	instanceStream(amount * sizeof(ParticleInstance)), instanceVBO(0), updateTimeMs(0.0), drawTimeMs(0.0)
 {
     this->init();
 }
 
 ParticleGenerator::~ParticleGenerator()
 {
-	glDeleteVertexArrays(1, &this->VAO);
+	GLState::deleteVertexArrays(1, &this->VAO);
+	glDeleteBuffers(1, &this->quadVBO);
 }
 
 void ParticleGenerator::Update(float dt, GameObject& object, unsigned int newParticles, glm::vec2 offset)
 {
+    const auto start = std::chrono::steady_clock::now();
     // add new particles 
     for (unsigned int i = 0; i < newParticles; ++i)
     {
-        int unusedParticle = this->firstUnusedParticle();
-        this->respawnParticle(this->particles[unusedParticle], object, offset);
+        this->respawnParticle(this->firstUnusedParticle(), object, offset);
     }
-    // update all particles
-    for (unsigned int i = 0; i < this->amount; ++i)
+    // update all particles, the live ones are compacted into the instances drawn by Draw
+    this->instances.clear();
+    const unsigned int paddedAmount = static_cast<unsigned int>(this->lives.size());
+#ifdef BREAKOUT_PARTICLES_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 dtx4 = _mm_set1_ps(dt);
+    const __m128 fade = _mm_set1_ps(dt * PARTICLE_FADE_SPEED);
+    for (unsigned int i = 0; i < paddedAmount; i += PARTICLE_SIMD_WIDTH)
     {
-        Particle& p = this->particles[i];
-        p.Life -= dt; // reduce life
-        if (p.Life > 0.0f)
-        {	// particle is alive, thus update
-            p.Position -= p.Velocity * dt;
-            p.Color.a -= dt * 2.5f;
+        const __m128 life = _mm_loadu_ps(&this->lives[i]);
+        const __m128 newLife = _mm_sub_ps(life, dtx4);
+        const __m128 alive = _mm_cmpgt_ps(newLife, zero);
+        const __m128 wasAlive = _mm_cmpgt_ps(life, zero);
+        // the dead particles are left as they are, only their life keeps decreasing
+        const __m128 positionX = _mm_sub_ps(_mm_loadu_ps(&this->positionsX[i]), _mm_and_ps(alive, _mm_mul_ps(_mm_loadu_ps(&this->velocitiesX[i]), dtx4)));
+        const __m128 positionY = _mm_sub_ps(_mm_loadu_ps(&this->positionsY[i]), _mm_and_ps(alive, _mm_mul_ps(_mm_loadu_ps(&this->velocitiesY[i]), dtx4)));
+        const __m128 alpha = _mm_sub_ps(_mm_loadu_ps(&this->colorsA[i]), _mm_and_ps(alive, fade));
+        _mm_storeu_ps(&this->lives[i], newLife);
+        _mm_storeu_ps(&this->positionsX[i], positionX);
+        _mm_storeu_ps(&this->positionsY[i], positionY);
+        _mm_storeu_ps(&this->colorsA[i], alpha);
+
+        const int aliveMask = _mm_movemask_ps(alive);
+        const int diedMask = _mm_movemask_ps(_mm_andnot_ps(alive, wasAlive));
+        if ((aliveMask | diedMask) == 0)
+        {
+            continue;
+        }
+        for (unsigned int lane = 0; lane < PARTICLE_SIMD_WIDTH; ++lane)
+        {
+            const unsigned int particle = i + lane;
+            if (aliveMask & (1 << lane))
+            {
+                this->instances.push_back({ glm::vec2(this->positionsX[particle], this->positionsY[particle]),
+                    glm::vec4(this->colorsR[particle], this->colorsG[particle], this->colorsB[particle], this->colorsA[particle]) });
+            }
+            else if (diedMask & (1 << lane))
+            {
+                this->freeParticles.push_back(particle);
+            }
         }
     }
+#else
+    this->updateParticles(0, paddedAmount, dt);
+#endif
+    this->updateTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 // render all particles
 void ParticleGenerator::Draw()
 {
-    // use additive blending to give it a 'glow' effect
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-    this->shader.use();
-    for (Particle& particle : this->particles)
+    const auto start = std::chrono::steady_clock::now();
+    this->instanceStream.beginFrame();
+    if (!this->instances.empty())
     {
-        if (particle.Life > 0.0f)
+        // aligned to the instance size, the frame's instances start at a whole instance of the stream
+        const size_t offset = this->instanceStream.write(this->instances.data(), this->instances.size() * sizeof(ParticleInstance), sizeof(ParticleInstance));
+        if (this->instanceStream.getID() != this->instanceVBO)
         {
-            this->shader.setVec2("offset", particle.Position);
-            this->shader.setVec4("color", particle.Color);
-            this->texture.Bind();
-            glBindVertexArray(this->VAO);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
+            this->bindInstanceBuffer();
         }
+
+        // use additive blending to give it a 'glow' effect
+        GLState::blendFunc(GL_SRC_ALPHA, GL_ONE);
+        this->shader.use();
+        this->texture.Bind();
+        GLState::bindVertexArray(this->VAO);
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(this->instances.size()),
+            static_cast<GLuint>(offset / sizeof(ParticleInstance)));
+        // don't forget to reset to default blending mode
+        GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     }
-    // don't forget to reset to default blending mode
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    this->drawTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned int ParticleGenerator::GetAmount() const
+{
+    return this->amount;
+}
+
+unsigned int ParticleGenerator::GetLiveCount() const
+{
+    return static_cast<unsigned int>(this->instances.size());
+}
+
+void ParticleGenerator::ShowStats() const
+{
+    std::cout << "Particles: " << this->GetLiveCount() << " / " << this->amount << " alive, update " << this->updateTimeMs 
+        << " ms, upload and draw " << this->drawTimeMs << " ms" << std::endl;
+    this->instanceStream.showStats("Particles");
 }
 
 void ParticleGenerator::init()
 {
     // set up mesh and attribute properties
-    unsigned int VBO;
     float particle_quad[] = {
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f,
@@ -68,54 +141,100 @@ void ParticleGenerator::init()
         1.0f, 0.0f, 1.0f, 0.0f
     };
     glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(this->VAO);
+    glGenBuffers(1, &this->quadVBO);
+    GLState::bindVertexArray(this->VAO);
     // fill mesh buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
     // set mesh attributes
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    this->bindInstanceBuffer();
 
-    // create this->amount default particle instances
-	particles.reserve(this->amount);
-    for (unsigned int i = 0; i < this->amount; ++i)
+    // create this->amount dead particles
+    const unsigned int paddedAmount = (this->amount + PARTICLE_SIMD_WIDTH - 1) / PARTICLE_SIMD_WIDTH * PARTICLE_SIMD_WIDTH;
+    for (std::vector<float>* values : { &this->positionsX, &this->positionsY, &this->velocitiesX, &this->velocitiesY, &this->lives })
     {
-        this->particles.emplace_back();
+        values->assign(paddedAmount, 0.0f);
     }
+    for (std::vector<float>* values : { &this->colorsR, &this->colorsG, &this->colorsB, &this->colorsA })
+    {
+        values->assign(paddedAmount, 1.0f);
+    }
+    // reversed so that the first particles are used first
+    this->freeParticles.reserve(this->amount);
+    for (unsigned int i = this->amount; i > 0; --i)
+    {
+        this->freeParticles.push_back(i - 1);
+    }
+    this->instances.reserve(this->amount);
+}
+
+void ParticleGenerator::bindInstanceBuffer()
+{
+    // the attributes start at the beginning of the stream, each frame's instances are selected by the base instance
+    this->instanceVBO = this->instanceStream.getID();
+    GLState::bindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Offset));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Color));
+    glVertexAttribDivisor(2, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
 }
 
-// stores the index of the last particle used (for quick access to next dead particle)
-unsigned int lastUsedParticle = 0;
 unsigned int ParticleGenerator::firstUnusedParticle()
 {
-    // first search from last used particle, this will usually return almost instantly
-    for (unsigned int i = lastUsedParticle; i < this->amount; ++i) {
-        if (this->particles[i].Life <= 0.0f) {
-            lastUsedParticle = i;
-            return i;
-        }
-    }
-    // otherwise, do a linear search
-    for (unsigned int i = 0; i < lastUsedParticle; ++i) {
-        if (this->particles[i].Life <= 0.0f) {
-            lastUsedParticle = i;
-            return i;
-        }
+    if (!this->freeParticles.empty())
+    {
+        const unsigned int particle = this->freeParticles.back();
+        this->freeParticles.pop_back();
+        return particle;
     }
-    // all particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved)
-    lastUsedParticle = 0;
-    return 0;
+    // all particles are taken, override the oldest ones in turn (note that if it repeatedly hits this case, more particles should be reserved)
+    const unsigned int particle = this->nextOverwrittenParticle;
+    this->nextOverwrittenParticle = (this->nextOverwrittenParticle + 1) % this->amount;
+    return particle;
 }
 
-void ParticleGenerator::respawnParticle(Particle& particle, GameObject& object, glm::vec2 offset)
+void ParticleGenerator::respawnParticle(unsigned int particle, GameObject& object, glm::vec2 offset)
 {
     float random = ((rand() % 100) - 50) / 10.0f;
     float rColor = 0.5f + ((rand() % 100) / 100.0f);
-    particle.Position = object.Position + random + offset;
-    particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
-    particle.Life = 1.0f;
-    particle.Velocity = object.Velocity * 0.1f;
+    const glm::vec2 position = object.Position + random + offset;
+    const glm::vec2 velocity = object.Velocity * 0.1f;
+    this->positionsX[particle] = position.x;
+    this->positionsY[particle] = position.y;
+    this->velocitiesX[particle] = velocity.x;
+    this->velocitiesY[particle] = velocity.y;
+    this->colorsR[particle] = rColor;
+    this->colorsG[particle] = rColor;
+    this->colorsB[particle] = rColor;
+    this->colorsA[particle] = 1.0f;
+    this->lives[particle] = 1.0f;
 }
 
+void ParticleGenerator::updateParticles(unsigned int begin, unsigned int end, float dt)
+{
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        const bool wasAlive = this->lives[i] > 0.0f;
+        this->lives[i] -= dt; // reduce life
+        if (this->lives[i] > 0.0f)
+        {	// particle is alive, thus update
+            this->positionsX[i] -= this->velocitiesX[i] * dt;
+            this->positionsY[i] -= this->velocitiesY[i] * dt;
+            this->colorsA[i] -= dt * PARTICLE_FADE_SPEED;
+            this->instances.push_back({ glm::vec2(this->positionsX[i], this->positionsY[i]),
+                glm::vec4(this->colorsR[i], this->colorsG[i], this->colorsB[i], this->colorsA[i]) });
+        }
+        else if (wasAlive)
+        {
+            this->freeParticles.push_back(i);
+        }
+    }
+}
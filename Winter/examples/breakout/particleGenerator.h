@@ -1,48 +1,76 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "shader.h"
+#include "streamBuffer.h"
 #include "texture2D.h"
 #include "gameObject.h"
 
-// Represents a single particle and its state
-struct Particle {
-    glm::vec2 Position, Velocity;
+// Per instance attributes of a live particle, streamed to the GPU every frame
+struct ParticleInstance {
+    glm::vec2 Offset;
     glm::vec4 Color;
-    float     Life;
-
-    Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) {}
 };
 
 // ParticleGenerator acts as a container for rendering a large number of 
 // particles by repeatedly spawning and updating particles and killing 
 // them after a given amount of time.
+// The particles are stored as a structure of arrays updated 4 at a time, the dead ones are kept in a free list,
+// and all the live ones are drawn with a single instanced draw call.
 class ParticleGenerator
 {
 public:
     // constructor
     ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount);
     ~ParticleGenerator();
+    ParticleGenerator(const ParticleGenerator& other) = delete;
+    ParticleGenerator& operator=(const ParticleGenerator& other) = delete;
     // update all particles
     void Update(float dt, GameObject& object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
     // render all particles
     void Draw();
+    unsigned int GetAmount() const;
+    unsigned int GetLiveCount() const;
+    // live particles, CPU time of the last Update and Draw, and instance stream stalls
+    void ShowStats() const;
 private:
-    // state
-    std::vector<Particle> particles;
+    // state, the arrays are padded to a multiple of 4 particles, the padding is never alive
+    std::vector<float> positionsX, positionsY;
+    std::vector<float> velocitiesX, velocitiesY;
+    std::vector<float> colorsR, colorsG, colorsB, colorsA;
+    std::vector<float> lives;
+    // indices of the dead particles, the last one is reused first
+    std::vector<uint32_t> freeParticles;
+    // particle overwritten when there is no dead one left
+    unsigned int nextOverwrittenParticle;
     unsigned int amount;
+    // live particles compacted by Update, uploaded by Draw
+    std::vector<ParticleInstance> instances;
     // render state
     Shader shader;
     Texture2D texture;
     unsigned int VAO;
+    unsigned int quadVBO;
+    // the instances of the last frames stay in their own region of the stream until the GPU is done with them
+    StreamBuffer instanceStream;
+    // stream buffer the instance attributes point to, it changes when the stream grows
+    unsigned int instanceVBO;
+    // timings
+    double updateTimeMs;
+    double drawTimeMs;
     // initializes buffer and vertex attributes
     void init();
-    // returns the first Particle index that's currently unused e.g. Life <= 0.0f or 0 if no particle is currently inactive
+    // points the instance attributes to the stream buffer
+    void bindInstanceBuffer();
+    // returns the index of a dead particle, or overwrites a live one if all are taken
     unsigned int firstUnusedParticle();
     // respawns particle
-    void respawnParticle(Particle& particle, GameObject& object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    void respawnParticle(unsigned int particle, GameObject& object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    // update of the particles [begin, end) without SIMD, used when BREAKOUT_PARTICLES_SSE is not defined (the padded arrays leave the SIMD version no tail)
+    void updateParticles(unsigned int begin, unsigned int end, float dt);
 };
@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include "glState.h"
+
 PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int height)
     : PostProcessingShader(shader), Texture(), Width(width), Height(height), 
 	Confuse(false), Chaos(false), Shake(false), MSFBO(0), FBO(0), RBO(0), VAO(0)
@@ -11,19 +13,19 @@ PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int hei
     glGenFramebuffers(1, &this->FBO);
     glGenRenderbuffers(1, &this->RBO);
     // initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
     glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGB, width, height); // allocate storage for render buffer object
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO); // attach MS render buffer object to framebuffer
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
     // also initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, this->FBO);
     this->Texture.Generate(width, height, nullptr);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0); // attach texture to framebuffer as its color attachment
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // initialize render data and uniforms
     this->initRenderData();
@@ -58,25 +60,25 @@ PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int hei
 
 PostProcessor::~PostProcessor()
 {
-	glDeleteFramebuffers(1, &this->MSFBO);
-	glDeleteFramebuffers(1, &this->FBO);
+	GLState::deleteFramebuffers(1, &this->MSFBO);
+	GLState::deleteFramebuffers(1, &this->FBO);
 	glDeleteRenderbuffers(1, &this->RBO);
-	glDeleteVertexArrays(1, &this->VAO);
+	GLState::deleteVertexArrays(1, &this->VAO);
 }
 
 void PostProcessor::BeginRender()
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 void PostProcessor::EndRender()
 {
     // now resolve multisampled color-buffer into intermediate FBO to store to texture
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
+    GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
     glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0); // binds both READ and WRITE framebuffer to default framebuffer
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0); // binds both READ and WRITE framebuffer to default framebuffer
 }
 
 void PostProcessor::Render(float time)
@@ -88,11 +90,11 @@ void PostProcessor::Render(float time)
     this->PostProcessingShader.setInt("chaos", this->Chaos);
     this->PostProcessingShader.setInt("shake", this->Shake);
     // render textured quad
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
     this->Texture.Bind();
-    glBindVertexArray(this->VAO);
+    GLState::bindVertexArray(this->VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 void PostProcessor::initRenderData()
@@ -115,10 +117,10 @@ void PostProcessor::initRenderData()
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-    glBindVertexArray(this->VAO);
+    GLState::bindVertexArray(this->VAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
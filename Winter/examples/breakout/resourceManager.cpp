@@ -6,6 +6,8 @@
 
 #include "stb_image.h"
 
+#include "glState.h"
+
 // Instantiate static variables
 std::map<std::string, Texture2D>    ResourceManager::Textures;
 std::map<std::string, Shader>       ResourceManager::Shaders;
@@ -38,10 +40,10 @@ void ResourceManager::Clear()
 {
     // (properly) delete all shaders	
     for (auto& iter : Shaders)
-        glDeleteProgram(iter.second.getID());
+        GLState::deleteProgram(iter.second.getID());
     // (properly) delete all textures
     for (auto& iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
+        GLState::deleteTextures(1, &iter.second.ID);
 }
 
 Shader ResourceManager::loadShaderFromFile(const std::string& vShaderFile, 
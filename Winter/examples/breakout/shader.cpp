@@ -6,7 +6,7 @@
 
 #include "glad/glad.h"
 
-unsigned int Shader::UNUSED_ID = 0;
+#include "glState.h"
 
 Shader::Shader(const std::string& vertexCode, const std::string& fragmentCode, const std::string& geometryCode)
 	: ID(UNUSED_ID)
@@ -21,7 +21,7 @@ Shader::Shader()
 
 void Shader::use() const
 {
-    glUseProgram(ID);
+    GLState::useProgram(ID);
 }
 
 void Shader::setBool(const std::string& name, bool value) const
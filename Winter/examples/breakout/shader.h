@@ -7,7 +7,7 @@
 class Shader
 {
 private:
-    static unsigned int UNUSED_ID;
+    static constexpr unsigned int UNUSED_ID = 0;
 	static std::string getShaderTypeString(GLenum shaderType);
 public:
     // constructor reads and builds the shader
@@ -0,0 +1,108 @@
+#include "simulationBenchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "game.h"
+
+struct SimulationRun {
+    double       TimeMs;
+    unsigned int Wins;
+    unsigned int BallsLost;
+    uint64_t     Checksum;
+};
+
+// keys go down and up the way key_callback sets them, a release also clears KeysProcessed
+void SetKey(Game& game, int key, bool pressed)
+{
+    game.Keys[key] = pressed;
+    if (!pressed)
+        game.KeysProcessed[key] = false;
+}
+
+void ScriptInput(Game& game, unsigned int frame)
+{
+    // ENTER is tapped on the menu and win screens, and each return to the menu also moves to the next level
+    const bool tap = frame % 2 == 0;
+    SetKey(game, GLFW_KEY_ENTER, game.State != GAME_ACTIVE && tap);
+    SetKey(game, GLFW_KEY_W, game.State == GAME_MENU && tap && frame > 0);
+    // the paddle follows the ball, off its center by an offset sweeping the bounce angles
+    const float target = game.Ball->Position.x + game.Ball->Radius + std::sin(frame * 0.002f) * game.Player->Size.x * 0.4f;
+    const float paddle = game.Player->Position.x + game.Player->Size.x / 2.0f;
+    SetKey(game, GLFW_KEY_A, game.State == GAME_ACTIVE && target < paddle - 5.0f);
+    SetKey(game, GLFW_KEY_D, game.State == GAME_ACTIVE && target > paddle + 5.0f);
+    // launched half a second after being stuck at the latest
+    SetKey(game, GLFW_KEY_SPACE, game.State == GAME_ACTIVE && frame % 60 == 0);
+}
+
+// FNV-1a of the state the simulation ends in
+uint64_t HashState(const Game& game)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    const auto add = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3;
+    };
+    add(&game.State, sizeof(game.State));
+    add(&game.Level, sizeof(game.Level));
+    add(&game.Lives, sizeof(game.Lives));
+    add(&game.Ball->Position, sizeof(game.Ball->Position));
+    add(&game.Ball->Velocity, sizeof(game.Ball->Velocity));
+    add(&game.Player->Position, sizeof(game.Player->Position));
+    add(&game.Player->Size, sizeof(game.Player->Size));
+    for (const GameLevel& level : game.Levels)
+        for (const GameObject& brick : level.Bricks)
+            add(&brick.Destroyed, sizeof(brick.Destroyed));
+    for (const PowerUp& powerUp : game.PowerUps)
+    {
+        add(&powerUp.Position, sizeof(powerUp.Position));
+        add(&powerUp.Duration, sizeof(powerUp.Duration));
+    }
+    return hash;
+}
+
+SimulationRun SimulateGame(unsigned int width, unsigned int height, unsigned int benchmarkBricks, unsigned int frames)
+{
+    Game game(width, height);
+    game.BenchmarkBricks = benchmarkBricks;
+    game.InitSimulation(DEFAULT_SIMULATION_SEED);
+
+    SimulationRun run = {};
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int frame = 0; frame < frames; ++frame)
+    {
+        const GameState previousState = game.State;
+        const unsigned int previousLives = game.Lives;
+        ScriptInput(game, frame);
+        game.ProcessInput(SIMULATION_TIMESTEP);
+        game.Update(SIMULATION_TIMESTEP);
+        // winning also resets the lives
+        if (previousState == GAME_ACTIVE && game.State == GAME_WIN)
+            run.Wins++;
+        else if (game.Lives != previousLives)
+            run.BallsLost++;
+    }
+    run.TimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    run.Checksum = HashState(game);
+    return run;
+}
+
+void RunSimulationBenchmark(unsigned int width, unsigned int height, unsigned int benchmarkBricks, unsigned int frames)
+{
+    std::cout << "Simulation benchmark: " << frames << " updates of " << SIMULATION_TIMESTEP * 1000.0f << " ms";
+    if (benchmarkBricks > 0)
+        std::cout << ", first level of " << benchmarkBricks << " bricks";
+    std::cout << std::endl;
+
+    const SimulationRun run = SimulateGame(width, height, benchmarkBricks, frames);
+    std::cout << "Simulation: " << frames / (run.TimeMs / 1000.0) << " updates per second, " << run.TimeMs * 1000.0 / frames << " us per update, "
+        << run.Wins << " levels won, " << run.BallsLost << " balls lost" << std::endl;
+
+    // the same input has to lead to the same state
+    const SimulationRun replay = SimulateGame(width, height, benchmarkBricks, frames);
+    std::cout << "Replay: " << (replay.Checksum == run.Checksum ? "same state" : "DIFFERENT STATE") << " (checksum " << std::hex << run.Checksum << std::dec << ")" << std::endl;
+}
\ No newline at end of file
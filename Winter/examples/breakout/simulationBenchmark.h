@@ -0,0 +1,9 @@
+#pragma once
+
+const unsigned int DEFAULT_SIMULATION_BENCHMARK_FRAMES = 1000000;
+
+// Headless benchmark of the game logic: a game without renderers is stepped by SIMULATION_TIMESTEP on scripted input,
+// the paddle following the ball, and the updates per second are reported. The run is then replayed to check
+// that it ends in the same state. Does not need a GL context.
+// benchmarkBricks replaces the first level by a generated one as in the sprite benchmark, 0 keeps the game's levels.
+void RunSimulationBenchmark(unsigned int width, unsigned int height, unsigned int benchmarkBricks, unsigned int frames);
\ No newline at end of file
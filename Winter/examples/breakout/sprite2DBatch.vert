@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4 positionSize; // per sprite
+layout (location = 2) in vec4 colorRotation; // per sprite, rotation in degrees
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+
+uniform mat4 projection;
+
+void main()
+{
+    // rotate from the center of the sprite
+    vec2 size = positionSize.zw;
+    float angle = radians(colorRotation.w);
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    vec2 position = positionSize.xy + 0.5 * size + rotation * (vertex.xy * size - 0.5 * size);
+
+    TexCoords = vertex.zw;
+    SpriteColor = colorRotation.rgb;
+    gl_Position = projection * vec4(position, 0.0, 1.0);
+}
\ No newline at end of file
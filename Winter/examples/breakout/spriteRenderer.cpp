@@ -1,22 +1,41 @@
 #include "spriteRenderer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
-SpriteRenderer::SpriteRenderer(Shader& shader)
-	: shader(shader), quadVAO(0)
+#include "glState.h"
+
+SpriteRenderer::SpriteRenderer(Shader& shader, Shader& batchShader)
+	: shader(shader), batchShader(batchShader), quadVAO(0), quadVBO(0), batchVAO(0),
+	instanceStream(INITIAL_INSTANCE_CAPACITY * sizeof(SpriteInstance)), instanceVBO(0),
+	batching(true), layer(0), lastTextureSlot(0), spriteCount(0), drawCount(0), flushTimeMs(0.0)
 {
 	this->initRenderData();
 }
 
 SpriteRenderer::~SpriteRenderer()
 {
-	glDeleteVertexArrays(1, &this->quadVAO);
+	GLState::deleteVertexArrays(1, &this->quadVAO);
+	GLState::deleteVertexArrays(1, &this->batchVAO);
+	glDeleteBuffers(1, &this->quadVBO);
 }
 
 void SpriteRenderer::DrawSprite(Texture2D& texture, glm::vec2 position,
     glm::vec2 size, float rotate, glm::vec3 color)
 {
+    this->spriteCount++;
+    if (this->batching)
+    {
+        this->sprites.push_back(SpriteInstance{ glm::vec4(position, size), glm::vec4(color, rotate) });
+        this->spriteBatches.push_back(this->layer << TEXTURE_BITS | this->getTextureSlot(texture.ID));
+        return;
+    }
+
     // prepare transformations
     this->shader.use();
     glm::mat4 model = glm::mat4(1.0f);
@@ -32,18 +51,107 @@ void SpriteRenderer::DrawSprite(Texture2D& texture, glm::vec2 position,
     this->shader.setMat4("model", value_ptr(model));
     this->shader.setVec3("spriteColor", color);
 
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
     texture.Bind();
 
-    glBindVertexArray(this->quadVAO);
+    GLState::bindVertexArray(this->quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    this->drawCount++;
+}
+
+void SpriteRenderer::SetLayer(unsigned int layer)
+{
+    this->layer = std::min(layer, (1u << LAYER_BITS) - 1);
+}
+
+void SpriteRenderer::Flush()
+{
+    if (this->sprites.empty())
+    {
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    // the sprite index in the low bits keeps the submission order within a texture
+    this->keys.resize(this->sprites.size());
+    for (size_t i = 0; i < this->sprites.size(); i++)
+    {
+        this->keys[i] = uint64_t(this->spriteBatches[i]) << 32 | uint64_t(i);
+    }
+    std::sort(this->keys.begin(), this->keys.end());
+    this->sortedSprites.resize(this->sprites.size());
+    for (size_t i = 0; i < this->keys.size(); i++)
+    {
+        this->sortedSprites[i] = this->sprites[static_cast<uint32_t>(this->keys[i])];
+    }
+
+    // aligned to the instance size, the flush's sprites start at a whole instance of the stream
+    const size_t offset = this->instanceStream.write(this->sortedSprites.data(), this->sortedSprites.size() * sizeof(SpriteInstance), sizeof(SpriteInstance));
+    if (this->instanceStream.getID() != this->instanceVBO)
+    {
+        this->bindInstanceBuffer();
+    }
+    const size_t baseInstance = offset / sizeof(SpriteInstance);
+
+    this->batchShader.use();
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindVertexArray(this->batchVAO);
+    size_t first = 0;
+    while (first < this->keys.size())
+    {
+        // one draw for each run of sprites sharing a layer and a texture
+        const uint64_t batchKey = this->keys[first] >> 32;
+        size_t last = first + 1;
+        while (last < this->keys.size() && (this->keys[last] >> 32) == batchKey)
+        {
+            last++;
+        }
+        GLState::bindTexture(GL_TEXTURE_2D, this->textureSlots[batchKey & ((1u << TEXTURE_BITS) - 1)]);
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(last - first), static_cast<GLuint>(baseInstance + first));
+        this->drawCount++;
+        first = last;
+    }
+
+    this->sprites.clear();
+    this->spriteBatches.clear();
+    this->flushTimeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SpriteRenderer::SetBatching(bool batching)
+{
+    this->Flush();
+    this->batching = batching;
+}
+
+bool SpriteRenderer::IsBatching() const
+{
+    return this->batching;
+}
+
+void SpriteRenderer::BeginFrame()
+{
+    this->instanceStream.beginFrame();
+    this->layer = 0;
+    this->spriteCount = 0;
+    this->drawCount = 0;
+    this->flushTimeMs = 0.0;
+}
+
+void SpriteRenderer::ShowStats() const
+{
+    std::cout << "Sprites: " << this->spriteCount << " sprites, " << this->drawCount << " draw calls"
+        << (this->batching ? ", flush " : " (batching disabled)");
+    if (this->batching)
+    {
+        std::cout << this->flushTimeMs << " ms";
+    }
+    std::cout << std::endl;
+    this->instanceStream.showStats("Sprites");
 }
 
 void SpriteRenderer::initRenderData()
 {
     // configure VAO/VBO
-    unsigned int VBO;
     float vertices[] = {
         // pos      // tex
         0.0f, 1.0f, 0.0f, 1.0f,
@@ -56,14 +164,56 @@ void SpriteRenderer::initRenderData()
     };
 
     glGenVertexArrays(1, &this->quadVAO);
-    glGenBuffers(1, &VBO);
+    glGenVertexArrays(1, &this->batchVAO);
+    glGenBuffers(1, &this->quadVBO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-    glBindVertexArray(this->quadVAO);
+    GLState::bindVertexArray(this->quadVAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+    // the batched sprites share the quad, their transform and color are instance attributes
+    GLState::bindVertexArray(this->batchVAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    this->bindInstanceBuffer();
+}
+
+void SpriteRenderer::bindInstanceBuffer()
+{
+    // the attributes start at the beginning of the stream, each flush's sprites are selected by the base instance
+    this->instanceVBO = this->instanceStream.getID();
+    GLState::bindVertexArray(this->batchVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, PositionSize));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, ColorRotation));
+    glVertexAttribDivisor(2, 1);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
+}
+
+unsigned int SpriteRenderer::getTextureSlot(unsigned int texture)
+{
+    // a handful of textures, consecutive sprites mostly share theirs
+    if (this->lastTextureSlot < this->textureSlots.size() && this->textureSlots[this->lastTextureSlot] == texture)
+    {
+        return this->lastTextureSlot;
+    }
+    for (size_t slot = 0; slot < this->textureSlots.size(); slot++)
+    {
+        if (this->textureSlots[slot] == texture)
+        {
+            this->lastTextureSlot = static_cast<unsigned int>(slot);
+            return this->lastTextureSlot;
+        }
+    }
+    this->textureSlots.push_back(texture);
+    this->lastTextureSlot = static_cast<unsigned int>(this->textureSlots.size() - 1);
+    return this->lastTextureSlot;
 }
\ No newline at end of file
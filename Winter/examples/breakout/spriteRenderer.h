@@ -1,23 +1,77 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "glm/glm.hpp"
 
 #include "shader.h"
+#include "streamBuffer.h"
 #include "texture2d.h"
 
+// Per instance attributes of a batched sprite
+struct SpriteInstance {
+    glm::vec4 PositionSize; // top left corner and size in pixels
+    glm::vec4 ColorRotation; // color and rotation in degrees around the center
+};
 
+// SpriteRenderer draws textured quads. In batching mode, DrawSprite only appends the sprite to a CPU stream,
+// Flush sorts the stream by layer then texture and issues one instanced draw per texture of each layer.
 class SpriteRenderer
 {
 public:
-    SpriteRenderer(Shader& shader);
+    SpriteRenderer(Shader& shader, Shader& batchShader);
     ~SpriteRenderer();
+    SpriteRenderer(const SpriteRenderer& other) = delete;
+    SpriteRenderer& operator=(const SpriteRenderer& other) = delete;
 
     void DrawSprite(Texture2D& texture, glm::vec2 position,
         glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f,
         glm::vec3 color = glm::vec3(1.0f));
+    // The sprites of a layer are drawn over the ones of the lower layers, in any order within the layer
+    void SetLayer(unsigned int layer);
+    // Draws the batched sprites, required before drawing anything which is not a sprite over them
+    void Flush();
+    // Without batching every sprite is drawn right away with its own draw call
+    void SetBatching(bool batching);
+    bool IsBatching() const;
+    // Resets the stats and the layer, and moves to the next region of the instance stream
+    void BeginFrame();
+    // sprites, draw calls, CPU time of the flushes of the last frame and instance stream stalls
+    void ShowStats() const;
 private:
+    static const unsigned int LAYER_BITS = 8;
+    static const unsigned int TEXTURE_BITS = 24;
+    // sprites of a frame the stream holds before growing
+    static const unsigned int INITIAL_INSTANCE_CAPACITY = 1024;
+
     Shader       shader;
+    Shader       batchShader;
     unsigned int quadVAO;
+    unsigned int quadVBO;
+    unsigned int batchVAO;
+    // every flush of the frame appends its sorted sprites to the frame's region of the stream
+    StreamBuffer instanceStream;
+    // stream buffer the instance attributes point to, it changes when the stream grows
+    unsigned int instanceVBO;
+    bool         batching;
+    unsigned int layer;
+    // pending sprites and their layer and texture slot, in submission order
+    std::vector<SpriteInstance> sprites;
+    std::vector<uint32_t>       spriteBatches;
+    // (layer, texture slot, sprite index) keys, and the sprites in the sorted order
+    std::vector<uint64_t>       keys;
+    std::vector<SpriteInstance> sortedSprites;
+    // texture names by slot, the dense slots fit in the key
+    std::vector<unsigned int>   textureSlots;
+    unsigned int                lastTextureSlot;
+    // stats
+    unsigned int spriteCount;
+    unsigned int drawCount;
+    double       flushTimeMs;
 
     void initRenderData();
+    // points the instance attributes to the stream buffer
+    void bindInstanceBuffer();
+    unsigned int getTextureSlot(unsigned int texture);
 };
\ No newline at end of file
@@ -1,19 +1,19 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <ft2build.h>
-#include FT_FREETYPE_H
 
+#include "glState.h"
 #include "textRenderer.h"
 #include "pathManager.h"
 #include "resourceManager.h"
 
 
 TextRenderer::TextRenderer(unsigned int width, unsigned int height)
-	: TextShader(), Characters(), VAO(0), VBO(0)
+	: TextShader(), VAO(0), VBO(0), glyphs(), glyphScale(1.0f), baseline(0.0f), cachedGeneration(0), vertexCount(0), vertexCapacity(INITIAL_VERTEX_CAPACITY)
 {
 	const std::string TEXT_VERTEX_PATH = PathManager::getProjectPath() + "/examples/breakout/" + "text_2d.vert";
 	const std::string TEXT_FRAGMENT_PATH = PathManager::getProjectPath() + "/examples/breakout/" + "text_2d.frag";
@@ -24,129 +24,137 @@ TextRenderer::TextRenderer(unsigned int width, unsigned int height)
     this->TextShader.use();
     this->TextShader.setMat4("projection", value_ptr(proj));
     this->TextShader.setInt("text", 0);
-    // configure VAO/VBO for texture quads
+    // configure VAO/VBO for the cached strings' quads
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
-    glBindVertexArray(this->VAO);
+    GLState::bindVertexArray(this->VAO);
     glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 4 * this->vertexCapacity, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 TextRenderer::~TextRenderer()
 {
 	glDeleteBuffers(1, &this->VBO);
-	glDeleteVertexArrays(1, &this->VAO);
-	for (auto& c : Characters)
-	{
-		glDeleteTextures(1, &c.second.TextureID);
-	}
+	GLState::deleteVertexArrays(1, &this->VAO);
 }
 
 void TextRenderer::Load(std::string font, unsigned int fontSize)
 {
-    // first clear the previously loaded Characters
-    this->Characters.clear();
-    // then initialize and load the FreeType library
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft)) // all functions return a value different than 0 whenever an error occurred
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-    // load font as face
-    FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
-        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
-    // set size to load glyphs as
-    FT_Set_Pixel_Sizes(face, 0, fontSize);
-    // disable byte-alignment restriction
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    // then for the first 128 ASCII characters, pre-load/compile their characters and store them
-    for (GLubyte c = 0; c < 128; c++)
-    {
-        // load character glyph 
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-            continue;
-        }
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // now store character for later use
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<unsigned int>(face->glyph->advance.x)
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
-    }
-    glBindTexture(GL_TEXTURE_2D, 0);
-    // destroy FreeType once we're finished
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    // first clear the previously loaded font and strings
+    this->cachedTexts.clear();
+    this->vertexCount = 0;
+    // one rasterization size for every font size, the distance fields scale
+    this->glyphs = std::make_unique<GlyphCache>(font);
+    this->glyphScale = fontSize / this->glyphs->getPixelSize();
+    this->cachedGeneration = this->glyphs->getGeneration();
+    // offset of the tallest latin letters' top from the baseline
+    const SDFGlyph& h = this->glyphs->getGlyph(U'H');
+    this->baseline = (h.bearing.y - this->glyphs->getSpread()) * this->glyphScale;
 }
 
-void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
+void TextRenderer::RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color)
 {
-    // activate corresponding render state	
+    if (!this->glyphs)
+        return;
+    // the UVs of the cached strings are out of date once the atlas grew or evicted a glyph
+    if (this->glyphs->getGeneration() != this->cachedGeneration)
+    {
+        this->cachedTexts.clear();
+        this->vertexCount = 0;
+        this->cachedGeneration = this->glyphs->getGeneration();
+    }
+    auto it = this->cachedTexts.find(text);
+    const TextRun run = it != this->cachedTexts.end() ? it->second : this->cacheText(text);
+    if (run.Count == 0)
+        return;
+
+    // activate corresponding render state, the quads are moved and scaled by the shader
     this->TextShader.use();
     this->TextShader.setVec3("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
+    this->TextShader.setVec3("offsetScale", x, y, scale);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, this->glyphs->getTexture());
+    GLState::bindVertexArray(this->VAO);
+    glDrawArrays(GL_TRIANGLES, run.First, run.Count);
+}
+
+void TextRenderer::BeginFrame()
+{
+    if (this->glyphs)
+        this->glyphs->nextFrame();
+}
+
+void TextRenderer::ShowStats() const
+{
+    if (this->glyphs)
+        this->glyphs->showStats();
+}
 
-    // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
+TextRenderer::TextRun TextRenderer::cacheText(const std::string& text)
+{
+    const std::u32string codePoints = GlyphCache::decodeUTF8(text);
+    // the glyphs missing from the atlas may grow it, the string is then built again with the new UVs
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        const uint64_t generation = this->glyphs->getGeneration();
+        // quads at the origin and scale 1
+        this->vertices.clear();
+        float x = 0.0f;
+        for (const char32_t c : codePoints)
+        {
+            const SDFGlyph& ch = this->glyphs->getGlyph(c);
+
+            float xpos = x + ch.bearing.x * this->glyphScale;
+            float ypos = this->baseline - ch.bearing.y * this->glyphScale;
+
+            float w = ch.size.x * this->glyphScale;
+            float h = ch.size.y * this->glyphScale;
+            if (w > 0.0f && h > 0.0f)
+            {
+                const float quad[6][4] = {
+                    { xpos,     ypos + h,   ch.uvMin.x, ch.uvMax.y },
+                    { xpos + w, ypos,       ch.uvMax.x, ch.uvMin.y },
+                    { xpos,     ypos,       ch.uvMin.x, ch.uvMin.y },
+
+                    { xpos,     ypos + h,   ch.uvMin.x, ch.uvMax.y },
+                    { xpos + w, ypos + h,   ch.uvMax.x, ch.uvMax.y },
+                    { xpos + w, ypos,       ch.uvMax.x, ch.uvMin.y }
+                };
+                this->vertices.insert(this->vertices.end(), &quad[0][0], &quad[0][0] + 6 * 4);
+            }
+            // now advance cursors for next glyph
+            x += ch.advance * this->glyphScale;
+        }
+        if (generation == this->glyphs->getGeneration())
+            break;
+    }
+    // and the strings cached before are out of date
+    if (this->glyphs->getGeneration() != this->cachedGeneration)
     {
-        Character ch = Characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 0.0f },
-
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f }
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
+        this->cachedTexts.clear();
+        this->vertexCount = 0;
+        this->cachedGeneration = this->glyphs->getGeneration();
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const unsigned int count = static_cast<unsigned int>(this->vertices.size() / 4);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    if (this->vertexCount + count > this->vertexCapacity)
+    {
+        // start over with an empty buffer, large enough for the string
+        this->cachedTexts.clear();
+        this->vertexCount = 0;
+        this->vertexCapacity = std::max(this->vertexCapacity, count);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 4 * this->vertexCapacity, NULL, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, sizeof(float) * 4 * this->vertexCount, sizeof(float) * this->vertices.size(), this->vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    const TextRun run = { static_cast<int>(this->vertexCount), count };
+    this->vertexCount += count;
+    this->cachedTexts.emplace(text, run);
+    return run;
 }
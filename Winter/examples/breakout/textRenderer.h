@@ -1,41 +1,59 @@
 #pragma once
 
-#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "glyphCache.h"
 #include "texture2D.h"
 #include "shader.h"
 
 
-/// Holds all state information relevant to a character as loaded using FreeType
-struct Character {
-    unsigned int TextureID; // ID handle of the glyph texture
-    glm::ivec2   Size;      // size of glyph
-    glm::ivec2   Bearing;   // offset from baseline to left/top of glyph
-    unsigned int Advance;   // horizontal offset to advance to next glyph
-};
-
-
 // A renderer class for rendering text displayed by a font loaded using the 
-// FreeType library. A single font is loaded, processed into a list of Character
-// items for later rendering.
+// FreeType library. A single font is loaded, its glyphs are rasterized as
+// distance fields into an atlas on their first use, for any UTF-8 character.
+// The quads of a string are built once, at the origin and scale 1,
+// and kept in a vertex buffer: drawing a string already drawn is a single draw call without any upload.
 class TextRenderer
 {
 public:
-    // holds a list of pre-compiled Characters
-    std::map<char, Character> Characters;
     // shader used for text rendering
     Shader TextShader;
     // constructor
     TextRenderer(unsigned int width, unsigned int height);
     ~TextRenderer();
-    // pre-compiles a list of characters from the given font
+    // loads the given font, a scale of 1 draws it at fontSize pixels
     void Load(std::string font, unsigned int fontSize);
-    // renders a string of text using the precompiled list of characters
-    void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // renders a UTF-8 string of text, its glyphs are rasterized on their first use
+    void RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // the glyphs used during the frame are kept in the atlas
+    void BeginFrame();
+    // glyph cache stats
+    void ShowStats() const;
 private:
+    // vertices of a string in the vertex buffer
+    struct TextRun {
+        int          First;
+        unsigned int Count;
+    };
+    // the cache is emptied when the vertex buffer is full, the strings are rebuilt on their next draw
+    static const unsigned int INITIAL_VERTEX_CAPACITY = 6 * 4096;
+
     // render state
     unsigned int VAO, VBO;
+    std::unique_ptr<GlyphCache> glyphs;
+    // quads size of a glyph pixel, and offset from the top of a line to the baseline
+    float glyphScale;
+    float baseline;
+    // strings already in the vertex buffer, built with the glyph cache generation
+    std::unordered_map<std::string, TextRun> cachedTexts;
+    uint64_t cachedGeneration;
+    unsigned int vertexCount, vertexCapacity;
+    std::vector<float> vertices;
+    // builds the quads of a string and appends them to the vertex buffer
+    TextRun cacheText(const std::string& text);
 };
@@ -7,6 +7,9 @@ uniform vec3 textColor;
 
 void main()
 {    
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
+    // signed distance field, the edge is at 0.5: antialiased over about a screen pixel at any scale
+    float distance = texture(text, TexCoords).r;
+    float width = fwidth(distance);
+    vec4 sampled = vec4(1.0, 1.0, 1.0, smoothstep(0.5 - width, 0.5 + width, distance));
     color = vec4(textColor, 1.0) * sampled;
 }  
@@ -3,10 +3,11 @@ layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
 out vec2 TexCoords;
 
 uniform mat4 projection;
+uniform vec3 offsetScale; // position of the string and scale of its quads
 
 void main()
 {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+    gl_Position = projection * vec4(offsetScale.xy + vertex.xy * offsetScale.z, 0.0, 1.0);
     TexCoords = vertex.zw;
 } 
 
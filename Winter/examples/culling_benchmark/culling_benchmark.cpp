@@ -0,0 +1,104 @@
+﻿// Benchmark: Frustum culling
+// Culls 1M bounding spheres against the camera frustum each frame, one at a time and 4 at a time with SSE
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "bounds.h"
+#include "camera.h"
+#include "frustum.h"
+
+double cullMs(const Frustum& frustum, const BoundingSphereBatch& spheres, std::vector<unsigned int>& visibleIndices, bool useSIMD);
+
+int main()
+{
+    // DATA
+    // ------------------------------------
+    const int32_t WINDOW_WIDTH = 800;
+    const int32_t WINDOW_HEIGHT = 600;
+    const unsigned int NB_SPHERES = 1000000;
+    const unsigned int NB_FRAMES = 100;
+    const float FIELD_SIZE = 500.0f;
+
+    // CAMERA
+    // ------------------------------------
+    const glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 0.0f);
+    const glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+    const glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+    const glm::vec3 cameraRollYawPitch(0.0f, -90.0f, 0.0f);
+    const float cameraFOV = 45.0f;
+    const float cameraNearPlane = 0.1f;
+    const float cameraFarPlane = 250.0f;
+
+    Camera camera(cameraPos, cameraFront, cameraUp, cameraRollYawPitch, cameraFOV, cameraNearPlane, cameraFarPlane);
+
+    // SPHERES
+    // ------------------------------------
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> positionDistribution(-FIELD_SIZE, FIELD_SIZE);
+    std::uniform_real_distribution<float> radiusDistribution(0.05f, 2.0f);
+    BoundingSphereBatch spheres;
+    spheres.reserve(NB_SPHERES);
+    for (unsigned int i = 0; i < NB_SPHERES; i++)
+    {
+        const glm::vec3 center(positionDistribution(generator), positionDistribution(generator), positionDistribution(generator));
+        spheres.add(BoundingSphere{ center, radiusDistribution(generator) });
+    }
+
+    // BENCHMARK
+    // ------------------------------------
+    // the camera turns a little each frame, like it would in a game
+    std::vector<unsigned int> scalarVisible;
+    std::vector<unsigned int> simdVisible;
+    double totalScalarMs = 0.0;
+    double totalSIMDMs = 0.0;
+    double bestScalarMs = 1e9;
+    double bestSIMDMs = 1e9;
+    size_t totalVisible = 0;
+    bool isSameResult = true;
+    for (unsigned int frame = 0; frame < NB_FRAMES; frame++)
+    {
+        camera.SetYaw(-90.0f + frame * 3.6f);
+        const Frustum frustum = camera.getFrustum(WINDOW_WIDTH, WINDOW_HEIGHT);
+
+        const double scalarMs = cullMs(frustum, spheres, scalarVisible, false);
+        const double simdMs = cullMs(frustum, spheres, simdVisible, true);
+        totalScalarMs += scalarMs;
+        totalSIMDMs += simdMs;
+        bestScalarMs = std::min(bestScalarMs, scalarMs);
+        bestSIMDMs = std::min(bestSIMDMs, simdMs);
+        totalVisible += simdVisible.size();
+        isSameResult &= scalarVisible == simdVisible;
+    }
+
+    std::cout << NB_SPHERES << " spheres, " << NB_FRAMES << " frames, " << totalVisible / NB_FRAMES << " visible per frame on average" << std::endl;
+    std::cout << "Scalar: " << totalScalarMs / NB_FRAMES << " ms per frame (best " << bestScalarMs << " ms)" << std::endl;
+    std::cout << "SIMD: " << totalSIMDMs / NB_FRAMES << " ms per frame (best " << bestSIMDMs << " ms), x" << totalScalarMs / totalSIMDMs << std::endl;
+    if (!isSameResult)
+    {
+        std::cout << "ERROR::CULLING_BENCHMARK::RESULTS_DIFFER" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
+
+double cullMs(const Frustum& frustum, const BoundingSphereBatch& spheres, std::vector<unsigned int>& visibleIndices, bool useSIMD)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    if (useSIMD)
+    {
+        frustum.cullSpheres(spheres, visibleIndices);
+    }
+    else
+    {
+        frustum.cullSpheresScalar(spheres, visibleIndices);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
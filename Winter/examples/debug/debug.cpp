@@ -21,6 +21,7 @@
 
 #include "camera.h"
 #include "fpsCounter.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -142,7 +143,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    // For easy MSAA Don't forget to call: glEnable(GL_MULTISAMPLE);
+    // For easy MSAA Don't forget to call: GLState::enable(GL_MULTISAMPLE);
     // ------------------------------------
     glfwWindowHint(GLFW_SAMPLES, 4);
     // ------------------------------------
@@ -178,13 +179,13 @@ int main()
     if (flags & GL_CONTEXT_FLAG_DEBUG_BIT)
     {
         std::cout << "OpenGL Debug Context is enabled" << std::endl;
-        glEnable(GL_DEBUG_OUTPUT);
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        GLState::enable(GL_DEBUG_OUTPUT);
+        GLState::enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
         glDebugMessageCallback(glDebugOutput, nullptr);
         glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
     // ------------------------------------
@@ -292,7 +293,7 @@ int main()
 	// ------------------------------------
 
     // Enable seamless cubemap sampling for lower mip levels in the pre-filter map.
-    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    GLState::enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	// Map the HDR equirectangular environment map to a cubemap
     glm::mat4 captureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
@@ -313,14 +314,14 @@ int main()
     glGenFramebuffers(1, &captureFBO);
     glGenRenderbuffers(1, &captureRBO);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, cubemapSize, cubemapSize);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
 
     unsigned int envCubemap;
     glGenTextures(1, &envCubemap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
     for (unsigned int i = 0; i < 6; ++i)
     {
         // note that we store each face with 16 bit floating point values
@@ -336,11 +337,11 @@ int main()
     equirectangularToCubemapShader.use();
     equirectangularToCubemapShader.setInt("equirectangularMap", 0);
     equirectangularToCubemapShader.setMat4("projection", value_ptr(captureProjection));
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, hdrTexture);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, hdrTexture);
 
-    glViewport(0, 0, cubemapSize, cubemapSize); // don't forget to configure the viewport to the capture dimensions.
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    GLState::viewport(0, 0, cubemapSize, cubemapSize); // don't forget to configure the viewport to the capture dimensions.
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     for (unsigned int i = 0; i < 6; ++i)
     {
         equirectangularToCubemapShader.setMat4("view", value_ptr(captureViews[i]));
@@ -349,12 +350,12 @@ int main()
 
         renderCube(); // renders a 1x1 cube
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
 
     unsigned int irradianceMap;
     glGenTextures(1, &irradianceMap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
     for (unsigned int i = 0; i < 6; ++i)
     {
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 32, 32, 0, GL_RGB, GL_FLOAT, nullptr);
@@ -365,7 +366,7 @@ int main()
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
 
@@ -373,11 +374,11 @@ int main()
     irradianceShader.use();
     irradianceShader.setInt("environmentMap", 0);
     irradianceShader.setMat4("projection", value_ptr(captureProjection));
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
-    glViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    GLState::viewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     for (unsigned int i = 0; i < 6; ++i)
     {
         irradianceShader.setMat4("view", value_ptr(captureViews[i]));
@@ -386,12 +387,12 @@ int main()
 
         renderCube();
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
 
     unsigned int prefilterMap;
     glGenTextures(1, &prefilterMap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
     for (unsigned int i = 0; i < 6; ++i)
     {
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 128, 128, 0, GL_RGB, GL_FLOAT, nullptr);
@@ -409,10 +410,10 @@ int main()
     prefilterShader.use();
     prefilterShader.setInt("environmentMap", 0);
     prefilterShader.setMat4("projection", value_ptr(captureProjection));
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     unsigned int maxMipLevels = 5;
     for (unsigned int mip = 0; mip < maxMipLevels; ++mip)
     {
@@ -421,7 +422,7 @@ int main()
         unsigned int mipHeight = static_cast<unsigned int>(128 * std::pow(0.5, mip));
         glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
-        glViewport(0, 0, mipWidth, mipHeight);
+        GLState::viewport(0, 0, mipWidth, mipHeight);
 
         float roughness = (float)mip / (float)(maxMipLevels - 1);
         prefilterShader.setFloat("roughness", roughness);
@@ -434,7 +435,7 @@ int main()
             renderCube();
         }
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // pbr: generate a 2D LUT from the BRDF equations used.
     // ----------------------------------------------------
@@ -442,7 +443,7 @@ int main()
     glGenTextures(1, &brdfLUTTexture);
 
     // pre-allocate enough memory for the LUT texture.
-    glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+    GLState::bindTexture(GL_TEXTURE_2D, brdfLUTTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, 512, 512, 0, GL_RG, GL_FLOAT, 0);
     // be sure to set wrapping mode to GL_CLAMP_TO_EDGE
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -451,17 +452,17 @@ int main()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     // then re-configure capture framebuffer object and render screen-space quad with BRDF shader.
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUTTexture, 0);
 
-    glViewport(0, 0, 512, 512);
+    GLState::viewport(0, 0, 512, 512);
     brdfShader.use();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     renderQuad();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
 
     // Render Loop
@@ -473,7 +474,7 @@ int main()
 
 
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+	GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
     while (!glfwWindowShouldClose(window))
     {
         frameCount++;
@@ -488,19 +489,19 @@ int main()
         processInput(window);
 
         // rendering commands
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(0.0f, 0.5f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glEnable(GL_MULTISAMPLE);
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_MULTISAMPLE);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
         // matrixes
 		glm::mat4 model = glm::mat4(1.0f);
@@ -523,12 +524,12 @@ int main()
 		pbrShader.setVec3("camPos", viewPos);
 		pbrShader.setMat4("model", value_ptr(model));
 
-        glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+        GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+		GLState::activeTexture(GL_TEXTURE1);
+		GLState::bindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+		GLState::activeTexture(GL_TEXTURE2);
+		GLState::bindTexture(GL_TEXTURE_2D, brdfLUTTexture);
 
 		pbrShader.setInt("irradianceMap", 0);
 		pbrShader.setInt("prefilterMap", 1);
@@ -592,24 +593,24 @@ int main()
         pbrTextureShader.setVec2("texScale", glm::vec2(1.0f, 1.0f));
 
         // bind pre-computed IBL data
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+        GLState::activeTexture(GL_TEXTURE2);
+        GLState::bindTexture(GL_TEXTURE_2D, brdfLUTTexture);
 
         // rusted iron
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, rustedIronAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, rustedIronNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, rustedIronMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, rustedIronRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, rustedIronAOMap);
+        GLState::activeTexture(GL_TEXTURE3);
+        GLState::bindTexture(GL_TEXTURE_2D, rustedIronAlbedoMap);
+        GLState::activeTexture(GL_TEXTURE4);
+        GLState::bindTexture(GL_TEXTURE_2D, rustedIronNormalMap);
+        GLState::activeTexture(GL_TEXTURE5);
+        GLState::bindTexture(GL_TEXTURE_2D, rustedIronMetallicMap);
+        GLState::activeTexture(GL_TEXTURE6);
+        GLState::bindTexture(GL_TEXTURE_2D, rustedIronRoughnessMap);
+        GLState::activeTexture(GL_TEXTURE7);
+        GLState::bindTexture(GL_TEXTURE_2D, rustedIronAOMap);
 
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-10.0, 0.0, 13.0));
@@ -618,16 +619,16 @@ int main()
         renderSphere();
 
         // gold
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, goldAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, goldNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, goldMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, goldRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, goldAOMap);
+        GLState::activeTexture(GL_TEXTURE3);
+        GLState::bindTexture(GL_TEXTURE_2D, goldAlbedoMap);
+        GLState::activeTexture(GL_TEXTURE4);
+        GLState::bindTexture(GL_TEXTURE_2D, goldNormalMap);
+        GLState::activeTexture(GL_TEXTURE5);
+        GLState::bindTexture(GL_TEXTURE_2D, goldMetallicMap);
+        GLState::activeTexture(GL_TEXTURE6);
+        GLState::bindTexture(GL_TEXTURE_2D, goldRoughnessMap);
+        GLState::activeTexture(GL_TEXTURE7);
+        GLState::bindTexture(GL_TEXTURE_2D, goldAOMap);
 
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-10.0, 0.0, 10.0));
@@ -636,16 +637,16 @@ int main()
         renderSphere();
 
         // grass
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, grassAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, grassNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, grassMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, grassRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, grassAOMap);
+        GLState::activeTexture(GL_TEXTURE3);
+        GLState::bindTexture(GL_TEXTURE_2D, grassAlbedoMap);
+        GLState::activeTexture(GL_TEXTURE4);
+        GLState::bindTexture(GL_TEXTURE_2D, grassNormalMap);
+        GLState::activeTexture(GL_TEXTURE5);
+        GLState::bindTexture(GL_TEXTURE_2D, grassMetallicMap);
+        GLState::activeTexture(GL_TEXTURE6);
+        GLState::bindTexture(GL_TEXTURE_2D, grassRoughnessMap);
+        GLState::activeTexture(GL_TEXTURE7);
+        GLState::bindTexture(GL_TEXTURE_2D, grassAOMap);
 
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-10.0, 0.0, 7.0));
@@ -654,16 +655,16 @@ int main()
         renderSphere();
 
         // plastic
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, plasticAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, plasticNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, plasticMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, plasticRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, plasticAOMap);
+        GLState::activeTexture(GL_TEXTURE3);
+        GLState::bindTexture(GL_TEXTURE_2D, plasticAlbedoMap);
+        GLState::activeTexture(GL_TEXTURE4);
+        GLState::bindTexture(GL_TEXTURE_2D, plasticNormalMap);
+        GLState::activeTexture(GL_TEXTURE5);
+        GLState::bindTexture(GL_TEXTURE_2D, plasticMetallicMap);
+        GLState::activeTexture(GL_TEXTURE6);
+        GLState::bindTexture(GL_TEXTURE_2D, plasticRoughnessMap);
+        GLState::activeTexture(GL_TEXTURE7);
+        GLState::bindTexture(GL_TEXTURE_2D, plasticAOMap);
 
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-10.0, 0.0, 4.0));
@@ -672,16 +673,16 @@ int main()
         renderSphere();
 
         // wall
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, wallAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, wallNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, wallMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, wallRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, wallAOMap);
+        GLState::activeTexture(GL_TEXTURE3);
+        GLState::bindTexture(GL_TEXTURE_2D, wallAlbedoMap);
+        GLState::activeTexture(GL_TEXTURE4);
+        GLState::bindTexture(GL_TEXTURE_2D, wallNormalMap);
+        GLState::activeTexture(GL_TEXTURE5);
+        GLState::bindTexture(GL_TEXTURE_2D, wallMetallicMap);
+        GLState::activeTexture(GL_TEXTURE6);
+        GLState::bindTexture(GL_TEXTURE_2D, wallRoughnessMap);
+        GLState::activeTexture(GL_TEXTURE7);
+        GLState::bindTexture(GL_TEXTURE_2D, wallAOMap);
 
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(-10.0, 0.0, 1.0));
@@ -709,19 +710,19 @@ int main()
 
 
         // Skybox
-        glDepthFunc(GL_LEQUAL);
-		glCullFace(GL_FRONT);
+        GLState::depthFunc(GL_LEQUAL);
+		GLState::cullFace(GL_FRONT);
 
 		skyboxShader.use();
 		skyboxShader.setMat4("view", value_ptr(view));
 		skyboxShader.setMat4("projection", value_ptr(projection));
 		skyboxShader.setInt("skybox", 0);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 		renderCube();
 
-		glCullFace(GL_BACK);
-		glDepthFunc(GL_LESS);
+		GLState::cullFace(GL_BACK);
+		GLState::depthFunc(GL_LESS);
 
         // check and call events and swap the buffers
         glfwSwapBuffers(window);
@@ -780,7 +781,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -936,7 +937,7 @@ void renderQuad()
         // configure plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        GLState::bindVertexArray(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -950,9 +951,9 @@ void renderQuad()
         glEnableVertexAttribArray(4);
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GLState::bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 unsigned int cubeVAO = 0;
@@ -1012,7 +1013,7 @@ void renderCube()
         glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
         // link vertex attributes
-        glBindVertexArray(cubeVAO);
+        GLState::bindVertexArray(cubeVAO);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
@@ -1020,12 +1021,12 @@ void renderCube()
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        GLState::bindVertexArray(0);
     }
     // render Cube
-    glBindVertexArray(cubeVAO);
+    GLState::bindVertexArray(cubeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 
@@ -1108,7 +1109,7 @@ void renderSphere()
                 data.push_back(uv[i].y);
             }
         }
-        glBindVertexArray(sphereVAO);
+        GLState::bindVertexArray(sphereVAO);
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
         glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
@@ -1122,7 +1123,7 @@ void renderSphere()
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
     }
 
-    glBindVertexArray(sphereVAO);
+    GLState::bindVertexArray(sphereVAO);
     glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
 }
 
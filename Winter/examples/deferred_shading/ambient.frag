@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gAlbedoSpec;
+
+// Ambient term of the lighting pass, the light volumes are added on top of it
+void main()
+{
+    vec3 Albedo = texture(gAlbedoSpec, TexCoords).rgb;
+    FragColor = vec4(Albedo * 0.1, 1.0); // hard-coded ambient component
+}
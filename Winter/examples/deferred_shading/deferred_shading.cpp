@@ -1,9 +1,16 @@
 ﻿// Advanced Lighting : Deferred Shading
 // https://learnopengl.com/Advanced-Lighting/Deferred-Shading
+// The lighting is drawn to an HDR target in one of two ways:
+// - full screen: the lights are culled per view space cluster by LightClusters, each pixel only shades with the lights of its cluster
+// - light volumes: the bounding sphere of each light is drawn, the stencil limits its shading to the surfaces inside of it
+// Options: --lights <count>, --lighting full-screen|volumes, --benchmark (GPU time of both ways as the light count grows)
 #include <array>
 #include <algorithm>
+#include <cctype>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <numeric>
@@ -20,8 +27,11 @@
 
 #include "camera.h"
 #include "fpsCounter.h"
+#include "glState.h"
+#include "lightClusters.h"
 #include "model.h"
 #include "pathManager.h"
+#include "profiler.h"
 #include "shader.h"
 #include "texture.h"
 
@@ -59,6 +69,15 @@ glm::vec3 lightColors[] = {
 	glm::vec3(1.0f, 1.0f, 1.0f)
 };
 
+enum class LightingMode { FULL_SCREEN, LIGHT_VOLUMES };
+
+// Benchmark: each light count is drawn with both lighting modes
+const unsigned int BENCHMARK_LIGHT_COUNTS[] = { 128, 512, 2048, 8192 };
+const unsigned int BENCHMARK_WARMUP_FRAMES = 30;
+const unsigned int BENCHMARK_FRAMES = 120;
+
+const char* const USAGE = "Usage: deferred_shading [--lights <count>] [--lighting full-screen|volumes] [--benchmark]";
+
 // MISC
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos);
@@ -67,10 +86,14 @@ void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
 
 Mesh createQuad();
+// Random lights like the original 128 of the scene, spread over a volume growing with their count to keep the same density
+std::vector<PointLight> createLights(unsigned int count, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& colors);
+// Sphere of radius 1 whose faces contain the unit sphere, drawn as GL_TRIANGLES
+void createLightVolume(unsigned int& VAO, unsigned int& VBO, unsigned int& EBO, unsigned int& indexCount);
 void setShaderLights(Shader& shader);
 void renderQuad();
 
-int main()
+int main(int argc, char* argv[])
 {
     // Init Path
     PathManager::projectPath = std::filesystem::current_path().string() + "/";
@@ -81,6 +104,34 @@ int main()
     const int32_t WINDOW_HEIGHT = 600;
     const std::string WINDOW_TITLE = "LearnOpenGL";
 
+    unsigned int lightCount = 128;
+    LightingMode lightingMode = LightingMode::FULL_SCREEN;
+    bool isBenchmark = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--lights" && i + 1 < argc)
+        {
+            const std::string count = argv[++i];
+            // digits only, and few enough of them for std::stoul not to throw
+            if (count.empty() || count.size() > 9 || !std::all_of(count.begin(), count.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; }))
+            {
+                std::cout << "Invalid light count: " << count << std::endl;
+                std::cout << USAGE << std::endl;
+                return -1;
+            }
+            lightCount = static_cast<unsigned int>(std::stoul(count));
+        }
+        else if (argument == "--lighting" && i + 1 < argc)
+        {
+            lightingMode = std::string(argv[++i]) == "volumes" ? LightingMode::LIGHT_VOLUMES : LightingMode::FULL_SCREEN;
+        }
+        else if (argument == "--benchmark")
+        {
+            isBenchmark = true;
+        }
+    }
+
 	const std::string PATH_EXAMPLE = PathManager::getProjectPath() + "examples/deferred_shading/";
 
 	const std::string PATH_VERTEX_SHADER = PATH_EXAMPLE + "basic.vert";
@@ -91,6 +142,11 @@ int main()
 	const std::string PATH_G_BUFFER_FRAGMENT_SHADER = PATH_EXAMPLE + "gBuffer.frag";
 	const std::string PATH_LIGHTING_PASS_VERTEX_SHADER = PATH_EXAMPLE + "lightingPass.vert";
 	const std::string PATH_LIGHTING_PASS_FRAGMENT_SHADER = PATH_EXAMPLE + "lightingPass.frag";
+	const std::string PATH_AMBIENT_FRAGMENT_SHADER = PATH_EXAMPLE + "ambient.frag";
+	const std::string PATH_LIGHT_VOLUME_VERTEX_SHADER = PATH_EXAMPLE + "lightVolume.vert";
+	const std::string PATH_LIGHT_VOLUME_FRAGMENT_SHADER = PATH_EXAMPLE + "lightVolume.frag";
+	const std::string PATH_EMPTY_FRAGMENT_SHADER = PathManager::getShadersPath() + "empty.frag";
+	const std::string PATH_PRESENT_FRAGMENT_SHADER = PATH_EXAMPLE + "present.frag";
 
     const std::string PATH_TEXTURE_CONTAINER = PathManager::getTexturesPath() + "container.jpg";
     const std::string PATH_TEXTURE_SMILE = PathManager::getTexturesPath() + "awesomeface.png";
@@ -107,7 +163,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    // For easy MSAA Don't forget to call: glEnable(GL_MULTISAMPLE);
+    // For easy MSAA Don't forget to call: GLState::enable(GL_MULTISAMPLE);
 	// ------------------------------------
 	glfwWindowHint(GLFW_SAMPLES, 4);
 	// ------------------------------------
@@ -136,7 +192,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -160,6 +216,10 @@ int main()
     Shader lightCubeShader(PATH_LIGHT_VERTEX_SHADER, PATH_LIGHT_FRAGMENT_SHADER);
 	Shader gBufferShader(PATH_G_BUFFER_VERTEX_SHADER, PATH_G_BUFFER_FRAGMENT_SHADER);
 	Shader lightingPassShader(PATH_LIGHTING_PASS_VERTEX_SHADER, PATH_LIGHTING_PASS_FRAGMENT_SHADER);
+	Shader ambientShader(PATH_LIGHTING_PASS_VERTEX_SHADER, PATH_AMBIENT_FRAGMENT_SHADER);
+	Shader lightVolumeShader(PATH_LIGHT_VOLUME_VERTEX_SHADER, PATH_LIGHT_VOLUME_FRAGMENT_SHADER);
+	Shader lightStencilShader(PATH_LIGHT_VOLUME_VERTEX_SHADER, PATH_EMPTY_FRAGMENT_SHADER);
+	Shader presentShader(PATH_LIGHTING_PASS_VERTEX_SHADER, PATH_PRESENT_FRAGMENT_SHADER);
 
     // TEXTURES
 	// ------------------------------------
@@ -178,14 +238,14 @@ int main()
 	// ------------------------------------
     unsigned int gBuffer;
     glGenFramebuffers(1, &gBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, gBuffer);
     unsigned int gPosition;
     unsigned int gNormal;
     unsigned int gAlbedoSpec;
 
     // - position color buffer
     glGenTextures(1, &gPosition);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
+    GLState::bindTexture(GL_TEXTURE_2D, gPosition);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -193,7 +253,7 @@ int main()
 
     // - normal color buffer
     glGenTextures(1, &gNormal);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
+    GLState::bindTexture(GL_TEXTURE_2D, gNormal);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -201,7 +261,7 @@ int main()
 
     // - color + specular color buffer
     glGenTextures(1, &gAlbedoSpec);
-    glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+    GLState::bindTexture(GL_TEXTURE_2D, gAlbedoSpec);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -211,19 +271,36 @@ int main()
     unsigned int colorAttachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
     glDrawBuffers(3, colorAttachments);
 
-	// - create and attach depth buffer (renderbuffer)
+	// - create and attach depth buffer (renderbuffer), with the stencil of the light volumes
 	unsigned int rboDepth;
 	glGenRenderbuffers(1, &rboDepth);
 	glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, WINDOW_WIDTH, WINDOW_HEIGHT);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, WINDOW_WIDTH, WINDOW_HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
 
 	// - finally check if framebuffer is complete
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
     {
 		std::cout << "Framebuffer not complete!" << std::endl;
     }
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // HDR target of the lighting and forward passes, sharing the depth and stencil of the G-buffer
+    unsigned int hdrFBO;
+    glGenFramebuffers(1, &hdrFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+    unsigned int hdrColor;
+    glGenTextures(1, &hdrColor);
+    GLState::bindTexture(GL_TEXTURE_2D, hdrColor);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hdrColor, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+		std::cout << "HDR framebuffer not complete!" << std::endl;
+    }
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Uniform Buffers
 	// ------------------------------------
@@ -246,22 +323,28 @@ int main()
 	// ------------------------------------
 	setShaderLights(shader);
 
-    const unsigned int NR_LIGHTS = 128;
     std::vector<glm::vec3> lightPositions;
     std::vector<glm::vec3> lightColors;
-    srand(13);
-    for (unsigned int i = 0; i < NR_LIGHTS; i++)
+    LightClusters lightClusters;
+    if (!isBenchmark)
     {
-        // calculate slightly random offsets
-        float xPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
-        float yPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 4.0);
-        float zPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
-        lightPositions.push_back(glm::vec3(xPos, yPos, zPos));
-        // also calculate random color
-        float rColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
-        float gColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
-        float bColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
-        lightColors.push_back(glm::vec3(rColor, gColor, bColor));
+        lightClusters.setLights(createLights(lightCount, lightPositions, lightColors));
+        std::cout << lightCount << " lights, " << (lightingMode == LightingMode::FULL_SCREEN ? "full screen" : "light volume") << " lighting" << std::endl;
+    }
+
+    unsigned int lightVolumeVAO;
+    unsigned int lightVolumeVBO;
+    unsigned int lightVolumeEBO;
+    unsigned int lightVolumeIndexCount;
+    createLightVolume(lightVolumeVAO, lightVolumeVBO, lightVolumeEBO, lightVolumeIndexCount);
+
+    // Benchmark state: step i draws BENCHMARK_LIGHT_COUNTS[i / 2] lights with the lighting mode i % 2
+    const unsigned int benchmarkSteps = isBenchmark ? 2 * static_cast<unsigned int>(std::size(BENCHMARK_LIGHT_COUNTS)) : 0;
+    PassBenchmark benchmark({ "Light culling", "Lighting" }, BENCHMARK_WARMUP_FRAMES, BENCHMARK_FRAMES);
+    if (isBenchmark)
+    {
+        std::cout << "Lighting benchmark, GPU ms per frame over " << BENCHMARK_FRAMES << " frames, " << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << std::endl;
+        std::cout << std::left << std::setw(10) << "Lights" << std::setw(16) << "Mode" << std::right << std::setw(12) << "Culling" << std::setw(12) << "Lighting" << std::setw(12) << "Total" << std::endl;
     }
 
 
@@ -296,27 +379,53 @@ int main()
 		const float curFrameTime = static_cast<float>(glfwGetTime());
 		deltaTime = curFrameTime - lastFrameTime;
 		fpsCounter.update(curFrameTime);
-		if (frameCount % 60 == 0)
+		if (frameCount % 60 == 0 && !isBenchmark)
 		{
 			fpsCounter.showFPS();
+			Profiler::showStats();
 		}
+        if (isBenchmark)
+        {
+            const PassBenchmark::Event event = benchmark.nextFrame();
+            if (event == PassBenchmark::Event::STEP_STARTED)
+            {
+                const unsigned int benchmarkStep = benchmark.getStep();
+                lightCount = BENCHMARK_LIGHT_COUNTS[benchmarkStep / 2];
+                lightingMode = benchmarkStep % 2 == 0 ? LightingMode::FULL_SCREEN : LightingMode::LIGHT_VOLUMES;
+                lightClusters.setLights(createLights(lightCount, lightPositions, lightColors));
+            }
+            else if (event == PassBenchmark::Event::STEP_ENDED)
+            {
+                const double cullingMs = benchmark.getGPUMs(0);
+                const double lightingMs = benchmark.getGPUMs(1);
+                const bool isFullScreen = lightingMode == LightingMode::FULL_SCREEN;
+                std::cout << std::left << std::setw(10) << lightCount << std::setw(16) << (isFullScreen ? "full screen" : "light volumes") << std::right
+                    << std::fixed << std::setprecision(3) << std::setw(12) << (isFullScreen ? cullingMs : 0.0) << std::setw(12) << lightingMs
+                    << std::setw(12) << (isFullScreen ? cullingMs : 0.0) + lightingMs << std::defaultfloat << std::endl;
+                if (benchmark.getStep() == benchmarkSteps)
+                {
+                    glfwSetWindowShouldClose(window, true);
+                }
+                continue;
+            }
+        }
         // input
         processInput(window);
 
         // rendering commands
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glEnable(GL_MULTISAMPLE);
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_MULTISAMPLE);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
         // matrixes
 		glm::mat4 model = glm::mat4(1.0f);
@@ -329,6 +438,13 @@ int main()
 		glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(view));
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+        if (lightingMode == LightingMode::FULL_SCREEN)
+        {
+            Profiler::beginScope("Light culling");
+            lightClusters.update(view, projection, cameraNearPlane, cameraFarPlane, WINDOW_WIDTH, WINDOW_HEIGHT);
+            Profiler::endScope();
+        }
+
         // Draw scene
 		// ------------------------------------
 		// Use shader program
@@ -342,10 +458,11 @@ int main()
         shader.setFloat("material.shininess", shininessMat);
 
 		// Render to GBuffer
-        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        Profiler::beginScope("Geometry");
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // black as to not leak into gBuffer
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
         gBufferShader.use();
         gBufferShader.setVec3("viewPos", viewPos);
@@ -393,64 +510,110 @@ int main()
         gBufferShader.setFloat("material.shininess", 128.0f);
         //woodQuad.draw(shader);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        
-        lightingPassShader.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
-		lightingPassShader.setInt("gPosition", 0);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
-		lightingPassShader.setInt("gNormal", 1);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-		lightingPassShader.setInt("gAlbedoSpec", 2);
-        // also send light relevant uniforms
-		// Set shader lights
-        for (unsigned int i = 0; i < NR_LIGHTS; i++)
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+        Profiler::endScope();
+
+        Profiler::beginScope("Lighting");
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+        glClear(GL_COLOR_BUFFER_BIT);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, gPosition);
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, gNormal);
+        GLState::activeTexture(GL_TEXTURE2);
+        GLState::bindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+        if (lightingMode == LightingMode::FULL_SCREEN)
         {
-			lightingPassShader.setVec3("lights[" + std::to_string(i) + "].Position", lightPositions[i]);
-			lightingPassShader.setVec3("lights[" + std::to_string(i) + "].Color", lightColors[i]);
-			const float constant = 1.0f;
-			const float linear = 0.7f;
-			const float quadratic = 1.8f;
-			lightingPassShader.setFloat("lights[" + std::to_string(i) + "].Constant", constant);
-			lightingPassShader.setFloat("lights[" + std::to_string(i) + "].Linear", linear);
-			lightingPassShader.setFloat("lights[" + std::to_string(i) + "].Quadratic", quadratic);
+            lightingPassShader.use();
+            lightingPassShader.setInt("gPosition", 0);
+            lightingPassShader.setInt("gNormal", 1);
+            lightingPassShader.setInt("gAlbedoSpec", 2);
+            // the lights come from the buffers bound by lightClusters.update
+            lightingPassShader.setVec3("viewPos", viewPos);
+            quad.draw(lightingPassShader);
         }
-
-        lightingPassShader.setVec3("viewPos", viewPos);
-        quad.draw(lightingPassShader);
-
-
-        // First copy depth buffer
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
-		// Blitting to a buffer with GL_FRAMEBUFFER_SRGB enabled will mess up the depth values, so we disable it
-		glDisable(GL_FRAMEBUFFER_SRGB);
-		glBlitFramebuffer(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-		glEnable(GL_FRAMEBUFFER_SRGB);
+        else
+        {
+            ambientShader.use();
+            ambientShader.setInt("gAlbedoSpec", 2);
+            quad.draw(ambientShader);
+
+            lightVolumeShader.use();
+            lightVolumeShader.setInt("gPosition", 0);
+            lightVolumeShader.setInt("gNormal", 1);
+            lightVolumeShader.setInt("gAlbedoSpec", 2);
+            lightVolumeShader.setVec2("screenSize", glm::vec2(WINDOW_WIDTH, WINDOW_HEIGHT));
+            lightVolumeShader.setVec3("viewPos", viewPos);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightClusters.getLightBuffer());
+            GLState::bindVertexArray(lightVolumeVAO);
+            GLState::enable(GL_STENCIL_TEST);
+            GLState::depthMask(GL_FALSE);
+            GLState::blendFunc(GL_ONE, GL_ONE);
+            for (unsigned int i = 0; i < lightCount; i++)
+            {
+                // stencil: the back faces behind the surface increment it and the front faces behind it decrement it,
+                // the pixels whose surface is inside of the volume are left at 1, the others at 0
+                lightStencilShader.use();
+                glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                GLState::enable(GL_DEPTH_TEST);
+                GLState::disable(GL_CULL_FACE);
+                GLState::disable(GL_BLEND);
+                glStencilFunc(GL_ALWAYS, 0, 0);
+                glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+                glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+                glDrawElementsInstancedBaseInstance(GL_TRIANGLES, lightVolumeIndexCount, GL_UNSIGNED_INT, nullptr, 1, i);
+
+                // shading: the back faces are drawn even with the camera inside of the volume, each marked pixel is reset to 0 for the next light
+                glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                lightVolumeShader.use();
+                GLState::disable(GL_DEPTH_TEST);
+                GLState::enable(GL_CULL_FACE);
+                GLState::cullFace(GL_FRONT);
+                GLState::enable(GL_BLEND);
+                glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+                glStencilOp(GL_KEEP, GL_KEEP, GL_ZERO);
+                glDrawElementsInstancedBaseInstance(GL_TRIANGLES, lightVolumeIndexCount, GL_UNSIGNED_INT, nullptr, 1, i);
+            }
+            GLState::disable(GL_STENCIL_TEST);
+            GLState::disable(GL_BLEND);
+            GLState::cullFace(GL_BACK);
+            GLState::depthMask(GL_TRUE);
+            GLState::bindVertexArray(0);
+        }
+        GLState::enable(GL_DEPTH_TEST);
+        Profiler::endScope();
 
         // now render all light cubes with forward rendering as we'd normally do
         // And rendering bleding objects must be done in the forward rendering
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-        
-        lightCubeShader.use();
-        for (unsigned int i = 0; i < lightPositions.size(); i++)
+        // The HDR target already holds the depth of the G-buffer
+        Profiler::beginScope("Forward");
+        if (!isBenchmark)
         {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, lightPositions[i]);
-            model = glm::scale(model, glm::vec3(0.25f));
-            lightCubeShader.setMat4("model", value_ptr(model));
-            lightCubeShader.setVec3("color", lightColors[i]);
-            cube.draw(lightCubeShader);
+            lightCubeShader.use();
+            for (unsigned int i = 0; i < lightPositions.size(); i++)
+            {
+                model = glm::mat4(1.0f);
+                model = glm::translate(model, lightPositions[i]);
+                model = glm::scale(model, glm::vec3(0.25f));
+                lightCubeShader.setMat4("model", value_ptr(model));
+                lightCubeShader.setVec3("color", lightColors[i]);
+                cube.draw(lightCubeShader);
+            }
         }
+        Profiler::endScope();
+
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::disable(GL_DEPTH_TEST);
+        presentShader.use();
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, hdrColor);
+        presentShader.setInt("hdrBuffer", 0);
+        quad.draw(presentShader);
 
         // check and call events and swap the buffers
         glfwSwapBuffers(window);
+        Profiler::nextFrame();
         glfwPollEvents();
 
         lastFrameTime = curFrameTime;
@@ -458,11 +621,17 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteTextures(1, &containerTexture);
-    glDeleteTextures(1, &container2Texture);
-    glDeleteTextures(1, &container2Specular);
-	glDeleteTextures(1, &woodTexture);
-	glDeleteTextures(1, &woodTextureSpec);
+    GLState::deleteTextures(1, &containerTexture);
+    GLState::deleteTextures(1, &container2Texture);
+    GLState::deleteTextures(1, &container2Specular);
+	GLState::deleteTextures(1, &woodTexture);
+	GLState::deleteTextures(1, &woodTextureSpec);
+    GLState::deleteTextures(1, &hdrColor);
+    GLState::deleteFramebuffers(1, &hdrFBO);
+    GLState::deleteVertexArrays(1, &lightVolumeVAO);
+    glDeleteBuffers(1, &lightVolumeVBO);
+    glDeleteBuffers(1, &lightVolumeEBO);
+    Profiler::release();
 
     glfwTerminate();
 
@@ -511,7 +680,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -595,6 +764,81 @@ Mesh createQuad()
     return Mesh(verts, indices, std::vector<Texture>());
 }
 
+std::vector<PointLight> createLights(unsigned int count, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& colors)
+{
+    const unsigned int ORIGINAL_LIGHT_COUNT = 128;
+    const glm::vec3 attenuation(1.0f, 0.7f, 1.8f); // constant, linear, quadratic
+    const float spread = std::cbrt(static_cast<float>(count) / ORIGINAL_LIGHT_COUNT);
+    positions.clear();
+    colors.clear();
+    std::vector<PointLight> lights;
+    lights.reserve(count);
+    srand(13);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        // calculate slightly random offsets
+        float xPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0) * spread;
+        float yPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 4.0) * spread;
+        float zPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0) * spread;
+        positions.push_back(glm::vec3(xPos, yPos, zPos));
+        // also calculate random color
+        float rColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        float gColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        float bColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        colors.push_back(glm::vec3(rColor, gColor, bColor));
+        const float radius = LightClusters::getLightRadius(colors.back(), attenuation);
+        lights.push_back({ glm::vec4(positions.back(), radius), glm::vec4(colors.back(), 1.0f), glm::vec4(attenuation, 0.0f) });
+    }
+    return lights;
+}
+
+void createLightVolume(unsigned int& VAO, unsigned int& VBO, unsigned int& EBO, unsigned int& indexCount)
+{
+    const unsigned int X_SEGMENTS = 16;
+    const unsigned int Y_SEGMENTS = 12;
+    const float PI = 3.14159265359f;
+    // the vertices are pushed out so that the flat faces between them stay outside of the unit sphere
+    const float scale = 1.0f / (std::cos(PI / X_SEGMENTS) * std::cos(PI / (2 * Y_SEGMENTS)));
+
+    std::vector<glm::vec3> positions;
+    for (unsigned int y = 0; y <= Y_SEGMENTS; ++y)
+    {
+        for (unsigned int x = 0; x <= X_SEGMENTS; ++x)
+        {
+            const float xSegment = static_cast<float>(x) / X_SEGMENTS;
+            const float ySegment = static_cast<float>(y) / Y_SEGMENTS;
+            positions.push_back(scale * glm::vec3(std::cos(xSegment * 2.0f * PI) * std::sin(ySegment * PI),
+                std::cos(ySegment * PI),
+                std::sin(xSegment * 2.0f * PI) * std::sin(ySegment * PI)));
+        }
+    }
+    // counter-clockwise seen from outside
+    std::vector<unsigned int> indices;
+    for (unsigned int y = 0; y < Y_SEGMENTS; ++y)
+    {
+        for (unsigned int x = 0; x < X_SEGMENTS; ++x)
+        {
+            const unsigned int topLeft = y * (X_SEGMENTS + 1) + x;
+            const unsigned int bottomLeft = topLeft + X_SEGMENTS + 1;
+            indices.insert(indices.end(), { topLeft, topLeft + 1, bottomLeft });
+            indices.insert(indices.end(), { topLeft + 1, bottomLeft + 1, bottomLeft });
+        }
+    }
+    indexCount = static_cast<unsigned int>(indices.size());
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    GLState::bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    GLState::bindVertexArray(0);
+}
+
 
 unsigned int quadVAO = 0;
 unsigned int quadVBO;
@@ -667,7 +911,7 @@ void renderQuad()
         // configure plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        GLState::bindVertexArray(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -681,7 +925,7 @@ void renderQuad()
         glEnableVertexAttribArray(4);
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GLState::bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
\ No newline at end of file
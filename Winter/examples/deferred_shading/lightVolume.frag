@@ -0,0 +1,57 @@
+#version 460 core
+out vec4 FragColor;
+
+flat in uint LightIndex;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+uniform vec2 screenSize;
+uniform vec3 viewPos;
+
+struct PointLight
+{
+    vec4 positionRadius;
+    vec4 color;
+    vec4 attenuation; // constant, linear, quadratic
+};
+
+layout (std430, binding = 0) readonly buffer Lights
+{
+    PointLight lights[];
+};
+
+// smoothly reaches 0 at the radius of the light volume
+float getAttenuation(PointLight light, float distance)
+{
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
+    float ratio = distance / light.positionRadius.w;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return attenuation * window * window;
+}
+
+// Lighting of a single light, added to the target by blending
+void main()
+{
+    vec2 TexCoords = gl_FragCoord.xy / screenSize;
+    vec3 FragPos = texture(gPosition, TexCoords).rgb;
+    vec3 Normal = texture(gNormal, TexCoords).rgb;
+    vec3 Albedo = texture(gAlbedoSpec, TexCoords).rgb;
+    float Specular = texture(gAlbedoSpec, TexCoords).a;
+
+    PointLight light = lights[LightIndex];
+    vec3 lightPos = light.positionRadius.xyz;
+    vec3 viewDir = normalize(viewPos - FragPos);
+    // diffuse
+    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Albedo * light.color.rgb;
+    // specular
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
+    vec3 specular = light.color.rgb * spec * Specular;
+    // attenuation
+    float distance = length(lightPos - FragPos);
+    float attenuation = getAttenuation(light, distance);
+
+    FragColor = vec4((diffuse + specular) * attenuation, 1.0);
+}
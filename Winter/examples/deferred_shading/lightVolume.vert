@@ -0,0 +1,30 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+
+// one instance per light, drawn with the light's index as base instance
+layout (std140, binding = 0) uniform Matrices
+{
+	uniform mat4 projection;
+	uniform mat4 view;
+};
+
+struct PointLight
+{
+    vec4 positionRadius;
+    vec4 color;
+    vec4 attenuation; // constant, linear, quadratic
+};
+
+layout (std430, binding = 0) readonly buffer Lights
+{
+    PointLight lights[];
+};
+
+flat out uint LightIndex;
+
+void main()
+{
+    LightIndex = gl_BaseInstance + gl_InstanceID;
+    vec4 positionRadius = lights[LightIndex].positionRadius;
+    gl_Position = projection * view * vec4(positionRadius.xyz + aPos * positionRadius.w, 1.0);
+}
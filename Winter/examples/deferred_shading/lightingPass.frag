@@ -1,4 +1,4 @@
-#version 330 core
+#version 460 core
 out vec4 FragColor;
   
 in vec2 TexCoords;
@@ -7,18 +7,55 @@ uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
 
-struct Light {
-    vec3 Position;
-    vec3 Color;
+// clustered lights, see LightClusters
+layout (std140, binding = 1) uniform ClusterParams
+{
+    mat4 clusterView;
+    uvec4 clusterGrid; // x, y and z cluster counts, max lights per cluster
+    vec4 clusterDepth; // slice scale and bias, tile width and height in pixels
+};
+
+struct PointLight
+{
+    vec4 positionRadius;
+    vec4 color;
+    vec4 attenuation; // constant, linear, quadratic
+};
+
+layout (std430, binding = 0) readonly buffer Lights
+{
+    PointLight lights[];
+};
 
-    float Constant;
-    float Linear;
-    float Quadratic;
+layout (std430, binding = 1) readonly buffer LightGrid
+{
+    uvec2 lightGrid[];
 };
-const int NR_LIGHTS = 32;
-uniform Light lights[NR_LIGHTS];
+
+layout (std430, binding = 2) readonly buffer LightIndices
+{
+    uint lightIndices[];
+};
+
 uniform vec3 viewPos;
 
+uint getClusterIndex(vec2 fragCoord, vec3 worldPos)
+{
+    float viewDepth = max(-(clusterView * vec4(worldPos, 1.0)).z, 0.0001);
+    uint slice = uint(max(log(viewDepth) * clusterDepth.x - clusterDepth.y, 0.0));
+    uvec3 cluster = min(uvec3(uvec2(fragCoord / clusterDepth.zw), slice), clusterGrid.xyz - 1u);
+    return cluster.x + clusterGrid.x * (cluster.y + clusterGrid.y * cluster.z);
+}
+
+// smoothly reaches 0 at the radius the light was culled with
+float getAttenuation(PointLight light, float distance)
+{
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
+    float ratio = distance / light.positionRadius.w;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return attenuation * window * window;
+}
+
 void main()
 {             
     // retrieve data from G-buffer
@@ -30,21 +67,24 @@ void main()
     // then calculate lighting as usual
     vec3 lighting = Albedo * 0.1; // hard-coded ambient component
     vec3 viewDir = normalize(viewPos - FragPos);
-    for(int i = 0; i < NR_LIGHTS; ++i)
+    uvec2 cluster = lightGrid[getClusterIndex(gl_FragCoord.xy, FragPos)];
+    for(uint i = 0u; i < cluster.y; ++i)
     {
+        PointLight light = lights[lightIndices[cluster.x + i]];
+        vec3 lightPos = light.positionRadius.xyz;
         // diffuse
-        vec3 lightDir = normalize(lights[i].Position - FragPos);
-        vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Albedo * lights[i].Color;
+        vec3 lightDir = normalize(lightPos - FragPos);
+        vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Albedo * light.color.rgb;
         // specular
         vec3 halfwayDir = normalize(lightDir + viewDir);
         float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
-        vec3 specular = lights[i].Color * spec * Specular;
+        vec3 specular = light.color.rgb * spec * Specular;
         // attenuation
-        float distance = length(lights[i].Position - FragPos);
-        float attenuation = 1.0 / (lights[i].Constant + lights[i].Linear * distance + lights[i].Quadratic * (distance * distance));
+        float distance = length(lightPos - FragPos);
+        float attenuation = getAttenuation(light, distance);
 
         lighting += (diffuse + specular) * attenuation;
     }
     
     FragColor = vec4(lighting, 1.0);
-}  
\ No newline at end of file
+}  
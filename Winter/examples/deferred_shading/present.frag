@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D hdrBuffer;
+
+// Copies the HDR target to the screen, the values past 1 are clamped as when the lighting was drawn to the screen directly
+void main()
+{
+    FragColor = vec4(texture(hdrBuffer, TexCoords).rgb, 1.0);
+}
@@ -19,6 +19,7 @@
 #include "stb_image.h"
 
 #include "camera.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -114,7 +115,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -157,7 +158,7 @@ int main()
     unsigned int VAOpoints, VBOpoints;
     glGenVertexArrays(1, &VAOpoints);
     glGenBuffers(1, &VBOpoints);
-	glBindVertexArray(VAOpoints);
+	GLState::bindVertexArray(VAOpoints);
 	glBindBuffer(GL_ARRAY_BUFFER, VBOpoints);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(points), points, GL_STATIC_DRAW);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*) 0);
@@ -165,7 +166,7 @@ int main()
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*) (2 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 
     // Uniform Buffers
 	// ------------------------------------
@@ -206,14 +207,14 @@ int main()
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         
         // matrixes
         glm::mat4 view = camera.getViewMatrix();
@@ -231,7 +232,7 @@ int main()
         bool drawHouse = true;
         if (drawHouse)
         {
-		    glBindVertexArray(VAOpoints);
+		    GLState::bindVertexArray(VAOpoints);
             pointsGeomShader.use();
 		    glDrawArrays(GL_POINTS, 0, 4);
         }
@@ -303,7 +304,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -1,13 +1,25 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <vector>
 #include "glm/glm.hpp"
 #include "glad/glad.h"
 
+// Uniform location resolved once with Shader::getUniformHandle, it can then be set without any lookup or allocation
+struct UniformHandle
+{
+    static const int UNUSED_LOCATION = -1;
+
+    int location = UNUSED_LOCATION;
+
+    bool isValid() const { return location != UNUSED_LOCATION; }
+};
+
 class Shader
 {
 private:
-    static unsigned int UNUSED_ID;
+    static constexpr unsigned int UNUSED_ID = 0;
 	static std::string getShaderTypeString(GLenum shaderType);
 public:
     // constructor reads and builds the shader
@@ -20,6 +32,8 @@ public:
     // use/activate the shader
     void use() const;
     unsigned int getID() const { return ID; }
+    // returns an invalid handle if the uniform is not active in the program
+    UniformHandle getUniformHandle(std::string_view name) const;
     // utility uniform functions
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
@@ -33,13 +47,37 @@ public:
     void setMat2(const std::string& name, const float* value) const;
     void setMat3(const std::string& name, const float* value) const;
     void setMat4(const std::string& name, const float* value) const;
+    void setBool(UniformHandle handle, bool value) const;
+    void setInt(UniformHandle handle, int value) const;
+    void setFloat(UniformHandle handle, float value) const;
+    void setVec2(UniformHandle handle, float v0, float v1) const;
+    void setVec2(UniformHandle handle, const glm::vec2& v) const;
+    void setVec3(UniformHandle handle, float v0, float v1, float v2) const;
+    void setVec3(UniformHandle handle, const glm::vec3& v) const;
+    void setVec4(UniformHandle handle, float v0, float v1, float v2, float v3) const;
+    void setVec4(UniformHandle handle, const glm::vec4& v) const;
+    void setMat2(UniformHandle handle, const float* value) const;
+    void setMat3(UniformHandle handle, const float* value) const;
+    void setMat4(UniformHandle handle, const float* value) const;
 
 private:
+    // Entry of the open addressing table of the uniform locations, an empty name marks an empty slot
+    struct UniformEntry
+    {
+        size_t hash = 0;
+        std::string name;
+        int location = UniformHandle::UNUSED_LOCATION;
+    };
+
     unsigned int ID;
     std::string vertexPath;
     std::string fragmentPath;
 	std::string geometryPath;
+    std::vector<UniformEntry> uniforms;
 
 	void generateShader(const std::string& vertexPath, const std::string& fragmentPath, const std::string& geometryPath = "");
 	unsigned int compileShaderSource(const std::string& shaderCode, GLenum shaderType);
+    // queries all the active uniforms of the linked program once
+    void cacheUniformLocations();
+    void insertUniform(const std::string& name, int location);
 };
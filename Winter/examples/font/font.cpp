@@ -19,11 +19,11 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 #include "stb_image.h"
-#include "ft2build.h"
-#include FT_FREETYPE_H
 
 #include "camera.h"
 #include "fpsCounter.h"
+#include "glState.h"
+#include "glyphCache.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -64,15 +64,8 @@ glm::vec3 lightColors[] = {
 };
 
 // Font
-struct Character {
-    unsigned int TextureID;  // ID handle of the glyph texture
-    glm::ivec2   Size;       // Size of glyph
-    glm::ivec2   Bearing;    // Offset from baseline to left/top of glyph
-    unsigned int Advance;    // Offset to advance to next glyph
-};
-
-std::map<char, Character> Characters;
 unsigned int fontVAO, fontVBO;
+std::vector<float> fontVertices;
 
 float pingpong(float x, float min, float max) {
 
@@ -93,7 +86,8 @@ void setShaderLights(Shader& shader);
 void renderQuad();
 void renderCube();
 void renderSphere();
-void renderText(Shader& s, const std::string& text, float x, float y, float scale, glm::vec3 color);
+float getTextWidth(GlyphCache& glyphs, const std::string& text);
+void renderText(Shader& s, GlyphCache& glyphs, const std::string& text, float x, float y, float scale, glm::vec3 color);
 
 void APIENTRY glDebugOutput(GLenum source,
     GLenum type,
@@ -128,7 +122,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    // For easy MSAA Don't forget to call: glEnable(GL_MULTISAMPLE);
+    // For easy MSAA Don't forget to call: GLState::enable(GL_MULTISAMPLE);
     // ------------------------------------
     glfwWindowHint(GLFW_SAMPLES, 4);
     // ------------------------------------
@@ -164,13 +158,13 @@ int main()
     if (flags & GL_CONTEXT_FLAG_DEBUG_BIT)
     {
         std::cout << "OpenGL Debug Context is enabled" << std::endl;
-        glEnable(GL_DEBUG_OUTPUT);
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        GLState::enable(GL_DEBUG_OUTPUT);
+        GLState::enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
         glDebugMessageCallback(glDebugOutput, nullptr);
         glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
     // ------------------------------------
@@ -233,82 +227,29 @@ int main()
 
     // Fonts
 	// ------------------------------------
-    FT_Library ft;
-	if (FT_Init_FreeType(&ft))
-	{
-		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-        return -1;
-	}
-
-    FT_Face face;
-	if (FT_New_Face(ft, PATH_FONT_ARIAL.c_str(), 0, &face))
+    // The glyphs are rasterized once as distance fields on their first use, for any code point and drawn at any scale
+    GlyphCache glyphs(PATH_FONT_ARIAL, 48);
+    if (!glyphs.isLoaded())
     {
-        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
         return -1;
     }
 
-	// Width of 0 means that the width is calculated by FreeType to preserve the aspect ratio
-    FT_Set_Pixel_Sizes(face, 0, 48);
-
-
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
-    for (unsigned char c = 0; c < 128; c++)
-    {
-        // load character glyph 
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            std::cout << "ERROR::FREETYPE: Failed to load Glyph" << std::endl;
-            continue;
-        }
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // now store character for later use
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<unsigned int>(face->glyph->advance.x)
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
-    }
-
-	FT_Done_Face(face);
-	FT_Done_FreeType(ft);
-
     glGenVertexArrays(1, &fontVAO);
     glGenBuffers(1, &fontVBO);
-    glBindVertexArray(fontVAO);
+    GLState::bindVertexArray(fontVAO);
     glBindBuffer(GL_ARRAY_BUFFER, fontVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 
 
     // Pre-Render
 	// ------------------------------------
 
     // Enable seamless cubemap sampling for lower mip levels in the pre-filter map.
-    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    GLState::enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	// Map the HDR equirectangular environment map to a cubemap
     glm::mat4 captureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
@@ -330,7 +271,7 @@ int main()
 
 
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+	GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
     while (!glfwWindowShouldClose(window))
     {
         frameCount++;
@@ -340,27 +281,29 @@ int main()
 		if (frameCount % 60 == 0)
 		{
 			fpsCounter.showFPS();
+			glyphs.showStats();
 		}
+        glyphs.nextFrame();
         // input
         processInput(window);
 
         // rendering commands
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(0.0f, 0.5f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glEnable(GL_MULTISAMPLE);
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_MULTISAMPLE);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
-		glEnable(GL_BLEND); // Blend for transparent objects and fonts
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLState::enable(GL_BLEND); // Blend for transparent objects and fonts
+		GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         // matrixes
 		glm::mat4 model = glm::mat4(1.0f);
@@ -385,9 +328,7 @@ int main()
 
 		std::string text = "DVD";
         float movement = curFrameTime * 125.0f;
-		float textWidth = std::accumulate(text.begin(), text.end(), 0.0f, [&](float acc, char c) {
-			return acc + static_cast<int>(Characters[c].Advance >> 6);
-		});
+		float textWidth = getTextWidth(glyphs, text);
         glm::vec3 color = glm::vec3(
             pingpong(curFrameTime / 2 + 0.5f, 0.0f, 1.0f),
             pingpong(curFrameTime / 2 + 0.8f, 0.0f, 1.0f),
@@ -395,9 +336,15 @@ int main()
         );
         float scale = 1.8f;
         float width = WINDOW_WIDTH - scale * textWidth;
-		float height = WINDOW_HEIGHT - scale * Characters[0].Size.y;
+		float height = WINDOW_HEIGHT - scale * glyphs.getAscender();
 		glm::vec2 pos = glm::vec2(pingpong(movement, 0.0f, width), pingpong(movement, 0.0f, height));
-		renderText(fontShader, text, pos.x, pos.y, scale, color);
+		renderText(fontShader, glyphs, text, pos.x, pos.y, scale, color);
+
+		// debug overlay, the same glyphs drawn much smaller, with UTF-8 middle dots and multiplication sign
+		const GlyphCache::Stats& glyphStats = glyphs.getStats();
+		const std::string overlay = "Glyphs: " + std::to_string(glyphStats.cachedGlyphs) + " \xC2\xB7 atlas " + std::to_string(glyphStats.atlasSize)
+			+ "\xC3\x97" + std::to_string(glyphStats.atlasSize) + " \xC2\xB7 " + std::to_string(static_cast<int>(fpsCounter.getFPS())) + " FPS";
+		renderText(fontShader, glyphs, overlay, 10.0f, WINDOW_HEIGHT - 25.0f, 0.35f, glm::vec3(1.0f));
 
 
         // check and call events and swap the buffers
@@ -457,7 +404,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -613,7 +560,7 @@ void renderQuad()
         // configure plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        GLState::bindVertexArray(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -627,9 +574,9 @@ void renderQuad()
         glEnableVertexAttribArray(4);
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GLState::bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 unsigned int cubeVAO = 0;
@@ -689,7 +636,7 @@ void renderCube()
         glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
         // link vertex attributes
-        glBindVertexArray(cubeVAO);
+        GLState::bindVertexArray(cubeVAO);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
@@ -697,12 +644,12 @@ void renderCube()
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        GLState::bindVertexArray(0);
     }
     // render Cube
-    glBindVertexArray(cubeVAO);
+    GLState::bindVertexArray(cubeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 
@@ -785,7 +732,7 @@ void renderSphere()
                 data.push_back(uv[i].y);
             }
         }
-        glBindVertexArray(sphereVAO);
+        GLState::bindVertexArray(sphereVAO);
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
         glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
@@ -799,52 +746,71 @@ void renderSphere()
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
     }
 
-    glBindVertexArray(sphereVAO);
+    GLState::bindVertexArray(sphereVAO);
     glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
 }
 
-void renderText(Shader& s, const std::string& text, float x, float y, float scale, glm::vec3 color)
+float getTextWidth(GlyphCache& glyphs, const std::string& text)
 {
-    // activate corresponding render state	
-    s.use();
-    s.setVec3("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(fontVAO);
+    float width = 0.0f;
+    for (const char32_t c : GlyphCache::decodeUTF8(text))
+    {
+        width += glyphs.getGlyph(c).advance;
+    }
+    return width;
+}
+
+void renderText(Shader& s, GlyphCache& glyphs, const std::string& text, float x, float y, float scale, glm::vec3 color)
+{
+    // the quads of the whole string are built first, the glyphs rasterized meanwhile may grow the atlas and move the previous ones
+    const std::u32string codePoints = GlyphCache::decodeUTF8(text);
+    for (const char32_t c : codePoints)
+    {
+        glyphs.getGlyph(c);
+    }
 
-    // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
+    fontVertices.clear();
+    for (const char32_t c : codePoints)
     {
-        Character ch = Characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }
+        const SDFGlyph& ch = glyphs.getGlyph(c);
+
+        float xpos = x + ch.bearing.x * scale;
+        float ypos = y - (ch.size.y - ch.bearing.y) * scale;
+
+        float w = ch.size.x * scale;
+        float h = ch.size.y * scale;
+        const float vertices[6][4] = {
+            { xpos,     ypos + h,   ch.uvMin.x, ch.uvMin.y },
+            { xpos,     ypos,       ch.uvMin.x, ch.uvMax.y },
+            { xpos + w, ypos,       ch.uvMax.x, ch.uvMax.y },
+
+            { xpos,     ypos + h,   ch.uvMin.x, ch.uvMin.y },
+            { xpos + w, ypos,       ch.uvMax.x, ch.uvMax.y },
+            { xpos + w, ypos + h,   ch.uvMax.x, ch.uvMin.y }
         };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, fontVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+        if (w > 0.0f && h > 0.0f)
+        {
+            fontVertices.insert(fontVertices.end(), &vertices[0][0], &vertices[0][0] + 6 * 4);
+        }
+        // now advance cursors for next glyph
+        x += ch.advance * scale;
+    }
+    if (fontVertices.empty())
+    {
+        return;
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // activate corresponding render state	
+    s.use();
+    s.setVec3("textColor", color);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, glyphs.getTexture());
+    GLState::bindVertexArray(fontVAO);
+    // a single upload and draw for the whole string
+    glBindBuffer(GL_ARRAY_BUFFER, fontVBO);
+    glBufferData(GL_ARRAY_BUFFER, fontVertices.size() * sizeof(float), fontVertices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(fontVertices.size() / 4));
 }
 
 
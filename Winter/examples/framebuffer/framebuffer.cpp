@@ -17,6 +17,7 @@
 #include "stb_image.h"
 
 #include "camera.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -122,7 +123,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -177,19 +178,19 @@ int main()
 	// ------------------------------------
     unsigned int fbo;
 	glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
 
     // Attachment Color Buffer
     unsigned int textureFBO;
     glGenTextures(1, &textureFBO);
-    glBindTexture(GL_TEXTURE_2D, textureFBO);
+    GLState::bindTexture(GL_TEXTURE_2D, textureFBO);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
     
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureFBO, 0);
 
@@ -207,7 +208,7 @@ int main()
 		std::cout << "Failed to create Framebuffer" << std::endl;
         return -1;
 	}
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Light
 	// ------------------------------------
@@ -246,7 +247,7 @@ int main()
         // rendering commands
 
         // first pass for fbo
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
         glClearColor(0.1f, 1.0f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // we're not using the stencil buffer now
 
@@ -258,11 +259,11 @@ int main()
             glm::vec3 res = glm::vec3(rotate * glm::vec4(camera.GetFront(), 1.0f));
             camera.SetFront(res);
 
-            glEnable(GL_DEPTH_TEST);
-            glDepthFunc(GL_LESS);
-            glEnable(GL_CULL_FACE);
-            glCullFace(GL_BACK);
-            glFrontFace(GL_CCW);
+            GLState::enable(GL_DEPTH_TEST);
+            GLState::depthFunc(GL_LESS);
+            GLState::enable(GL_CULL_FACE);
+            GLState::cullFace(GL_BACK);
+            GLState::frontFace(GL_CCW);
 
             glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -284,10 +285,10 @@ int main()
             shader.setFloat("material.shininess", shininessMat);
 
             // Draw cubes
-		    glActiveTexture(GL_TEXTURE0);
-		    glBindTexture(GL_TEXTURE_2D, container2Texture);
-		    glActiveTexture(GL_TEXTURE1);
-		    glBindTexture(GL_TEXTURE_2D, container2Specular);
+		    GLState::activeTexture(GL_TEXTURE0);
+		    GLState::bindTexture(GL_TEXTURE_2D, container2Texture);
+		    GLState::activeTexture(GL_TEXTURE1);
+		    GLState::bindTexture(GL_TEXTURE_2D, container2Specular);
             for (unsigned int i = 0; i < 10; i++)
             {
                 float angle = 20.0f * i + 20.0f * static_cast<float>(glfwGetTime());
@@ -314,12 +315,12 @@ int main()
             }
 
             // second pass for FBO
-            glBindFramebuffer(GL_FRAMEBUFFER, 0); // back to default
+            GLState::bindFramebuffer(GL_FRAMEBUFFER, 0); // back to default
         }
 
-        glDisable(GL_DEPTH_TEST);
-		glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textureFBO);
+        GLState::disable(GL_DEPTH_TEST);
+		GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, textureFBO);
 		screenShader.use();
 		screenShader.setInt("screenTexture", 0);
         quad.draw(screenShader);
@@ -331,14 +332,14 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteTextures(1, &containerTexture);
-    glDeleteTextures(1, &smileyTexture);
-    glDeleteTextures(1, &container2Texture);
-    glDeleteTextures(1, &container2Specular);
-    glDeleteTextures(1, &matrixTexture);
-	glDeleteTextures(1, &grassTexture);
-	glDeleteTextures(1, &windowTexture);
-    glDeleteFramebuffers(1, &fbo);
+    GLState::deleteTextures(1, &containerTexture);
+    GLState::deleteTextures(1, &smileyTexture);
+    GLState::deleteTextures(1, &container2Texture);
+    GLState::deleteTextures(1, &container2Specular);
+    GLState::deleteTextures(1, &matrixTexture);
+	GLState::deleteTextures(1, &grassTexture);
+	GLState::deleteTextures(1, &windowTexture);
+    GLState::deleteFramebuffers(1, &fbo);
 
     glfwTerminate();
 
@@ -387,7 +388,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -20,6 +20,7 @@
 
 #include "camera.h"
 #include "fpsCounter.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -96,7 +97,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    // For easy MSAA Don't forget to call: glEnable(GL_MULTISAMPLE);
+    // For easy MSAA Don't forget to call: GLState::enable(GL_MULTISAMPLE);
 	// ------------------------------------
 	glfwWindowHint(GLFW_SAMPLES, 4);
 	// ------------------------------------
@@ -125,7 +126,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -168,7 +169,7 @@ int main()
     // create floating point color buffer
     unsigned int colorBuffer;
     glGenTextures(1, &colorBuffer);
-    glBindTexture(GL_TEXTURE_2D, colorBuffer);
+    GLState::bindTexture(GL_TEXTURE_2D, colorBuffer);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -178,14 +179,14 @@ int main()
     glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, WINDOW_WIDTH, WINDOW_HEIGHT);
     // attach buffers
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorBuffer, 0);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
     {
         std::cout << "Framebuffer not complete!" << std::endl;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
     
     // lighting info
     // -------------
@@ -258,19 +259,19 @@ int main()
         processInput(window);
 
         // rendering commands
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        /*glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);*/
+        /*GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);*/
 
-        glEnable(GL_MULTISAMPLE);
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_MULTISAMPLE);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
         // matrixes
 		glm::mat4 model = glm::mat4(1.0f);
@@ -295,7 +296,7 @@ int main()
         shader.setFloat("material.shininess", shininessMat);
 
         // Render to HDR buffer
-        glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         shader.use();
         // set lighting uniforms
@@ -312,19 +313,19 @@ int main()
         model = glm::translate(model, glm::vec3(0.0f, 0.0f, 25.0f));
         model = glm::scale(model, glm::vec3(2.5f, 2.5f, 27.5f));
         shader.setMat4("model", value_ptr(model));
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, woodTexture);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, woodTextureSpec);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, woodTexture);
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, woodTextureSpec);
         cube.draw(shader);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
         // Render to quad
         //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         hdrShader.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, colorBuffer);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, colorBuffer);
         hdrShader.setInt("hdr", 1);
         float exposure = 2.0f * abs(sin(0.25f * curFrameTime));
         hdrShader.setFloat("exposure", exposure);
@@ -339,11 +340,11 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteTextures(1, &containerTexture);
-    glDeleteTextures(1, &container2Texture);
-    glDeleteTextures(1, &container2Specular);
-	glDeleteTextures(1, &woodTexture);
-	glDeleteTextures(1, &woodTextureSpec);
+    GLState::deleteTextures(1, &containerTexture);
+    GLState::deleteTextures(1, &container2Texture);
+    GLState::deleteTextures(1, &container2Specular);
+	GLState::deleteTextures(1, &woodTexture);
+	GLState::deleteTextures(1, &woodTextureSpec);
 
     glfwTerminate();
 
@@ -392,7 +393,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -548,7 +549,7 @@ void renderQuad()
         // configure plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        GLState::bindVertexArray(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -562,7 +563,7 @@ void renderQuad()
         glEnableVertexAttribArray(4);
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GLState::bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
\ No newline at end of file
@@ -44,17 +44,22 @@ in VS_OUT{
 	vec3 FragPos;
 	vec3 Normal;
 	vec2 TexCoords;
-	vec4 FragPosLightSpace;
+	float ViewDepth;
 } fs_in;
 
 out vec4 FragColor;
 
 #define NB_POINT_LIGHTS 4
+#define NB_CASCADES 4
 
 uniform Material material;
 uniform vec3 viewPos;
 uniform DirLight dirLight;
-uniform sampler2D shadowMap;
+// cascaded shadow map of the directional light, a layer per cascade
+uniform sampler2DArray shadowMap;
+uniform mat4 cascadeMatrices[NB_CASCADES];
+uniform float cascadeSplits[NB_CASCADES]; // view depth at which each cascade ends
+uniform float cascadeTexelDepths[NB_CASCADES]; // world size of a texel in the depth range of each cascade
 uniform SpotLight spotLight;
 uniform PointLight pointLights[NB_POINT_LIGHTS];
 uniform samplerCube depthCubemap;
@@ -63,7 +68,7 @@ uniform float far_planeCube;
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-float ShadowCalculationDir(vec4 fragPosLightSpace, vec3 lightDir, vec3 normal);
+float ShadowCalculationDir(vec3 fragPos, float viewDepth, vec3 lightDir, vec3 normal);
 float ShadowCalculationPoint(vec3 fragPos, vec3 lightPos, vec3 normal);
 
 void main()
@@ -72,7 +77,7 @@ void main()
 	vec3 viewDir = normalize(viewPos - fs_in.FragPos);
 
 	vec3 result = vec3(0.0);
-	//result += CalcDirLight(dirLight, normal, viewDir);
+	result += CalcDirLight(dirLight, normal, viewDir);
 	for(int i = 0; i < 1; i++)
 	{
 		result += CalcPointLight(pointLights[i], normal, fs_in.FragPos, viewDir);
@@ -99,7 +104,7 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
 	vec3 specular = light.specular * spec * texture(material.texture_specular0, fs_in.TexCoords).rgb;
 
 	// Shadows
-	float shadow = ShadowCalculationDir(fs_in.FragPosLightSpace, lightDir, normal);
+	float shadow = ShadowCalculationDir(fs_in.FragPos, fs_in.ViewDepth, lightDir, normal);
 	vec3 lighting = ambient + (1.0 - shadow) * (diffuse + specular);
 
 	return lighting;
@@ -163,22 +168,33 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 	return (ambient + diffuse + specular) * attenuation;
 }
 
-float ShadowCalculationDir(vec4 fragPosLightSpace, vec3 lightDir, vec3 normal)
+float ShadowCalculationDir(vec3 fragPos, float viewDepth, vec3 lightDir, vec3 normal)
 {
+    // first cascade containing the fragment, no shadow past the last one
+    int cascade = 0;
+    while (cascade < NB_CASCADES && viewDepth > cascadeSplits[cascade])
+    {
+        cascade++;
+    }
+    if (cascade == NB_CASCADES)
+    {
+        return 0.0;
+    }
+    vec4 fragPosLightSpace = cascadeMatrices[cascade] * vec4(fragPos, 1.0);
     // perform perspective divide
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     // transform to [0,1] range
     projCoords = projCoords * 0.5 + 0.5;
 
     // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-    float closestDepth = texture(shadowMap, projCoords.xy).r; 
+    float closestDepth = texture(shadowMap, vec3(projCoords.xy, cascade)).r; 
     // get depth of current fragment from light's perspective
     float currentDepth = projCoords.z;
     
-	// check whether current frag pos is in shadow
-	float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.005);
+	// check whether current frag pos is in shadow, the bias is a number of texels of the cascade growing with the slope
+	float bias = cascadeTexelDepths[cascade] * max(4.0 * (1.0 - dot(normal, lightDir)), 1.0);
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+	vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
 	if(projCoords.z > 1.0)
 	{
 	    shadow = 0.0;
@@ -189,7 +205,7 @@ float ShadowCalculationDir(vec4 fragPosLightSpace, vec3 lightDir, vec3 normal)
 		{
 			for(int y = -1; y <= 1; y++)
 			{
-				float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+				float pcfDepth = texture(shadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, cascade)).r;
 				shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
 			}
 		}
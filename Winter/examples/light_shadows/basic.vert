@@ -8,7 +8,7 @@ out VS_OUT {
 	vec3 FragPos;
 	vec3 Normal;
 	vec2 TexCoords;
-	vec4 FragPosLightSpace;
+	float ViewDepth; // selects the shadow cascade
 } vs_out;
 
 layout (std140) uniform Matrices
@@ -18,7 +18,6 @@ layout (std140) uniform Matrices
 };
 
 uniform mat4 model;
-uniform mat4 lightSpaceMatrix;
 uniform vec2 texScale;
 
 void main()
@@ -31,5 +30,5 @@ void main()
    vs_out.Normal = mat3(transpose(inverse(model))) * aNormal;
 
    vs_out.TexCoords = aTexCoords * texScale;
-   vs_out.FragPosLightSpace = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
+   vs_out.ViewDepth = -(view * vec4(vs_out.FragPos, 1.0)).z;
 };
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "cascadedShadowMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include "frustum.h"
+#include "glState.h"
+#include "profiler.h"
+
+// The profiler scope names must be string literals
+const char* const CASCADE_SCOPES[CascadedShadowMap::CASCADE_COUNT] = {
+	"Shadow cascade 0",
+	"Shadow cascade 1",
+	"Shadow cascade 2",
+	"Shadow cascade 3"
+};
+
+CascadedShadowMap::CascadedShadowMap(unsigned int resolution, float shadowDistance, float casterDistance, float splitLambda)
+	: resolution(resolution), shadowDistance(shadowDistance), casterDistance(casterDistance), splitLambda(splitLambda),
+	texture(createDepthArray(resolution)), staticTexture(createDepthArray(resolution)),
+	lightMatrices(), splitDepths(), texelDepths(), staticLightMatrices(), isStaticValid(), hasDynamicCasters(), stats()
+{
+	glGenFramebuffers(CASCADE_COUNT, framebuffers);
+	glGenFramebuffers(CASCADE_COUNT, staticFramebuffers);
+	for (unsigned int i = 0; i < CASCADE_COUNT; i++)
+	{
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, framebuffers[i]);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, i);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, staticFramebuffers[i]);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticTexture, 0, i);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "ERROR::CASCADED_SHADOW_MAP: Framebuffer of cascade " << i << " not complete" << std::endl;
+		}
+	}
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+CascadedShadowMap::~CascadedShadowMap()
+{
+	GLState::deleteFramebuffers(CASCADE_COUNT, framebuffers);
+	GLState::deleteFramebuffers(CASCADE_COUNT, staticFramebuffers);
+	GLState::deleteTextures(1, &texture);
+	GLState::deleteTextures(1, &staticTexture);
+}
+
+void CascadedShadowMap::update(const glm::mat4& view, float fov, float aspect, float nearPlane, const glm::vec3& lightDirection)
+{
+	const glm::vec3 direction = glm::normalize(lightDirection);
+	const glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), direction, up);
+	const glm::mat4 inverseView = glm::inverse(view);
+	// squared distance to the view axis of the corners of a slice, per unit of depth
+	const float tanHalfFOV = std::tan(glm::radians(fov) * 0.5f);
+	const float cornerScale = tanHalfFOV * tanHalfFOV * (1.0f + aspect * aspect);
+
+	float sliceNear = nearPlane;
+	for (unsigned int i = 0; i < CASCADE_COUNT; i++)
+	{
+		// blend of the logarithmic and uniform splits
+		const float fraction = static_cast<float>(i + 1) / static_cast<float>(CASCADE_COUNT);
+		const float logSplit = nearPlane * std::pow(shadowDistance / nearPlane, fraction);
+		const float uniformSplit = nearPlane + (shadowDistance - nearPlane) * fraction;
+		const float sliceFar = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+		splitDepths[i] = sliceFar;
+
+		// smallest sphere around the slice, on the view axis at the same distance of its near and far corners
+		const float centerDepth = std::min(0.5f * (sliceNear + sliceFar) * (1.0f + cornerScale), sliceFar);
+		const float nearDistance = sliceNear - centerDepth;
+		const float farDistance = sliceFar - centerDepth;
+		const float radius = std::sqrt(std::max(nearDistance * nearDistance + sliceNear * sliceNear * cornerScale,
+			farDistance * farDistance + sliceFar * sliceFar * cornerScale));
+		const glm::vec3 center = glm::vec3(inverseView * glm::vec4(0.0f, 0.0f, -centerDepth, 1.0f));
+
+		// the sphere and a border of SNAP_TEXELS texels fill the cascade, the border covering the snapping of the center
+		const float texelSize = 2.0f * radius / static_cast<float>(resolution - 2 * SNAP_TEXELS);
+		const float snapStep = SNAP_TEXELS * texelSize;
+		const float extent = radius + snapStep;
+		glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+		lightCenter = glm::floor(lightCenter / snapStep) * snapStep;
+		// the casters in front of the slice, towards the light, are included up to casterDistance
+		const glm::mat4 lightProjection = glm::ortho(lightCenter.x - extent, lightCenter.x + extent, lightCenter.y - extent, lightCenter.y + extent,
+			-(lightCenter.z + extent + casterDistance), -(lightCenter.z - extent));
+		lightMatrices[i] = lightProjection * lightView;
+		texelDepths[i] = texelSize / (2.0f * extent + casterDistance);
+
+		sliceNear = sliceFar;
+	}
+}
+
+void CascadedShadowMap::render(Shader& depthShader, const std::vector<ShadowCaster>& casters)
+{
+	GLState::viewport(0, 0, resolution, resolution);
+	depthShader.use();
+	std::vector<unsigned int> staticIndices;
+	std::vector<unsigned int> dynamicIndices;
+	for (unsigned int i = 0; i < CASCADE_COUNT; i++)
+	{
+		Profiler::beginScope(CASCADE_SCOPES[i]);
+		const Frustum frustum(lightMatrices[i]);
+		staticIndices.clear();
+		dynamicIndices.clear();
+		for (unsigned int j = 0; j < casters.size(); j++)
+		{
+			if (frustum.isVisible(casters[j].bounds))
+			{
+				(casters[j].isStatic ? staticIndices : dynamicIndices).push_back(j);
+			}
+		}
+		CascadeStats& cascadeStats = stats[i];
+		cascadeStats.staticCasters = static_cast<unsigned int>(staticIndices.size());
+		cascadeStats.dynamicCasters = static_cast<unsigned int>(dynamicIndices.size());
+		cascadeStats.staticDraws = 0;
+		cascadeStats.dynamicDraws = 0;
+		cascadeStats.isStaticCached = isStaticValid[i] && staticLightMatrices[i] == lightMatrices[i];
+		depthShader.setMat4("lightSpaceMatrix", glm::value_ptr(lightMatrices[i]));
+
+		if (!cascadeStats.isStaticCached)
+		{
+			GLState::bindFramebuffer(GL_FRAMEBUFFER, staticFramebuffers[i]);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			cascadeStats.staticDraws = drawCasters(depthShader, casters, staticIndices);
+			staticLightMatrices[i] = lightMatrices[i];
+			isStaticValid[i] = true;
+		}
+		// the layer is up to date when neither its static casters nor the dynamic casters of this frame and the last changed
+		if (!cascadeStats.isStaticCached || !dynamicIndices.empty() || hasDynamicCasters[i])
+		{
+			glCopyImageSubData(staticTexture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, resolution, resolution, 1);
+			if (!dynamicIndices.empty())
+			{
+				GLState::bindFramebuffer(GL_FRAMEBUFFER, framebuffers[i]);
+				cascadeStats.dynamicDraws = drawCasters(depthShader, casters, dynamicIndices);
+			}
+		}
+		hasDynamicCasters[i] = !dynamicIndices.empty();
+		Profiler::endScope();
+	}
+	GLState::cullFace(GL_BACK);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CascadedShadowMap::invalidateStaticCache()
+{
+	std::fill(std::begin(isStaticValid), std::end(isStaticValid), false);
+}
+
+unsigned int CascadedShadowMap::getTexture() const
+{
+	return texture;
+}
+
+unsigned int CascadedShadowMap::getResolution() const
+{
+	return resolution;
+}
+
+const glm::mat4& CascadedShadowMap::getLightMatrix(unsigned int cascade) const
+{
+	return lightMatrices[cascade];
+}
+
+float CascadedShadowMap::getSplitDepth(unsigned int cascade) const
+{
+	return splitDepths[cascade];
+}
+
+float CascadedShadowMap::getTexelDepth(unsigned int cascade) const
+{
+	return texelDepths[cascade];
+}
+
+const CascadedShadowMap::CascadeStats& CascadedShadowMap::getStats(unsigned int cascade) const
+{
+	return stats[cascade];
+}
+
+void CascadedShadowMap::showStats() const
+{
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << std::left << std::setw(10) << "Cascade" << std::right << std::setw(10) << "Split" << std::setw(18) << "Casters s / d"
+		<< std::setw(18) << "Draws s / d" << std::setw(10) << "Cached" << std::endl;
+	for (unsigned int i = 0; i < CASCADE_COUNT; i++)
+	{
+		const CascadeStats& cascadeStats = stats[i];
+		std::cout << std::left << std::setw(10) << i << std::right << std::setw(10) << splitDepths[i]
+			<< std::setw(12) << cascadeStats.staticCasters << " /" << std::setw(4) << cascadeStats.dynamicCasters
+			<< std::setw(12) << cascadeStats.staticDraws << " /" << std::setw(4) << cascadeStats.dynamicDraws
+			<< std::setw(10) << (cascadeStats.isStaticCached ? "yes" : "no") << std::endl;
+	}
+	std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+unsigned int CascadedShadowMap::createDepthArray(unsigned int resolution)
+{
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	GLState::bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, CASCADE_COUNT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, glm::value_ptr(glm::vec4(1.0f)));
+	return texture;
+}
+
+unsigned int CascadedShadowMap::drawCasters(Shader& depthShader, const std::vector<ShadowCaster>& casters, const std::vector<unsigned int>& indices)
+{
+	for (const unsigned int index : indices)
+	{
+		const ShadowCaster& caster = casters[index];
+		GLState::cullFace(caster.cullFrontFaces ? GL_FRONT : GL_BACK);
+		depthShader.setMat4("model", glm::value_ptr(caster.model));
+		caster.draw(depthShader);
+	}
+	return static_cast<unsigned int>(indices.size());
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "bounds.h"
+#include "shader.h"
+
+// Shadow caster of the directional light, drawn in each cascade it overlaps
+struct ShadowCaster {
+	std::function<void(Shader&)> draw;
+	glm::mat4 model;
+	BoundingSphere bounds; // world space
+	// static casters are cached with the cascades
+	bool isStatic;
+	// closed meshes cull their front faces against peter panning, the single sided ones (quads) cannot
+	bool cullFrontFaces;
+};
+
+// Cascaded shadow maps of a directional light, one layer of a GL_TEXTURE_2D_ARRAY per cascade.
+// The view frustum up to shadowDistance is split between the cascades, closer to logarithmic than uniform (splitLambda),
+// and each cascade is fitted to the bounding sphere of its slice so that its size does not change as the camera turns.
+// Its center is snapped to a grid of SNAP_TEXELS texels in light space, with a border of as many texels around the sphere:
+// the shadow texels do not shimmer when the camera moves, and the cascade bounds only move every SNAP_TEXELS texels.
+// The static casters are drawn to a cache array, re-rendered when the light or the bounds of a cascade move,
+// and copied to the sampled array under the dynamic casters. A cascade without dynamic casters is left as it is.
+class CascadedShadowMap {
+public:
+	static const unsigned int CASCADE_COUNT = 4;
+	static const unsigned int SNAP_TEXELS = 64;
+
+	// Of the last render
+	struct CascadeStats {
+		unsigned int staticCasters;
+		unsigned int dynamicCasters;
+		// draw calls, the static ones are only issued when the cache is redrawn
+		unsigned int staticDraws;
+		unsigned int dynamicDraws;
+		bool isStaticCached;
+	};
+
+	CascadedShadowMap(unsigned int resolution, float shadowDistance, float casterDistance, float splitLambda = 0.75f);
+	~CascadedShadowMap();
+	CascadedShadowMap(const CascadedShadowMap& other) = delete;
+	CascadedShadowMap& operator=(const CascadedShadowMap& other) = delete;
+
+	// Fits the cascades to the camera, fov in degrees
+	void update(const glm::mat4& view, float fov, float aspect, float nearPlane, const glm::vec3& lightDirection);
+	// Draws the casters with a depth shader taking the lightSpaceMatrix and model uniforms.
+	// Changes the viewport, the cull face and the framebuffer binding.
+	void render(Shader& depthShader, const std::vector<ShadowCaster>& casters);
+	// To be called when the static casters change
+	void invalidateStaticCache();
+
+	unsigned int getTexture() const;
+	unsigned int getResolution() const;
+	const glm::mat4& getLightMatrix(unsigned int cascade) const;
+	// View space distance at which the cascade ends
+	float getSplitDepth(unsigned int cascade) const;
+	// World size of a texel of the cascade in its [0,1] depth range, the unit of the depth bias:
+	// the cascades differ in depth range and texel size, a bias in depth values tuned for one would not fit the others
+	float getTexelDepth(unsigned int cascade) const;
+	const CascadeStats& getStats(unsigned int cascade) const;
+	void showStats() const;
+private:
+	unsigned int resolution;
+	float shadowDistance;
+	float casterDistance;
+	float splitLambda;
+	// sampled and static cache arrays of the cascades, a framebuffer per layer
+	unsigned int texture;
+	unsigned int staticTexture;
+	unsigned int framebuffers[CASCADE_COUNT];
+	unsigned int staticFramebuffers[CASCADE_COUNT];
+	glm::mat4 lightMatrices[CASCADE_COUNT];
+	float splitDepths[CASCADE_COUNT];
+	float texelDepths[CASCADE_COUNT];
+	// light matrices the static layers were drawn with
+	glm::mat4 staticLightMatrices[CASCADE_COUNT];
+	bool isStaticValid[CASCADE_COUNT];
+	bool hasDynamicCasters[CASCADE_COUNT];
+	CascadeStats stats[CASCADE_COUNT];
+
+	static unsigned int createDepthArray(unsigned int resolution);
+	// Returns the draw count
+	static unsigned int drawCasters(Shader& depthShader, const std::vector<ShadowCaster>& casters, const std::vector<unsigned int>& indices);
+};
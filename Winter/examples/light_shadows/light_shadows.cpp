@@ -1,6 +1,8 @@
 ﻿// Advanced Lighting: Shadows
 // https://learnopengl.com/Advanced-Lighting/Shadows/Shadow-Mapping
 // https://learnopengl.com/Advanced-Lighting/Shadows/Point-Shadows
+// The directional light casts cascaded shadow maps (CascadedShadowMap), the static casters are cached per cascade
+// and only the rotating cube is drawn every frame. The times and draw counts of the cascades are shown every 60 frames.
 #include <array>
 #include <algorithm>
 #include <filesystem>
@@ -20,9 +22,12 @@
 #include "stb_image.h"
 
 #include "camera.h"
+#include "cascadedShadowMap.h"
 #include "fpsCounter.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
+#include "profiler.h"
 #include "shader.h"
 #include "texture.h"
 
@@ -44,6 +49,7 @@ const float cameraMoveSpeed = 2.5f;
 glm::vec3 lightAmbient(0.1f, 0.1f, 0.1f);
 glm::vec3 lightDiffuse(0.9f, 0.9f, 0.9f);
 glm::vec3 lightSpecular(1.0f, 1.0f, 1.0f);
+glm::vec3 dirLightDirection(-0.2f, -1.0f, -0.3f);
 
 glm::vec3 lightScale(0.33f);
 glm::vec3 pointLightPositions[] = {
@@ -100,7 +106,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    // For easy MSAA Don't forget to call: glEnable(GL_MULTISAMPLE);
+    // For easy MSAA Don't forget to call: GLState::enable(GL_MULTISAMPLE);
 	// ------------------------------------
 	glfwWindowHint(GLFW_SAMPLES, 4);
 	// ------------------------------------
@@ -129,7 +135,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -174,34 +180,22 @@ int main()
 
     // FrameBuffer
 
-    unsigned int depthMapFBO;
-	glGenFramebuffers(1, &depthMapFBO);
-
 	const unsigned int SHADOW_WIDTH = 1024;
 	const unsigned int SHADOW_HEIGHT = 1024;
 
-	unsigned int depthMap;
-	glGenTextures(1, &depthMap);
-	glBindTexture(GL_TEXTURE_2D, depthMap);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-	glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, glm::value_ptr(glm::vec3(1.0f)));
-
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	// Directional light: 4 cascades of 2048x2048 over the first 50 units of the view,
+	// with the casters up to 50 units further towards the light
+	const unsigned int CASCADE_RESOLUTION = 2048;
+	const float shadowDistance = 50.0f;
+	const float shadowCasterDistance = 50.0f;
+	CascadedShadowMap cascadedShadowMap(CASCADE_RESOLUTION, shadowDistance, shadowCasterDistance);
 
     unsigned int depthCubeMapFBO;
     glGenFramebuffers(1, &depthCubeMapFBO);
 
     unsigned int depthCubemap;
 	glGenTextures(1, &depthCubemap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
+	GLState::bindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
     for (unsigned int i = 0; i < 6; ++i)
     {
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
@@ -212,11 +206,11 @@ int main()
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, depthCubeMapFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, depthCubeMapFBO);
     glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubemap, 0);
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Uniform Buffers
 	// ------------------------------------
@@ -236,6 +230,16 @@ int main()
     // Light
 	// ------------------------------------
 	setShaderLights(shader);
+    // cascades of the directional light, set every frame
+    UniformHandle cascadeMatrixHandles[CascadedShadowMap::CASCADE_COUNT];
+    UniformHandle cascadeSplitHandles[CascadedShadowMap::CASCADE_COUNT];
+    UniformHandle cascadeTexelDepthHandles[CascadedShadowMap::CASCADE_COUNT];
+    for (unsigned int i = 0; i < CascadedShadowMap::CASCADE_COUNT; i++)
+    {
+        cascadeMatrixHandles[i] = shader.getUniformHandle("cascadeMatrices[" + std::to_string(i) + "]");
+        cascadeSplitHandles[i] = shader.getUniformHandle("cascadeSplits[" + std::to_string(i) + "]");
+        cascadeTexelDepthHandles[i] = shader.getUniformHandle("cascadeTexelDepths[" + std::to_string(i) + "]");
+    }
 
     // Models and Meshes
 	// ------------------------------------
@@ -269,24 +273,26 @@ int main()
 		if (frameCount % 60 == 0)
 		{
 			fpsCounter.showFPS();
+			Profiler::showStats();
+			cascadedShadowMap.showStats();
 		}
         // input
         processInput(window);
 
         // rendering commands
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glEnable(GL_MULTISAMPLE);
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_MULTISAMPLE);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
         // matrixes
         glm::mat4 view = camera.getViewMatrix();
@@ -309,68 +315,42 @@ int main()
         float shininessMat = 32.0f;
         shader.setFloat("material.shininess", shininessMat);
 
-		// Render to FBO for shadow mapping
-		glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-		glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-		glClear(GL_DEPTH_BUFFER_BIT);
-
-        // To prevent peter panning (this makes sure that shadows are not 'detached' from the objects)
-        glCullFace(GL_FRONT);
-        // Set projection matrix for directional light POV
-        float nearPlane = 1.0f;
-        float farPlane = 7.5f;
-		glm::mat4 lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, nearPlane, farPlane);
-        glm::mat4 lightView = glm::lookAt(glm::vec3(-2.0f, 4.0f, -1.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		glm::mat4 lightMatrix = lightProjection * lightView;
-        // RENDER
-        simpleDepthShader.use();
-		simpleDepthShader.setMat4("lightSpaceMatrix", value_ptr(lightMatrix));
-
-        glm::mat4 model(1.0f);
-        simpleDepthShader.use();
-        simpleDepthShader.setMat4("model", value_ptr(model));
-        cubeModel.draw(simpleDepthShader);
-
-        model = glm::mat4(1.0f);
-		model = glm::translate(model, glm::vec3(2.0f, -0.5f, 0.0f));
-        simpleDepthShader.use();
-        simpleDepthShader.setMat4("model", value_ptr(model));
-        cubeModel.draw(simpleDepthShader);
-
-        simpleDepthShader.use();
-        simpleDepthShader.setVec3("color", lightSpecular);
+        // the second cube rotates, it is the only dynamic shadow caster
+        const glm::mat4 rotatingCubeModel = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(2.0f, -0.5f, 0.0f)),
+            glm::radians(20.0f * curFrameTime), glm::vec3(0.0f, 1.0f, 0.0f));
+        float floorScale = 8.0f;
+        glm::mat4 floorModel = glm::mat4(1.0f);
+        floorModel = glm::translate(floorModel, glm::vec3(0.0f, -1.0f, 0.0f));
+        floorModel = glm::rotate(floorModel, glm::radians(90.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
+        floorModel = glm::scale(floorModel, glm::vec3(floorScale));
+
+		// Render the cascaded shadow maps of the directional light
+        Profiler::beginScope("Directional shadows");
+        const auto drawCube = [&cubeModel](Shader& depthShader) { cubeModel.draw(depthShader); };
+        std::vector<ShadowCaster> shadowCasters;
+        shadowCasters.push_back({ drawCube, glm::mat4(1.0f), cubeModel.getBoundingSphere(), true, true });
+        shadowCasters.push_back({ drawCube, rotatingCubeModel, cubeModel.getBoundingSphere().transform(rotatingCubeModel), false, true });
         for (unsigned int i = 0; i < sizeof(pointLightPositions) / sizeof(glm::vec3); i++)
         {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, pointLightPositions[i]);
-            model = glm::scale(model, lightScale);
-            simpleDepthShader.setMat4("model", value_ptr(model));
-            cubeModel.draw(simpleDepthShader);
+            const glm::mat4 lightCubeModel = glm::scale(glm::translate(glm::mat4(1.0f), pointLightPositions[i]), lightScale);
+            shadowCasters.push_back({ drawCube, lightCubeModel, cubeModel.getBoundingSphere().transform(lightCubeModel), true, true });
         }
+        // quads only have a front face
+        shadowCasters.push_back({ [&woodQuad](Shader& depthShader) { woodQuad.draw(depthShader); },
+            floorModel, woodQuad.getBoundingSphere().transform(floorModel), true, false });
 
-		// Reset culling as quads only have a front face
-        glCullFace(GL_BACK);
-        // Floor
-        float floorScale = 8.0f;
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, -1.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(floorScale));
-        simpleDepthShader.setMat4("model", value_ptr(model));
-        simpleDepthShader.setVec2("texScale", glm::vec2(floorScale));
-        simpleDepthShader.setFloat("material.shininess", 16.0f);
-        woodQuad.draw(simpleDepthShader);
-
-        glCullFace(GL_BACK);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        cascadedShadowMap.update(view, camera.GetFOV(), static_cast<float>(WINDOW_WIDTH) / static_cast<float>(WINDOW_HEIGHT), cameraNearPlane, dirLightDirection);
+        cascadedShadowMap.render(simpleDepthShader, shadowCasters);
+        Profiler::endScope();
 
         // Render to FBO cubemap shadows for point lights
-		glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-		glBindFramebuffer(GL_FRAMEBUFFER, depthCubeMapFBO);
+        Profiler::beginScope("Point shadows");
+		GLState::viewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, depthCubeMapFBO);
 		glClear(GL_DEPTH_BUFFER_BIT);
 
         // To prevent peter panning (this makes sure that shadows are not 'detached' from the objects)
-        glCullFace(GL_FRONT);
+        GLState::cullFace(GL_FRONT);
 		float aspectPoint = static_cast<float>(SHADOW_WIDTH) / static_cast<float>(SHADOW_HEIGHT);
 		float nearPoint = 1.0f;
 		float farPoint = 25.0f;
@@ -401,15 +381,13 @@ int main()
         cubemapShadowShader.setMat4("shadowMatrices[4]", value_ptr(shadowTransforms[4]));
         cubemapShadowShader.setMat4("shadowMatrices[5]", value_ptr(shadowTransforms[5]));
 
-        model = glm::mat4(1.0f);
+        glm::mat4 model = glm::mat4(1.0f);
         cubemapShadowShader.use();
         cubemapShadowShader.setMat4("model", value_ptr(model));
         cubeModel.draw(cubemapShadowShader);
 
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(2.0f, -0.5f, 0.0f));
         cubemapShadowShader.use();
-        cubemapShadowShader.setMat4("model", value_ptr(model));
+        cubemapShadowShader.setMat4("model", value_ptr(rotatingCubeModel));
         cubeModel.draw(cubemapShadowShader);
 
         cubemapShadowShader.use();
@@ -424,33 +402,35 @@ int main()
         }
 
         // Reset culling as quads only have a front face
-        glCullFace(GL_BACK);
+        GLState::cullFace(GL_BACK);
         // Floor
-        floorScale = 8.0f;
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, -1.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(90.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
-        model = glm::scale(model, glm::vec3(floorScale));
-        cubemapShadowShader.setMat4("model", value_ptr(model));
+        cubemapShadowShader.setMat4("model", value_ptr(floorModel));
         cubemapShadowShader.setVec2("texScale", glm::vec2(floorScale));
         cubemapShadowShader.setFloat("material.shininess", 16.0f);
         woodQuad.draw(cubemapShadowShader);
 
-        glCullFace(GL_BACK);
+        GLState::cullFace(GL_BACK);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+        Profiler::endScope();
 
         // Render scene
-		glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+        Profiler::beginScope("Scene");
+		GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
         shader.use();
-		shader.setMat4("lightSpaceMatrix", value_ptr(lightMatrix));
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, depthMap);
+        for (unsigned int i = 0; i < CascadedShadowMap::CASCADE_COUNT; i++)
+        {
+            shader.setMat4(cascadeMatrixHandles[i], value_ptr(cascadedShadowMap.getLightMatrix(i)));
+            shader.setFloat(cascadeSplitHandles[i], cascadedShadowMap.getSplitDepth(i));
+            shader.setFloat(cascadeTexelDepthHandles[i], cascadedShadowMap.getTexelDepth(i));
+        }
+        GLState::activeTexture(GL_TEXTURE2);
+        GLState::bindTexture(GL_TEXTURE_2D_ARRAY, cascadedShadowMap.getTexture());
         shader.setInt("shadowMap", 2);
 
-		glActiveTexture(GL_TEXTURE3);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
+		GLState::activeTexture(GL_TEXTURE3);
+		GLState::bindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
 		shader.setInt("depthCubemap", 3);
 		shader.setFloat("far_planeCube", farPoint);
 
@@ -458,18 +438,11 @@ int main()
         shader.setMat4("model", value_ptr(model));
         cubeModel.draw(shader);
 
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(2.0f, -0.5f, 0.0f));
-        shader.setMat4("model", value_ptr(model));
+        shader.setMat4("model", value_ptr(rotatingCubeModel));
         cubeModel.draw(shader);
 
         // Floor
-        floorScale = 8.0f;
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, glm::vec3(0.0f, -1.0f, 0.0f));
-		model = glm::rotate(model, glm::radians(90.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(floorScale));
-		shader.setMat4("model", value_ptr(model));
+		shader.setMat4("model", value_ptr(floorModel));
         shader.setVec2("texScale", glm::vec2(floorScale));
         shader.setFloat("material.shininess", 16.0f);
 		woodQuad.draw(shader);
@@ -485,15 +458,11 @@ int main()
 			cubeModel.draw(lightCubeShader);
 		}
 
-        // Render to screen
-        screenShader.use();
-        glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, depthMap);
-		screenShader.setInt("screenTexture", 0);
-        //quad.draw(screenShader);
+        Profiler::endScope();
 
         // check and call events and swap the buffers
         glfwSwapBuffers(window);
+        Profiler::nextFrame();
         glfwPollEvents();
 
         lastFrameTime = curFrameTime;
@@ -501,8 +470,9 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteTextures(1, &container2Texture);
-    glDeleteTextures(1, &container2Specular);
+    GLState::deleteTextures(1, &container2Texture);
+    GLState::deleteTextures(1, &container2Specular);
+    Profiler::release();
 
     glfwTerminate();
 
@@ -551,7 +521,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -591,7 +561,7 @@ void setShaderLights(Shader& shader)
 {
     shader.use();
 
-    shader.setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
+    shader.setVec3("dirLight.direction", dirLightDirection);
     shader.setVec3("dirLight.ambient", lightAmbient);
     shader.setVec3("dirLight.diffuse", lightDiffuse);
     shader.setVec3("dirLight.specular", lightSpecular);
@@ -0,0 +1,113 @@
+﻿// Benchmark: Model loading
+// Compares the startup cost of importing models with assimp (cold) against loading their binary mesh cache (warm)
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "meshCache.h"
+#include "model.h"
+#include "pathManager.h"
+#include "textureCache.h"
+
+double loadModelMs(const std::string& path);
+
+int main()
+{
+    // Init Paths
+    PathManager::projectPath = std::filesystem::current_path().string() + "/";
+
+    // DATA
+    // ------------------------------------
+    const std::string WINDOW_TITLE = "Model Loading Benchmark";
+
+    const std::vector<std::string> PATH_MODELS = {
+        PathManager::getModelsPath() + "nanosuit/nanosuit.obj",
+        PathManager::getModelsPath() + "cyborg/cyborg.obj",
+        PathManager::getModelsPath() + "backpack/backpack.obj",
+    };
+
+    // INIT GLFW
+    // ------------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    // MAC only line to enable forward compatibility
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    // Only a context is needed to upload the meshes
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1, 1, WINDOW_TITLE.c_str(), nullptr, nullptr);
+    if (window == nullptr)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    // Init GLAD
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // BENCHMARK
+    // ------------------------------------
+    // first launch: no mesh cache and no texture loaded
+    // cold: assimp import, textures already loaded
+    // warm: mesh cache, textures already loaded
+    double totalColdMs = 0.0;
+    double totalWarmMs = 0.0;
+    for (const std::string& path : PATH_MODELS)
+    {
+        if (!std::filesystem::exists(path))
+        {
+            std::cout << "Skipping missing model: " << path << std::endl;
+            continue;
+        }
+
+        std::filesystem::remove(MeshCache::getCachePath(path));
+        const auto start = std::chrono::high_resolution_clock::now();
+        // kept alive so that its textures stay in the TextureCache
+        const Model firstModel(path);
+        glFinish();
+        const double firstLaunchMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        std::filesystem::remove(MeshCache::getCachePath(path));
+        const double coldMs = loadModelMs(path);
+        const double warmMs = loadModelMs(path);
+        totalColdMs += coldMs;
+        totalWarmMs += warmMs;
+
+        std::cout << std::filesystem::path(path).filename().string() << ": first launch " << firstLaunchMs << " ms, cold " << coldMs << " ms, warm " 
+            << warmMs << " ms (x" << coldMs / warmMs << ")" << std::endl;
+    }
+    std::cout << "Total: cold " << totalColdMs << " ms, warm " << totalWarmMs << " ms" << std::endl;
+    TextureCache::showStats();
+
+    // CLEANUP
+    // ------------------------------------
+    glfwTerminate();
+
+    return 0;
+}
+
+double loadModelMs(const std::string& path)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    {
+        Model model(path);
+        glFinish();
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
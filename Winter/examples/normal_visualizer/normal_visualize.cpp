@@ -20,6 +20,7 @@
 
 #include "camera.h"
 #include "fpsCounter.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -114,7 +115,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -159,7 +160,7 @@ int main()
     unsigned int VAOpoints, VBOpoints;
     glGenVertexArrays(1, &VAOpoints);
     glGenBuffers(1, &VBOpoints);
-	glBindVertexArray(VAOpoints);
+	GLState::bindVertexArray(VAOpoints);
 	glBindBuffer(GL_ARRAY_BUFFER, VBOpoints);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(points), points, GL_STATIC_DRAW);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*) 0);
@@ -167,22 +168,22 @@ int main()
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*) (2 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 
     // FBO
 	// ------------------------------------
     unsigned int fbo;
 	glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
 
     // Attachment Color Buffer
     unsigned int textureFBO;
     glGenTextures(1, &textureFBO);
-    glBindTexture(GL_TEXTURE_2D, textureFBO);
+    GLState::bindTexture(GL_TEXTURE_2D, textureFBO);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
     
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureFBO, 0);
 
@@ -200,7 +201,7 @@ int main()
 		std::cout << "Failed to create Framebuffer" << std::endl;
         return -1;
 	}
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Uniform Buffers
 	// ------------------------------------
@@ -251,14 +252,14 @@ int main()
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         
         // matrixes
         glm::mat4 view = camera.getViewMatrix();
@@ -299,7 +300,7 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteFramebuffers(1, &fbo);
+    GLState::deleteFramebuffers(1, &fbo);
 
     glfwTerminate();
 
@@ -348,7 +349,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -0,0 +1,83 @@
+#version 460 core
+
+// One invocation per rock: frustum and distance test of its bounding sphere, the visible rocks are compacted
+// into visibleMatrices and counted in the instanceCount of the first indirect draw command
+layout (local_size_x = 256) in;
+
+struct RockInstance
+{
+    vec4 positionScale;
+    vec4 rotation; // x: angle in radians around rotationAxis
+};
+
+layout (std430, binding = 0) readonly buffer RockInstances
+{
+    RockInstance rocks[];
+};
+
+layout (std430, binding = 1) writeonly buffer VisibleMatrices
+{
+    mat4 visibleMatrices[];
+};
+
+// instanceCount of the first DrawElementsIndirectCommand
+layout (binding = 0, offset = 4) uniform atomic_uint visibleCount;
+
+uniform uint rockCount;
+uniform vec4 frustumPlanes[6];
+uniform vec3 cameraPosition;
+uniform vec2 lodRange; // min and max distance to the camera
+uniform vec4 rockSphere; // bounding sphere of the rock model in its own space
+uniform vec3 rotationAxis; // normalized
+
+// same as glm::rotate
+mat3 getRotationMatrix(vec3 axis, float angle)
+{
+    float c = cos(angle);
+    float s = sin(angle);
+    vec3 temp = (1.0 - c) * axis;
+    return mat3(
+        c + temp.x * axis.x, temp.x * axis.y + s * axis.z, temp.x * axis.z - s * axis.y,
+        temp.y * axis.x - s * axis.z, c + temp.y * axis.y, temp.y * axis.z + s * axis.x,
+        temp.z * axis.x + s * axis.y, temp.z * axis.y - s * axis.x, c + temp.z * axis.z
+    );
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= rockCount)
+    {
+        return;
+    }
+
+    RockInstance rock = rocks[index];
+    vec3 position = rock.positionScale.xyz;
+    float scale = rock.positionScale.w;
+    mat3 rotation = getRotationMatrix(rotationAxis, rock.rotation.x);
+
+    // model = translate * scale * rotate
+    vec3 center = position + scale * (rotation * rockSphere.xyz);
+    float radius = scale * rockSphere.w;
+
+    float distanceToCamera = distance(center, cameraPosition);
+    if (distanceToCamera + radius < lodRange.x || distanceToCamera - radius > lodRange.y)
+    {
+        return;
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+        {
+            return;
+        }
+    }
+
+    uint slot = atomicCounterIncrement(visibleCount);
+    visibleMatrices[slot] = mat4(
+        vec4(rotation[0] * scale, 0.0),
+        vec4(rotation[1] * scale, 0.0),
+        vec4(rotation[2] * scale, 0.0),
+        vec4(position, 1.0)
+    );
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 ﻿// Advanced OpenGL: Instancing
 // https://learnopengl.com/Advanced-OpenGL/Instancing
 // Quicker version of the planet visualization with instancing
+// The rocks are culled on the GPU by a compute shader and drawn with glDrawElementsIndirect.
+// Options: --rocks <count>, --lod-distance <max distance>, --cpu-culling, --no-culling, --no-mesh-optimization, --no-vertex-packing
 #include <array>
 #include <algorithm>
 #include <filesystem>
@@ -19,8 +21,12 @@
 #include "glm/gtc/type_ptr.hpp"
 #include "stb_image.h"
 
+#include "bounds.h"
 #include "camera.h"
+#include "computeShader.h"
 #include "fpsCounter.h"
+#include "frustum.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -53,6 +59,25 @@ glm::vec3 pointLightPositions[] = {
     glm::vec3(0.0f,  0.0f, -3.0f)
 };
 
+// Rocks
+enum class RockCulling { NONE, CPU, GPU };
+
+// Read by the culling compute shader (std430), the matrix is only built for the visible rocks
+struct RockInstance {
+    glm::vec4 positionScale;
+    glm::vec4 rotation; // x: angle in radians around ROCK_ROTATION_AXIS
+};
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+const glm::vec3 ROCK_ROTATION_AXIS(0.4f, 0.6f, 0.8f);
+
 // MISC
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos);
@@ -63,7 +88,7 @@ void processInput(GLFWwindow* window);
 Mesh createQuad();
 void setShaderLights(Shader& shader);
 
-int main()
+int main(int argc, char* argv[])
 {
     // Init Path
     PathManager::projectPath = std::filesystem::current_path().string() + "/";
@@ -80,11 +105,53 @@ int main()
     const std::string PATH_FRAGMENT_SHADER = PATH_EXAMPLE + "basicFragment.glsl";
     const std::string PATH_UNLIT_VERTEX_SHADER = PATH_EXAMPLE + "unlitVertex.glsl";
     const std::string PATH_UNLIT_INSTANCED_VERTEX_SHADER = PATH_EXAMPLE + "unlitInstancedVertex.glsl";
+    const std::string PATH_UNLIT_INSTANCED_PACKED_VERTEX_SHADER = PATH_EXAMPLE + "unlitInstancedPackedVertex.glsl";
     const std::string PATH_UNLIT_FRAGMENT_SHADER = PATH_EXAMPLE + "unlitFragment.glsl";
+    const std::string PATH_CULL_ROCKS_COMPUTE_SHADER = PATH_EXAMPLE + "cullRocksCompute.glsl";
 
 	const std::string PATH_MODEL_PLANET = PathManager::getModelsPath() + "planet/planet.obj";
 	const std::string PATH_MODEL_ROCK = PathManager::getModelsPath() + "rock/rock.obj";
 
+    ModelLoadOptions modelLoadOptions;
+    modelLoadOptions.optimizeMeshes = true;
+    bool packRockVertices = true;
+    RockCulling rockCulling = RockCulling::GPU;
+    unsigned int amountRocks = 150000;
+    float rockLODDistance = 0.0f;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--rocks" && hasValue)
+        {
+            amountRocks = static_cast<unsigned int>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--lod-distance" && hasValue)
+        {
+            rockLODDistance = std::stof(argv[++i]);
+        }
+        else if (arg == "--cpu-culling")
+        {
+            rockCulling = RockCulling::CPU;
+        }
+        else if (arg == "--no-mesh-optimization")
+        {
+            modelLoadOptions.optimizeMeshes = false;
+        }
+        else if (arg == "--no-vertex-packing")
+        {
+            packRockVertices = false;
+        }
+        else if (arg == "--no-culling")
+        {
+            rockCulling = RockCulling::NONE;
+        }
+    }
+    std::cout << "Mesh optimization: " << (modelLoadOptions.optimizeMeshes ? "on" : "off") << std::endl;
+    std::cout << "Rock vertex packing: " << (packRockVertices ? "on" : "off") << std::endl;
+    const char* rockCullingNames[] = { "off", "CPU", "GPU" };
+    std::cout << "Rock culling: " << rockCullingNames[static_cast<int>(rockCulling)] << std::endl;
+
     // INIT GLFW
     // ------------------------------------
     glfwInit();
@@ -116,7 +183,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -134,11 +201,19 @@ int main()
 	Camera camera(cameraPos, cameraFront, cameraUp, cameraRollYawPitch, cameraFOV, cameraNearPlane, cameraFarPlane);
 	pCamera = &camera;
 
+    // the rocks further than this are not drawn, by default only the far plane limits them
+    if (rockLODDistance <= 0.0f)
+    {
+        rockLODDistance = cameraFarPlane;
+    }
+    const glm::vec2 rockLODRange(0.0f, rockLODDistance);
+
     // SHADERS
     // ------------------------------------
     Shader shader(PATH_VERTEX_SHADER, PATH_FRAGMENT_SHADER);
     Shader unlitShader(PATH_UNLIT_VERTEX_SHADER, PATH_UNLIT_FRAGMENT_SHADER);
-	Shader instancedUnlitShader(PATH_UNLIT_INSTANCED_VERTEX_SHADER, PATH_UNLIT_FRAGMENT_SHADER);
+	Shader instancedUnlitShader(packRockVertices ? PATH_UNLIT_INSTANCED_PACKED_VERTEX_SHADER : PATH_UNLIT_INSTANCED_VERTEX_SHADER, PATH_UNLIT_FRAGMENT_SHADER);
+    ComputeShader cullRocksShader(PATH_CULL_ROCKS_COMPUTE_SHADER);
 
     // TEXTURES
 	// ------------------------------------
@@ -159,7 +234,7 @@ int main()
     unsigned int VAOpoints, VBOpoints;
     glGenVertexArrays(1, &VAOpoints);
     glGenBuffers(1, &VBOpoints);
-	glBindVertexArray(VAOpoints);
+	GLState::bindVertexArray(VAOpoints);
 	glBindBuffer(GL_ARRAY_BUFFER, VBOpoints);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(points), points, GL_STATIC_DRAW);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*) 0);
@@ -167,22 +242,22 @@ int main()
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*) (2 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 
     // FBO
 	// ------------------------------------
     unsigned int fbo;
 	glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
 
     // Attachment Color Buffer
     unsigned int textureFBO;
     glGenTextures(1, &textureFBO);
-    glBindTexture(GL_TEXTURE_2D, textureFBO);
+    GLState::bindTexture(GL_TEXTURE_2D, textureFBO);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
     
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureFBO, 0);
 
@@ -200,7 +275,7 @@ int main()
 		std::cout << "Failed to create Framebuffer" << std::endl;
         return -1;
 	}
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Uniform Buffers
 	// ------------------------------------
@@ -225,11 +300,20 @@ int main()
 
     // Models and Meshes
 	// ------------------------------------
-    Model planetModel(PATH_MODEL_PLANET);
-	Model rockModel(PATH_MODEL_ROCK);
+    ModelLoadOptions rockLoadOptions = modelLoadOptions;
+    rockLoadOptions.packVertices = packRockVertices;
+    Model planetModel(PATH_MODEL_PLANET, modelLoadOptions);
+	Model rockModel(PATH_MODEL_ROCK, rockLoadOptions);
 
-    unsigned int amountRocks = 150000;
-    glm::mat4* modelMatrices = new glm::mat4[amountRocks];
+    size_t rockGPUSize = 0;
+    for (const Mesh& mesh : rockModel.meshes)
+    {
+        rockGPUSize += mesh.getGPUSize();
+    }
+    std::cout << "Rock vertex and index buffers: " << rockGPUSize / 1024.0 << " KB" << std::endl;
+
+    std::vector<RockInstance> rockInstances(amountRocks);
+    std::vector<glm::mat4> modelMatrices(amountRocks);
 
     srand(0); // initialize random seed	
     float radius = 200.0;
@@ -253,22 +337,89 @@ int main()
 
         // 3. rotation: add random rotation around a (semi)randomly picked rotation axis vector
         float rotAngle = static_cast<float>(rand() % 360);
-        model = glm::rotate(model, rotAngle, glm::vec3(0.4f, 0.6f, 0.8f));
+        model = glm::rotate(model, rotAngle, ROCK_ROTATION_AXIS);
 
         // 4. now add to list of matrices
         modelMatrices[i] = model;
+        rockInstances[i] = RockInstance{ glm::vec4(x, y, z, scale), glm::vec4(rotAngle, 0.0f, 0.0f, 0.0f) };
+    }
+
+    const BoundingSphere rockSphere = rockModel.getBoundingSphere();
+    // CPU culling: world space bounding spheres of the rocks, culled each frame to only upload the visible matrices
+    BoundingSphereBatch rockSpheres;
+    std::vector<unsigned int> visibleRocks;
+    std::vector<glm::mat4> visibleRockMatrices;
+    if (rockCulling == RockCulling::CPU)
+    {
+        rockSpheres.reserve(amountRocks);
+        for (unsigned int i = 0; i < amountRocks; i++)
+        {
+            rockSpheres.add(rockSphere.transform(modelMatrices[i]));
+        }
+        visibleRockMatrices.reserve(amountRocks);
     }
 
-    // VBO
+    // GPU culling: the compute shader writes the visible matrices and their count, which is the instanceCount of the indirect draws,
+    // nothing is read back except the count for the stats
+    unsigned int rockInstanceBuffer = 0;
+    unsigned int rockCommandBuffer = 0;
+    const size_t instanceCountOffset = offsetof(DrawElementsIndirectCommand, instanceCount);
+    // uniforms set every frame
+    UniformHandle frustumPlaneHandles[Frustum::PLANE_COUNT];
+    UniformHandle cameraPositionHandle;
+    if (rockCulling == RockCulling::GPU)
+    {
+        for (int i = 0; i < Frustum::PLANE_COUNT; i++)
+        {
+            frustumPlaneHandles[i] = cullRocksShader.getUniformHandle("frustumPlanes[" + std::to_string(i) + "]");
+        }
+        cameraPositionHandle = cullRocksShader.getUniformHandle("cameraPosition");
+
+        glGenBuffers(1, &rockInstanceBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, rockInstanceBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, rockInstances.size() * sizeof(RockInstance), rockInstances.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        std::vector<DrawElementsIndirectCommand> rockCommands;
+        for (const Mesh& mesh : rockModel.meshes)
+        {
+            rockCommands.push_back(DrawElementsIndirectCommand{ static_cast<GLuint>(mesh.indices.size()), 0, 0, 0, 0 });
+        }
+        glGenBuffers(1, &rockCommandBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, rockCommandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, rockCommands.size() * sizeof(DrawElementsIndirectCommand), rockCommands.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        cullRocksShader.use();
+        cullRocksShader.setUInt("rockCount", amountRocks);
+        cullRocksShader.setVec2("lodRange", rockLODRange);
+        cullRocksShader.setVec4("rockSphere", glm::vec4(rockSphere.center, rockSphere.radius));
+        cullRocksShader.setVec3("rotationAxis", glm::normalize(ROCK_ROTATION_AXIS));
+    }
+    std::vector<RockInstance>().swap(rockInstances);
+
+    // VBO, holds the matrices of the visible rocks when they are culled, written by the compute shader in GPU mode
     unsigned int VBORocks;
     glGenBuffers(1, &VBORocks);
     glBindBuffer(GL_ARRAY_BUFFER, VBORocks);
-	glBufferData(GL_ARRAY_BUFFER, amountRocks * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
+    if (rockCulling == RockCulling::NONE)
+    {
+        glBufferData(GL_ARRAY_BUFFER, amountRocks * sizeof(glm::mat4), modelMatrices.data(), GL_STATIC_DRAW);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, amountRocks * sizeof(glm::mat4), nullptr, rockCulling == RockCulling::GPU ? GL_DYNAMIC_COPY : GL_DYNAMIC_DRAW);
+    }
+    // the model matrices are kept on the CPU only for the CPU culling
+    if (rockCulling != RockCulling::CPU)
+    {
+        std::vector<glm::mat4>().swap(modelMatrices);
+    }
 
     for (unsigned int i = 0; i < rockModel.meshes.size(); i++)
     {
 		unsigned int VAO = rockModel.meshes[i].VAO;
-		glBindVertexArray(VAO);
+		GLState::bindVertexArray(VAO);
 		long long vec4Size = static_cast<long long>(sizeof(glm::vec4));
 		glEnableVertexAttribArray(3);
 		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)0);
@@ -283,7 +434,14 @@ int main()
 		glVertexAttribDivisor(5, 1);
 		glVertexAttribDivisor(6, 1);
     }
-	glBindVertexArray(0);
+	GLState::bindVertexArray(0);
+
+    // GPU time of the culling pass, the queries are read a few frames later to not stall
+    const unsigned int NB_CULLING_QUERIES = 4;
+    unsigned int cullingQueries[NB_CULLING_QUERIES];
+    glGenQueries(NB_CULLING_QUERIES, cullingQueries);
+    bool isCullingQueryUsed[NB_CULLING_QUERIES] = {};
+    double cullingGPUTimeMs = 0.0;
 
 
     // Render Loop
@@ -291,6 +449,7 @@ int main()
 	lastFrameTime = static_cast<float>(glfwGetTime());
     FPSCounter fpsCounter(1.0f);
     unsigned int frameCount = 0;
+    unsigned int amountVisibleRocks = amountRocks;
 
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     while (!glfwWindowShouldClose(window))
@@ -302,6 +461,7 @@ int main()
 		if (frameCount % 60 == 0)
 		{
 			fpsCounter.showFPS();
+			std::cout << "Visible rocks: " << amountVisibleRocks << " / " << amountRocks << std::endl;
 		}
         // input
         processInput(window);
@@ -311,16 +471,16 @@ int main()
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         
         // matrixes
         glm::mat4 view = camera.getViewMatrix();
@@ -331,23 +491,95 @@ int main()
 		glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(view));
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+        if (rockCulling == RockCulling::CPU)
+        {
+            camera.getFrustum(WINDOW_WIDTH, WINDOW_HEIGHT).cullSpheres(rockSpheres, visibleRocks);
+            visibleRockMatrices.clear();
+            for (const unsigned int rockIndex : visibleRocks)
+            {
+                visibleRockMatrices.push_back(modelMatrices[rockIndex]);
+            }
+            amountVisibleRocks = static_cast<unsigned int>(visibleRockMatrices.size());
+            glBindBuffer(GL_ARRAY_BUFFER, VBORocks);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, visibleRockMatrices.size() * sizeof(glm::mat4), visibleRockMatrices.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        else if (rockCulling == RockCulling::GPU)
+        {
+            const unsigned int queryIndex = frameCount % NB_CULLING_QUERIES;
+            if (isCullingQueryUsed[queryIndex])
+            {
+                GLuint64 elapsedTime = 0;
+                glGetQueryObjectui64v(cullingQueries[queryIndex], GL_QUERY_RESULT, &elapsedTime);
+                cullingGPUTimeMs = elapsedTime / 1000000.0;
+            }
+            glBeginQuery(GL_TIME_ELAPSED, cullingQueries[queryIndex]);
+
+            // reset the visible count, which is the instanceCount of the first command
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, rockCommandBuffer);
+            glClearBufferSubData(GL_DRAW_INDIRECT_BUFFER, GL_R32UI, instanceCountOffset, sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+            const Frustum frustum = camera.getFrustum(WINDOW_WIDTH, WINDOW_HEIGHT);
+            cullRocksShader.use();
+            for (int i = 0; i < Frustum::PLANE_COUNT; i++)
+            {
+                cullRocksShader.setVec4(frustumPlaneHandles[i], frustum.getPlane(static_cast<Frustum::Plane>(i)));
+            }
+            cullRocksShader.setVec3(cameraPositionHandle, camera.GetPosition());
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rockInstanceBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, VBORocks);
+            glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, rockCommandBuffer);
+            cullRocksShader.dispatch((amountRocks + 255) / 256);
+            glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+            // the other meshes of the rock draw the same instances
+            glBindBuffer(GL_COPY_READ_BUFFER, rockCommandBuffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, rockCommandBuffer);
+            for (size_t i = 1; i < rockModel.meshes.size(); i++)
+            {
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, instanceCountOffset,
+                    i * sizeof(DrawElementsIndirectCommand) + instanceCountOffset, sizeof(GLuint));
+            }
+            glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+            glEndQuery(GL_TIME_ELAPSED);
+            isCullingQueryUsed[queryIndex] = true;
+
+            // only read back for the stats, it waits for the culling to finish
+            if (frameCount % 60 == 0)
+            {
+                glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, instanceCountOffset, sizeof(GLuint), &amountVisibleRocks);
+                std::cout << "GPU culling: " << cullingGPUTimeMs << " ms" << std::endl;
+            }
+        }
+
         // Draw scene
 		// ------------------------------------
 
 		// Use shader program
 
         instancedUnlitShader.use();
-		for (const auto& mesh: rockModel.meshes)
+		for (size_t i = 0; i < rockModel.meshes.size(); i++)
 		{
-			glBindVertexArray(mesh.VAO);
-			glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(mesh.indices.size()), GL_UNSIGNED_INT, 0, amountRocks);
+			const Mesh& mesh = rockModel.meshes[i];
+			mesh.setDequantizationUniforms(instancedUnlitShader);
+			GLState::bindVertexArray(mesh.VAO);
+			if (rockCulling == RockCulling::GPU)
+			{
+				glDrawElementsIndirect(GL_TRIANGLES, mesh.getIndexType(), (void*)(i * sizeof(DrawElementsIndirectCommand)));
+			}
+			else
+			{
+				glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(mesh.indices.size()), mesh.getIndexType(), 0, amountVisibleRocks);
+			}
 		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 
         glm::mat4 model(1.0f);
 		model = glm::scale(model, glm::vec3(2.0f));
         unlitShader.use();
         unlitShader.setMat4("model", value_ptr(model));
-        planetModel.draw(unlitShader);
+        planetModel.draw(unlitShader, Frustum(projection * view * model));
 
         // check and call events and swap the buffers
         glfwSwapBuffers(window);
@@ -358,7 +590,11 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteFramebuffers(1, &fbo);
+    GLState::deleteFramebuffers(1, &fbo);
+    glDeleteQueries(NB_CULLING_QUERIES, cullingQueries);
+    glDeleteBuffers(1, &VBORocks);
+    glDeleteBuffers(1, &rockInstanceBuffer);
+    glDeleteBuffers(1, &rockCommandBuffer);
 
     glfwTerminate();
 
@@ -407,7 +643,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
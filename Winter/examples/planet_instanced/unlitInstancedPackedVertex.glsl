@@ -0,0 +1,25 @@
+#version 330 core
+  
+// VertexFormat::PACKED, see vertexLayout.h
+layout (location = 0) in vec3 aPackedPos; // unsigned normalized, relative to the AABB of the mesh
+layout (location = 1) in vec2 aPackedNormal; // signed normalized, octahedral encoding
+layout (location = 2) in vec2 aTexCoords; // half floats, read as floats
+layout (location = 3) in mat4 instanceMatrix;
+
+out vec2 TexCoords;
+
+layout (std140) uniform Matrices
+{
+	uniform mat4 projection;
+	uniform mat4 view;
+};
+
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+void main()
+{
+   vec3 aPos = aPackedPos * positionScale + positionOffset;
+   gl_Position = projection * view * instanceMatrix * vec4(aPos, 1.0);
+   TexCoords = aTexCoords;
+}
@@ -17,6 +17,7 @@
 #include "stb_image.h"
 
 #include "camera.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -128,7 +129,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -172,16 +173,16 @@ int main()
 	// ------------------------------------
     unsigned int fbo;
 	glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
 
     // Attachment Color Buffer
     unsigned int textureFBO;
     glGenTextures(1, &textureFBO);
-    glBindTexture(GL_TEXTURE_2D, textureFBO);
+    GLState::bindTexture(GL_TEXTURE_2D, textureFBO);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
     
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureFBO, 0);
 
@@ -199,7 +200,7 @@ int main()
 		std::cout << "Failed to create Framebuffer" << std::endl;
         return -1;
 	}
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
 
     // Light
@@ -241,16 +242,16 @@ int main()
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         
         // matrixes
         glm::mat4 view = camera.getViewMatrix();
@@ -273,10 +274,10 @@ int main()
         shader.setFloat("material.shininess", shininessMat);
 
         // Draw cubes
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, container2Texture);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, container2Specular);
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_2D, container2Texture);
+		GLState::activeTexture(GL_TEXTURE1);
+		GLState::bindTexture(GL_TEXTURE_2D, container2Specular);
         for (unsigned int i = 0; i < 10; i++)
         {
             float angle = 20.0f * i + 20.0f * static_cast<float>(glfwGetTime());
@@ -310,8 +311,8 @@ int main()
         reflectiveShader.setMat4("view", value_ptr(view));
         reflectiveShader.setMat4("projection", value_ptr(projection));
         reflectiveShader.setVec3("viewPos", camera.GetPosition());
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
 		reflectiveShader.setInt("skybox", 0);
 		cubeModel.draw(reflectiveShader);
 
@@ -321,13 +322,13 @@ int main()
         skyboxShader.setMat4("view", value_ptr(viewNoTranslation));
         skyboxShader.setMat4("projection", value_ptr(projection));
 
-		glDepthFunc(GL_LEQUAL);
-        glCullFace(GL_FRONT);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
+		GLState::depthFunc(GL_LEQUAL);
+        GLState::cullFace(GL_FRONT);
+        GLState::activeTexture(GL_TEXTURE2);
+        GLState::bindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
         cubeModel.draw(skyboxShader);
-        glDepthMask(GL_TRUE);
-        glCullFace(GL_BACK);
+        GLState::depthMask(GL_TRUE);
+        GLState::cullFace(GL_BACK);
 
         // check and call events and swap the buffers
         glfwSwapBuffers(window);
@@ -336,9 +337,9 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteTextures(1, &container2Texture);
-    glDeleteTextures(1, &container2Specular);
-    glDeleteFramebuffers(1, &fbo);
+    GLState::deleteTextures(1, &container2Texture);
+    GLState::deleteTextures(1, &container2Specular);
+    GLState::deleteFramebuffers(1, &fbo);
 
     glfwTerminate();
 
@@ -387,7 +388,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
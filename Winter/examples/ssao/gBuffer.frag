@@ -4,6 +4,8 @@ struct Material {
     sampler2D texture_specular0;
 };
 
+// With the compact layout, gPosition is not drawn (the position is rebuilt from the depth buffer)
+// and gNormal is written to a RG16 attachment, octahedral-encoded
 layout (location = 0) out vec3 gPosition;
 layout (location = 1) out vec3 gNormal;
 layout (location = 2) out vec4 gAlbedoSpec;
@@ -13,15 +15,30 @@ in vec3 Normal;
 in vec2 TexCoords;
 
 uniform Material material;
+uniform bool compactGBuffer;
+
+vec2 signNotZero(vec2 v)
+{
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// unit vector to [0, 1]^2: projected on the octahedron |x| + |y| + |z| = 1, whose lower half is folded over the upper one
+vec2 encodeOctahedral(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 encoded = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    return encoded * 0.5 + 0.5;
+}
 
 void main()
 {    
     // store the fragment position vector in the first gbuffer texture
     gPosition = FragPos;
     // also store the per-fragment normals into the gbuffer
-    gNormal = normalize(Normal);
+    vec3 normal = normalize(Normal);
+    gNormal = compactGBuffer ? vec3(encodeOctahedral(normal), 0.0) : normal;
     // and the diffuse per-fragment color
     gAlbedoSpec.rgb = texture(material.texture_diffuse0, TexCoords).rgb;
     // store specular intensity in gAlbedoSpec's alpha component
     gAlbedoSpec.a = texture(material.texture_specular0, TexCoords).r;
-}  
\ No newline at end of file
+}  
@@ -7,6 +7,9 @@ uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
 uniform sampler2D ssao;
+uniform bool compactGBuffer;
+uniform sampler2D gDepth; // compact layout
+uniform mat4 inverseProjection;
 
 struct Light {
     vec3 Position;
@@ -19,11 +22,45 @@ struct Light {
 const int NR_LIGHTS = 8;
 uniform Light lights[NR_LIGHTS];
 
+vec2 signNotZero(vec2 v)
+{
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// inverse of the encoding of gBuffer.frag
+vec3 decodeOctahedral(vec2 encoded)
+{
+    encoded = encoded * 2.0 - 1.0;
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (n.z < 0.0)
+    {
+        n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    }
+    return normalize(n);
+}
+
+// view space position of the surface under a texel of the G-buffer
+vec3 getViewPosition(vec2 uv)
+{
+    if (!compactGBuffer)
+    {
+        return texture(gPosition, uv).xyz;
+    }
+    vec4 ndc = vec4(vec3(uv, texture(gDepth, uv).r) * 2.0 - 1.0, 1.0);
+    vec4 viewPosition = inverseProjection * ndc;
+    return viewPosition.xyz / viewPosition.w;
+}
+
+vec3 getViewNormal(vec2 uv)
+{
+    return compactGBuffer ? decodeOctahedral(texture(gNormal, uv).rg) : normalize(texture(gNormal, uv).rgb);
+}
+
 void main()
 {             
     // retrieve data from G-buffer
-    vec3 FragPos = texture(gPosition, TexCoords).rgb;
-    vec3 Normal = texture(gNormal, TexCoords).rgb;
+    vec3 FragPos = getViewPosition(TexCoords);
+    vec3 Normal = getViewNormal(TexCoords);
     vec3 Albedo = texture(gAlbedoSpec, TexCoords).rgb;
     float AmbientOcclusion = texture(ssao, TexCoords).r;
     float Specular = texture(gAlbedoSpec, TexCoords).a;
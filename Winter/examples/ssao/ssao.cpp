@@ -1,9 +1,17 @@
 ﻿// Advanced Lighting: SSAO (Screen Space Ambient Occlusion)
 // https://learnopengl.com/Advanced-Lighting/SSAO
+// Options: --gbuffer full|compact, --ssao full|high|medium|low, --ssao-radius <view space radius>, --benchmark (GPU time of the SSAO tiers)
+// - full: view space position and normal in RGBA16F, albedo and specular in RGBA8
+// - compact (default): the position is rebuilt from the depth buffer, the normal is octahedral-encoded in RG16
+// The SSAO is evaluated at the resolution of its tier on a linear depth copy of the G-buffer,
+// then blurred and upsampled to full resolution by a depth-aware (bilateral) filter.
 #include <array>
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <numeric>
@@ -21,8 +29,10 @@
 
 #include "camera.h"
 #include "fpsCounter.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
+#include "profiler.h"
 #include "shader.h"
 #include "texture.h"
 
@@ -67,11 +77,40 @@ void scrollCallback(GLFWwindow* window, double xOffset, double yOffset);
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
 
+enum class GBufferLayout {
+	FULL,
+	COMPACT
+};
+
+// SSAO quality tiers, the first one is the full resolution 64 samples reference
+struct SSAOTier {
+	const char* name;
+	unsigned int resolutionDivisor;
+	int kernelSize; // divides SSAO_KERNEL_SIZE
+};
+
+const int SSAO_KERNEL_SIZE = 64;
+// view space radius of the kernel
+const float DEFAULT_SSAO_RADIUS = 0.5f;
+const SSAOTier SSAO_TIERS[] = {
+	{ "full", 1, 64 },
+	{ "high", 2, 32 },
+	{ "medium", 2, 16 },
+	{ "low", 4, 16 }
+};
+
+// Benchmark: each tier is drawn in turn
+const unsigned int BENCHMARK_WARMUP_FRAMES = 30;
+const unsigned int BENCHMARK_FRAMES = 120;
+
 Mesh createQuad();
+unsigned int createGBufferTexture(GLint internalFormat, GLenum format, GLenum type, int32_t width, int32_t height);
+// Reallocates the linear depth and occlusion targets at the resolution of the tier
+void resizeSSAOTargets(const SSAOTier& tier, unsigned int ssaoDepthBuffer, unsigned int ssaoColorBuffer, int32_t width, int32_t height);
 void setShaderLights(Shader& shader);
 void renderQuad();
 
-int main()
+int main(int argc, char* argv[])
 {
     // Init Path
     PathManager::projectPath = std::filesystem::current_path().string() + "/";
@@ -82,6 +121,51 @@ int main()
     const int32_t WINDOW_HEIGHT = 600;
     const std::string WINDOW_TITLE = "LearnOpenGL";
 
+    GBufferLayout gBufferLayout = GBufferLayout::COMPACT;
+    unsigned int ssaoTierIndex = 1;
+    float ssaoRadius = DEFAULT_SSAO_RADIUS;
+    bool isBenchmark = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--gbuffer" && i + 1 < argc)
+        {
+            gBufferLayout = std::string(argv[++i]) == "full" ? GBufferLayout::FULL : GBufferLayout::COMPACT;
+        }
+        else if (argument == "--ssao" && i + 1 < argc)
+        {
+            const std::string tierName = argv[++i];
+            const auto tier = std::find_if(std::begin(SSAO_TIERS), std::end(SSAO_TIERS), [&tierName](const SSAOTier& tier) { return tierName == tier.name; });
+            if (tier == std::end(SSAO_TIERS))
+            {
+                std::cout << "ERROR::SSAO: Unknown tier " << tierName << std::endl;
+            }
+            else
+            {
+                ssaoTierIndex = static_cast<unsigned int>(tier - std::begin(SSAO_TIERS));
+            }
+        }
+        else if (argument == "--ssao-radius" && i + 1 < argc)
+        {
+            const char* radiusText = argv[++i];
+            char* end = nullptr;
+            const float radius = std::strtof(radiusText, &end);
+            if (end == radiusText || *end != '\0' || !std::isfinite(radius) || radius <= 0.0f)
+            {
+                std::cout << "ERROR::SSAO: Invalid radius " << radiusText << ", using " << DEFAULT_SSAO_RADIUS << std::endl;
+            }
+            else
+            {
+                ssaoRadius = radius;
+            }
+        }
+        else if (argument == "--benchmark")
+        {
+            isBenchmark = true;
+        }
+    }
+    const bool isCompactGBuffer = gBufferLayout == GBufferLayout::COMPACT;
+
 	const std::string PATH_EXAMPLE = PathManager::getProjectPath() + "examples/ssao/";
 
 	const std::string PATH_VERTEX_SHADER = PATH_EXAMPLE + "basic.vert";
@@ -96,6 +180,7 @@ int main()
 	const std::string PATH_LIGHTING_PASS_FRAGMENT_SHADER = PATH_EXAMPLE + "lightingPass.frag";
 	const std::string PATH_SSAO_FRAGMENT_SHADER = PATH_EXAMPLE + "ssao.frag";
 	const std::string PATH_SSAO_BLUR_FRAGMENT_SHADER = PATH_EXAMPLE + "ssaoBlur.frag";
+	const std::string PATH_SSAO_DEPTH_FRAGMENT_SHADER = PATH_EXAMPLE + "ssaoDepth.frag";
 
     const std::string PATH_TEXTURE_CONTAINER2 = PathManager::getTexturesPath() + "container2.png";
     const std::string PATH_TEXTURE_CONTAINER2_SPECULAR = PathManager::getTexturesPath() + "container2_specular.png";
@@ -110,7 +195,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    // For easy MSAA Don't forget to call: glEnable(GL_MULTISAMPLE);
+    // For easy MSAA Don't forget to call: GLState::enable(GL_MULTISAMPLE);
 	// ------------------------------------
 	glfwWindowHint(GLFW_SAMPLES, 4);
 	// ------------------------------------
@@ -139,7 +224,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -166,6 +251,7 @@ int main()
 	Shader lightingPassShader(PATH_LIGHTING_PASS_VERTEX_SHADER, PATH_LIGHTING_PASS_FRAGMENT_SHADER);
 	Shader ssaoShader(PATH_SCREEN_VERTEX_SHADER, PATH_SSAO_FRAGMENT_SHADER);
 	Shader ssaoBlurShader(PATH_SCREEN_VERTEX_SHADER, PATH_SSAO_BLUR_FRAGMENT_SHADER);
+	Shader ssaoDepthShader(PATH_SCREEN_VERTEX_SHADER, PATH_SSAO_DEPTH_FRAGMENT_SHADER);
 
     // TEXTURES
 	// ------------------------------------
@@ -183,54 +269,56 @@ int main()
 	// ------------------------------------
     unsigned int gBuffer;
     glGenFramebuffers(1, &gBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-    unsigned int gPosition;
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+    // the position and normal are in view space
+    unsigned int gPosition = 0;
     unsigned int gNormal;
     unsigned int gAlbedoSpec;
+    unsigned int gDepth;
 
-    // - position color buffer
-    glGenTextures(1, &gPosition);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-
-    // - normal color buffer
-    glGenTextures(1, &gNormal);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
+    if (isCompactGBuffer)
+    {
+        // - normal, octahedral-encoded in [0, 1]^2
+        gNormal = createGBufferTexture(GL_RG16, GL_RG, GL_UNSIGNED_SHORT, WINDOW_WIDTH, WINDOW_HEIGHT);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
+    }
+    else
+    {
+        // - position color buffer
+        gPosition = createGBufferTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT, WINDOW_WIDTH, WINDOW_HEIGHT);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
+
+        // - normal color buffer
+        gNormal = createGBufferTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT, WINDOW_WIDTH, WINDOW_HEIGHT);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
+    }
 
     // - color + specular color buffer
-    glGenTextures(1, &gAlbedoSpec);
-    glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gAlbedoSpec = createGBufferTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, WINDOW_WIDTH, WINDOW_HEIGHT);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedoSpec, 0);
 
     // - tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
-    unsigned int colorAttachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    // the compact layout has no position, the first output of gBuffer.frag is dropped
+    unsigned int colorAttachments[3] = { isCompactGBuffer ? GL_NONE : GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
     glDrawBuffers(3, colorAttachments);
 
-	// - create and attach depth buffer (renderbuffer)
-	unsigned int rboDepth;
-	glGenRenderbuffers(1, &rboDepth);
-	glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, WINDOW_WIDTH, WINDOW_HEIGHT);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
+	// - create and attach depth buffer, a texture for the position to be rebuilt from it
+	gDepth = createGBufferTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, WINDOW_WIDTH, WINDOW_HEIGHT);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gDepth, 0);
+
+	// - bytes written and read per pixel, GL_DEPTH_COMPONENT24 being stored in 4 bytes
+	const unsigned int fullGBufferBytes = 8 + 8 + 4 + 4;
+	const unsigned int compactGBufferBytes = 4 + 4 + 4;
+	const unsigned int gBufferBytes = isCompactGBuffer ? compactGBufferBytes : fullGBufferBytes;
+	std::cout << "G-buffer: " << gBufferBytes << " bytes per pixel (full " << fullGBufferBytes << ", compact " << compactGBufferBytes << "), "
+		<< gBufferBytes * WINDOW_WIDTH * WINDOW_HEIGHT / 1024 << " KB" << std::endl;
 
 	// - finally check if framebuffer is complete
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
     {
 		std::cout << "Framebuffer not complete!" << std::endl;
     }
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Uniform Buffers
 	// ------------------------------------
@@ -274,16 +362,22 @@ int main()
 
     // SSAO Kernel generations
 	// ------------------------------------
+    // targets at the resolution of the tier, allocated by resizeSSAOTargets
+    unsigned int ssaoDepthFBO;
+    glGenFramebuffers(1, &ssaoDepthFBO);
+    unsigned int ssaoDepthBuffer = createGBufferTexture(GL_R32F, GL_RED, GL_FLOAT, 1, 1);
     unsigned int ssaoFBO;
     glGenFramebuffers(1, &ssaoFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
+    unsigned int ssaoColorBuffer = createGBufferTexture(GL_R8, GL_RED, GL_FLOAT, 1, 1);
+    resizeSSAOTargets(SSAO_TIERS[ssaoTierIndex], ssaoDepthBuffer, ssaoColorBuffer, WINDOW_WIDTH, WINDOW_HEIGHT);
 
-    unsigned int ssaoColorBuffer;
-    glGenTextures(1, &ssaoColorBuffer);
-    glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RED, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, ssaoDepthFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ssaoDepthBuffer, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "SSAO depth Framebuffer not complete!" << std::endl;
+    }
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ssaoColorBuffer, 0);
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
     {
@@ -293,11 +387,11 @@ int main()
 	// SSAO Blur
 	unsigned int ssaoBlurFBO;
 	glGenFramebuffers(1, &ssaoBlurFBO);
-	glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
 
 	unsigned int ssaoColorBufferBlur;
 	glGenTextures(1, &ssaoColorBufferBlur);
-	glBindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
+	GLState::bindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, WINDOW_WIDTH, WINDOW_HEIGHT, 0, GL_RED, GL_FLOAT, nullptr);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -305,11 +399,11 @@ int main()
 
     std::uniform_real_distribution<float> randomFloats(0.0, 1.0); // random floats between [0.0, 1.0]
     std::default_random_engine generator;
-    unsigned int nbSamples = 64;
-    std::vector<glm::vec3> ssaoKernel;
-    ssaoKernel.reserve(nbSamples);
+    // vec4 for the std140 array of the SSAOKernel block
+    std::vector<glm::vec4> ssaoKernel;
+    ssaoKernel.reserve(SSAO_KERNEL_SIZE);
     // Generate hemispheres
-    for (unsigned int i = 0; i < nbSamples; ++i)
+    for (int i = 0; i < SSAO_KERNEL_SIZE; ++i)
     {
         glm::vec3 sample(
             randomFloats(generator) * 2.0 - 1.0,
@@ -319,13 +413,24 @@ int main()
         sample = glm::normalize(sample);
 		sample *= randomFloats(generator);
         // Generate samples closer to the origin
-		float scale = static_cast<float>(i) / 64.0f;
+		float scale = static_cast<float>(i) / static_cast<float>(SSAO_KERNEL_SIZE);
 		scale = std::lerp(0.1f, 1.0f, scale * scale);
         sample *= scale;
 
-        ssaoKernel.push_back(sample);
+        ssaoKernel.push_back(glm::vec4(sample, 0.0f));
     }
 
+    // the kernel never changes, it is uploaded once
+    unsigned int uboSSAOKernel;
+    glGenBuffers(1, &uboSSAOKernel);
+    glBindBuffer(GL_UNIFORM_BUFFER, uboSSAOKernel);
+    glBufferData(GL_UNIFORM_BUFFER, ssaoKernel.size() * sizeof(glm::vec4), ssaoKernel.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, 1, uboSSAOKernel);
+    unsigned int uboIndexSSAOKernel = glGetUniformBlockIndex(ssaoShader.getID(), "SSAOKernel");
+    glUniformBlockBinding(ssaoShader.getID(), uboIndexSSAOKernel, 1);
+
 	// Noise texture
 	std::vector<glm::vec3> ssaoNoise;
 	for (unsigned int i = 0; i < 16; i++)
@@ -340,14 +445,14 @@ int main()
 
 	unsigned int noiseTexture;
 	glGenTextures(1, &noiseTexture);
-	glBindTexture(GL_TEXTURE_2D, noiseTexture);
+	GLState::bindTexture(GL_TEXTURE_2D, noiseTexture);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, 4, 4, 0, GL_RGB, GL_FLOAT, ssaoNoise.data());
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Models and Meshes
 	// ------------------------------------
@@ -367,6 +472,23 @@ int main()
         mesh.AddTexture(Texture(container2Specular, Texture::SPECULAR_TYPENAME, PATH_TEXTURE_CONTAINER2_SPECULAR));
     }
 
+    // Benchmark state: step i draws SSAO_TIERS[i]
+    const unsigned int benchmarkSteps = isBenchmark ? static_cast<unsigned int>(std::size(SSAO_TIERS)) : 0;
+    const char* const benchmarkPasses[] = { "SSAO depth", "SSAO", "SSAO blur" };
+    PassBenchmark benchmark(std::vector<const char*>(std::begin(benchmarkPasses), std::end(benchmarkPasses)), BENCHMARK_WARMUP_FRAMES, BENCHMARK_FRAMES);
+    if (isBenchmark)
+    {
+        std::cout << "SSAO benchmark, GPU ms per frame over " << BENCHMARK_FRAMES << " frames, " << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << std::endl;
+        std::cout << std::left << std::setw(10) << "Tier" << std::setw(12) << "Resolution" << std::right << std::setw(8) << "Samples"
+            << std::setw(12) << "Depth" << std::setw(12) << "SSAO" << std::setw(12) << "Blur" << std::setw(12) << "Total" << std::endl;
+    }
+    else
+    {
+        const SSAOTier& tier = SSAO_TIERS[ssaoTierIndex];
+        std::cout << "SSAO tier " << tier.name << ": " << WINDOW_WIDTH / tier.resolutionDivisor << "x" << WINDOW_HEIGHT / tier.resolutionDivisor
+            << ", " << tier.kernelSize << " samples, radius " << ssaoRadius << std::endl;
+    }
+
     // Render Loop
     // ------------------------------------
 	lastFrameTime = static_cast<float>(glfwGetTime());
@@ -380,32 +502,63 @@ int main()
 		const float curFrameTime = static_cast<float>(glfwGetTime());
 		deltaTime = curFrameTime - lastFrameTime;
 		fpsCounter.update(curFrameTime);
-		if (frameCount % 60 == 0)
+		if (frameCount % 60 == 0 && !isBenchmark)
 		{
 			fpsCounter.showFPS();
+			Profiler::showStats();
 		}
+        if (isBenchmark)
+        {
+            const PassBenchmark::Event event = benchmark.nextFrame();
+            if (event == PassBenchmark::Event::STEP_STARTED)
+            {
+                ssaoTierIndex = benchmark.getStep();
+                resizeSSAOTargets(SSAO_TIERS[ssaoTierIndex], ssaoDepthBuffer, ssaoColorBuffer, WINDOW_WIDTH, WINDOW_HEIGHT);
+            }
+            else if (event == PassBenchmark::Event::STEP_ENDED)
+            {
+                const SSAOTier& tier = SSAO_TIERS[ssaoTierIndex];
+                const std::string resolution = std::to_string(WINDOW_WIDTH / tier.resolutionDivisor) + "x" + std::to_string(WINDOW_HEIGHT / tier.resolutionDivisor);
+                std::cout << std::left << std::setw(10) << tier.name << std::setw(12) << resolution << std::right << std::setw(8) << tier.kernelSize
+                    << std::fixed << std::setprecision(3);
+                double totalMs = 0.0;
+                for (size_t i = 0; i < std::size(benchmarkPasses); i++)
+                {
+                    const double ms = benchmark.getGPUMs(i);
+                    std::cout << std::setw(12) << ms;
+                    totalMs += ms;
+                }
+                std::cout << std::setw(12) << totalMs << std::defaultfloat << std::endl;
+                if (benchmark.getStep() == benchmarkSteps)
+                {
+                    glfwSetWindowShouldClose(window, true);
+                }
+                continue;
+            }
+        }
         // input
         processInput(window);
 
         // rendering commands
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glEnable(GL_MULTISAMPLE);
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_MULTISAMPLE);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
         // matrixes
 		glm::mat4 model = glm::mat4(1.0f);
         glm::mat4 view = camera.getViewMatrix();
 		glm::mat4 projection = camera.getProjectionMatrix(WINDOW_WIDTH, WINDOW_HEIGHT);
+		glm::mat4 inverseProjection = glm::inverse(projection);
         glm::vec3 viewPos = camera.GetPosition();
 
         glBindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
@@ -426,12 +579,14 @@ int main()
         shader.setFloat("material.shininess", shininessMat);
 
 		// Render to GBuffer
-        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        Profiler::beginScope("Geometry");
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // black as to not leak into gBuffer
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         gBufferShader.use();
+        gBufferShader.setBool("compactGBuffer", isCompactGBuffer);
         gBufferShader.setVec3("viewPos", viewPos);
 		gBufferShader.setVec2("texScale", glm::vec2(1.0f));
 		model = glm::mat4(1.0f);
@@ -498,56 +653,87 @@ int main()
         gBufferShader.setMat4("model", value_ptr(model));
         woodQuad.draw(gBufferShader);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-		// SSAO 
-		glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
-		glClear(GL_COLOR_BUFFER_BIT);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+        Profiler::endScope();
+
+		// SSAO, at the resolution of the tier
+        const SSAOTier& ssaoTier = SSAO_TIERS[ssaoTierIndex];
+        const int32_t ssaoWidth = WINDOW_WIDTH / static_cast<int32_t>(ssaoTier.resolutionDivisor);
+        const int32_t ssaoHeight = WINDOW_HEIGHT / static_cast<int32_t>(ssaoTier.resolutionDivisor);
+        GLState::viewport(0, 0, ssaoWidth, ssaoHeight);
+
+        Profiler::beginScope("SSAO depth");
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, ssaoDepthFBO);
+        ssaoDepthShader.use();
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_2D, gDepth);
+		ssaoDepthShader.setInt("gDepth", 0);
+		ssaoDepthShader.setMat4("inverseProjection", value_ptr(inverseProjection));
+		quad.draw(ssaoDepthShader);
+        Profiler::endScope();
+
+        Profiler::beginScope("SSAO");
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
         ssaoShader.use();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, gPosition);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, gNormal);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, noiseTexture);
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_2D, ssaoDepthBuffer);
+		GLState::activeTexture(GL_TEXTURE1);
+		GLState::bindTexture(GL_TEXTURE_2D, gNormal);
+		GLState::activeTexture(GL_TEXTURE2);
+		GLState::bindTexture(GL_TEXTURE_2D, noiseTexture);
 		ssaoShader.setMat4("projection", value_ptr(projection));
-		ssaoShader.setInt("gPosition", 0);
+		ssaoShader.setBool("compactGBuffer", isCompactGBuffer);
+		ssaoShader.setInt("ssaoDepth", 0);
 		ssaoShader.setInt("gNormal", 1);
 		ssaoShader.setInt("texNoise", 2);
         ssaoShader.setFloat("exponent", 4.0f);
-		for (unsigned int i = 0; i < nbSamples; i++)
-		{
-			ssaoShader.setVec3("samples[" + std::to_string(i) + "]", ssaoKernel[i]);
-		}
+        ssaoShader.setInt("kernelSize", ssaoTier.kernelSize);
+        ssaoShader.setFloat("radius", ssaoRadius);
 		quad.draw(ssaoShader);
+        Profiler::endScope();
 
-		// Blur SSAO
-		glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
-		glClear(GL_COLOR_BUFFER_BIT);
+		// Blur and upsample SSAO
+        GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+        Profiler::beginScope("SSAO blur");
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
 		ssaoBlurShader.use();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
+		GLState::activeTexture(GL_TEXTURE1);
+		GLState::bindTexture(GL_TEXTURE_2D, ssaoDepthBuffer);
+		GLState::activeTexture(GL_TEXTURE2);
+		GLState::bindTexture(GL_TEXTURE_2D, gDepth);
 		ssaoBlurShader.setInt("ssaoInput", 0);
+		ssaoBlurShader.setInt("ssaoDepth", 1);
+		ssaoBlurShader.setInt("gDepth", 2);
+		ssaoBlurShader.setMat4("inverseProjection", value_ptr(inverseProjection));
 		quad.draw(ssaoBlurShader);
+        Profiler::endScope();
 
 
         // Render Scene with lighting pass
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        Profiler::beginScope("Lighting");
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         
         lightingPassShader.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, gPosition);
 		lightingPassShader.setInt("gPosition", 0);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, gNormal);
 		lightingPassShader.setInt("gNormal", 1);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+        GLState::activeTexture(GL_TEXTURE2);
+        GLState::bindTexture(GL_TEXTURE_2D, gAlbedoSpec);
 		lightingPassShader.setInt("gAlbedoSpec", 2);
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
+        GLState::activeTexture(GL_TEXTURE3);
+        GLState::bindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
         lightingPassShader.setInt("ssao", 3);
+        GLState::activeTexture(GL_TEXTURE4);
+        GLState::bindTexture(GL_TEXTURE_2D, gDepth);
+        lightingPassShader.setInt("gDepth", 4);
+        lightingPassShader.setMat4("inverseProjection", value_ptr(inverseProjection));
+        lightingPassShader.setBool("compactGBuffer", isCompactGBuffer);
         // also send light relevant uniforms
 		// Set shader lights
         for (unsigned int i = 0; i < NR_LIGHTS; i++)
@@ -563,19 +749,21 @@ int main()
 			lightingPassShader.setFloat("lights[" + std::to_string(i) + "].Quadratic", quadratic);
         }
         quad.draw(lightingPassShader);
+        Profiler::endScope();
 
 
         // First copy depth buffer
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
+        Profiler::beginScope("Forward");
+		GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
+		GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
 		// Blitting to a buffer with GL_FRAMEBUFFER_SRGB enabled will mess up the depth values, so we disable it
-		glDisable(GL_FRAMEBUFFER_SRGB);
+		GLState::disable(GL_FRAMEBUFFER_SRGB);
 		glBlitFramebuffer(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-		glEnable(GL_FRAMEBUFFER_SRGB);
+		GLState::enable(GL_FRAMEBUFFER_SRGB);
 
         // now render all light cubes with forward rendering as we'd normally do
         // And rendering bleding objects must be done in the forward rendering
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
         
         lightCubeShader.use();
@@ -588,9 +776,11 @@ int main()
             lightCubeShader.setVec3("color", lightColors[i]);
             cube.draw(lightCubeShader);
         }
+        Profiler::endScope();
 
         // check and call events and swap the buffers
         glfwSwapBuffers(window);
+        Profiler::nextFrame();
         glfwPollEvents();
 
         lastFrameTime = curFrameTime;
@@ -598,10 +788,24 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteTextures(1, &container2Texture);
-    glDeleteTextures(1, &container2Specular);
-	glDeleteTextures(1, &woodTexture);
-	glDeleteTextures(1, &woodTextureSpec);
+    GLState::deleteTextures(1, &container2Texture);
+    GLState::deleteTextures(1, &container2Specular);
+	GLState::deleteTextures(1, &woodTexture);
+	GLState::deleteTextures(1, &woodTextureSpec);
+	GLState::deleteTextures(1, &gPosition);
+	GLState::deleteTextures(1, &gNormal);
+	GLState::deleteTextures(1, &gAlbedoSpec);
+	GLState::deleteTextures(1, &gDepth);
+	GLState::deleteTextures(1, &ssaoDepthBuffer);
+	GLState::deleteTextures(1, &ssaoColorBuffer);
+	GLState::deleteTextures(1, &ssaoColorBufferBlur);
+	GLState::deleteTextures(1, &noiseTexture);
+	GLState::deleteFramebuffers(1, &gBuffer);
+	GLState::deleteFramebuffers(1, &ssaoDepthFBO);
+	GLState::deleteFramebuffers(1, &ssaoFBO);
+	GLState::deleteFramebuffers(1, &ssaoBlurFBO);
+	glDeleteBuffers(1, &uboSSAOKernel);
+    Profiler::release();
 
     glfwTerminate();
 
@@ -650,7 +854,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -734,6 +938,31 @@ Mesh createQuad()
     return Mesh(verts, indices, std::vector<Texture>());
 }
 
+unsigned int createGBufferTexture(GLint internalFormat, GLenum format, GLenum type, int32_t width, int32_t height)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    GLState::bindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    // the SSAO samples around the edges of the screen must not wrap to the other side
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+void resizeSSAOTargets(const SSAOTier& tier, unsigned int ssaoDepthBuffer, unsigned int ssaoColorBuffer, int32_t width, int32_t height)
+{
+    const int32_t ssaoWidth = width / static_cast<int32_t>(tier.resolutionDivisor);
+    const int32_t ssaoHeight = height / static_cast<int32_t>(tier.resolutionDivisor);
+    // the framebuffers keep the textures attached through their reallocation
+    GLState::bindTexture(GL_TEXTURE_2D, ssaoDepthBuffer);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, ssaoWidth, ssaoHeight, 0, GL_RED, GL_FLOAT, nullptr);
+    GLState::bindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ssaoWidth, ssaoHeight, 0, GL_RED, GL_FLOAT, nullptr);
+}
+
 
 unsigned int quadVAO = 0;
 unsigned int quadVBO;
@@ -806,7 +1035,7 @@ void renderQuad()
         // configure plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        GLState::bindVertexArray(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -820,7 +1049,7 @@ void renderQuad()
         glEnableVertexAttribArray(4);
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GLState::bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
\ No newline at end of file
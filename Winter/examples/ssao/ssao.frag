@@ -3,38 +3,76 @@ out float FragColor;
   
 in vec2 TexCoords;
 
-uniform sampler2D gPosition;
+uniform sampler2D ssaoDepth; // linear view depth, at the resolution of the SSAO
 uniform sampler2D gNormal;
 uniform sampler2D texNoise;
+uniform bool compactGBuffer;
 
 uniform float exponent;
-uniform vec3 samples[64];
+uniform int kernelSize;
+uniform float radius;
 uniform mat4 projection;
 
-// tile noise texture over screen, based on screen dimensions divided by noise size
-const vec2 noiseScale = vec2(800.0/4.0, 600.0/4.0); // screen = 800x600
+// uploaded once, a kernel of kernelSize samples takes one of every 64 / kernelSize
+layout (std140) uniform SSAOKernel
+{
+    vec4 samples[64];
+};
+
+vec2 signNotZero(vec2 v)
+{
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// inverse of the encoding of gBuffer.frag
+vec3 decodeOctahedral(vec2 encoded)
+{
+    encoded = encoded * 2.0 - 1.0;
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (n.z < 0.0)
+    {
+        n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    }
+    return normalize(n);
+}
+
+// view space position of the surface under a texel of the SSAO
+vec3 getViewPosition(vec2 uv)
+{
+    float depth = texture(ssaoDepth, uv).r;
+    return vec3((uv * 2.0 - 1.0) / vec2(projection[0][0], projection[1][1]) * depth, -depth);
+}
+
+vec3 getViewNormal(vec2 uv)
+{
+    return compactGBuffer ? decodeOctahedral(texture(gNormal, uv).rg) : normalize(texture(gNormal, uv).rgb);
+}
 
 void main()
 {
     // get input for SSAO algorithm
-    vec3 fragPos = texture(gPosition, TexCoords).xyz;
-    vec3 normal = normalize(texture(gNormal, TexCoords).rgb);
+    vec3 fragPos = getViewPosition(TexCoords);
+    vec3 normal = getViewNormal(TexCoords);
+    // the 4x4 noise tile rotates the kernel of each pixel of a tile differently, the upsampling blur averages the tile back
+    vec2 noiseScale = vec2(textureSize(ssaoDepth, 0)) / 4.0;
     vec3 randomVec = normalize(texture(texNoise, TexCoords * noiseScale).xyz);
     // create TBN change-of-basis matrix: from tangent-space to view-space
     vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
     vec3 bitangent = cross(normal, tangent);
     mat3 TBN = mat3(tangent, bitangent, normal);
 
-	int kernelSize = 64;
-	float radius = 0.5;
 	float bias = 0.025;
+	// interleaved sampling: the pixels of a 4x4 tile take different subsets of the 64 samples
+	int sampleStride = 64 / kernelSize;
+	ivec2 tilePixel = ivec2(gl_FragCoord.xy) % 4;
+	int firstSample = (tilePixel.x + 4 * tilePixel.y) % sampleStride;
 
     // iterate over the sample kernel and calculate occlusion factor
     float occlusion = 0.0;
     for(int i = 0; i < kernelSize; ++i)
     {
         // get sample position
-        vec3 samplePos = TBN * samples[i]; // from tangent to view-space
+        vec3 samplePos = TBN * samples[firstSample + i * sampleStride].xyz; // from tangent to view-space
         samplePos = fragPos + samplePos * radius; 
         
         // project sample position (to sample texture) (to get position on screen/texture)
@@ -44,7 +82,7 @@ void main()
         offset.xyz = offset.xyz * 0.5 + 0.5; // transform to range 0.0 - 1.0
         
         // get sample depth
-        float sampleDepth = texture(gPosition, offset.xy).z; // get depth value of kernel sample
+        float sampleDepth = getViewPosition(offset.xy).z; // get depth value of kernel sample
         
         // range check & accumulate
         float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - sampleDepth));
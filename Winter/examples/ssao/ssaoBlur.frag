@@ -4,17 +4,34 @@ out float FragColor;
 in vec2 TexCoords;
   
 uniform sampler2D ssaoInput;
+uniform sampler2D ssaoDepth; // linear view depth of ssaoInput's texels
+uniform sampler2D gDepth;
+uniform mat4 inverseProjection;
 
+// relative depth difference past which a texel of ssaoInput is considered another surface
+const float depthTolerance = 0.05;
+
+// Depth-aware 4x4 blur averaging the noise tile of ssao.frag, upsampling ssaoInput to the resolution of the G-buffer:
+// the texels lying on another surface than the pixel are weighted down, the occlusion does not bleed across the edges.
 void main() {
-    vec2 texelSize = 1.0 / vec2(textureSize(ssaoInput, 0));
+    vec4 ndc = vec4(vec3(TexCoords, texture(gDepth, TexCoords).r) * 2.0 - 1.0, 1.0);
+    vec4 viewPosition = inverseProjection * ndc;
+    float depth = -viewPosition.z / viewPosition.w;
+
+    ivec2 inputSize = textureSize(ssaoInput, 0);
+    ivec2 firstTexel = ivec2(TexCoords * vec2(inputSize)) - 2;
     float result = 0.0;
-    for (int x = -2; x < 3; ++x) 
+    float totalWeight = 0.0;
+    for (int x = 0; x < 4; ++x) 
     {
-        for (int y = -2; y < 3; ++y) 
+        for (int y = 0; y < 4; ++y) 
         {
-            vec2 offset = vec2(float(x), float(y)) * texelSize;
-            result += texture(ssaoInput, TexCoords + offset).r;
+            ivec2 texel = clamp(firstTexel + ivec2(x, y), ivec2(0), inputSize - 1);
+            float sampleDepth = texelFetch(ssaoDepth, texel, 0).r;
+            float weight = max(1.0 - abs(sampleDepth - depth) / (depthTolerance * depth), 0.0) + 1e-4;
+            result += texelFetch(ssaoInput, texel, 0).r * weight;
+            totalWeight += weight;
         }
     }
-    FragColor = result / (5.0 * 5.0);
-}  
\ No newline at end of file
+    FragColor = result / totalWeight;
+}  
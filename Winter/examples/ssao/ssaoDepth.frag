@@ -0,0 +1,16 @@
+#version 330 core
+out float FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gDepth;
+uniform mat4 inverseProjection;
+
+// Linear view depth at the resolution of the SSAO, one G-buffer texel per pixel.
+// The SSAO and its upsampling read it instead of the G-buffer, 4 bytes per sample.
+void main()
+{
+    vec4 ndc = vec4(vec3(TexCoords, texture(gDepth, TexCoords).r) * 2.0 - 1.0, 1.0);
+    vec4 viewPosition = inverseProjection * ndc;
+    FragColor = -viewPosition.z / viewPosition.w;
+}
@@ -16,6 +16,7 @@
 #include "stb_image.h"
 
 #include "camera.h"
+#include "glState.h"
 #include "model.h"
 #include "pathManager.h"
 #include "shader.h"
@@ -120,7 +121,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
 	// ------------------------------------
@@ -205,9 +206,9 @@ int main()
 
         // rendering commands
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
-		glEnable(GL_STENCIL_TEST);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
+		GLState::enable(GL_STENCIL_TEST);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
         glStencilFunc(GL_ALWAYS, 1, 0xFF);
         glStencilMask(0xFF);
@@ -272,7 +273,7 @@ int main()
         // Draw from Stencil Buffer highlights
         glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
         glStencilMask(0x00);
-		glDisable(GL_DEPTH_TEST);
+		GLState::disable(GL_DEPTH_TEST);
 
 		singleColorShader.use();
 		glm::mat4 model(1.0f);
@@ -293,10 +294,10 @@ int main()
             singleColorShader.setMat4("model", value_ptr(model));
             cube.draw(singleColorShader);
         }
-		glEnable(GL_DEPTH_TEST);
+		GLState::enable(GL_DEPTH_TEST);
 
         // Draw Plane
-        glDepthFunc(GL_LESS);
+        GLState::depthFunc(GL_LESS);
 		glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
         //quad.draw(screenShader);
 
@@ -307,8 +308,8 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteTextures(1, &container2Texture);
-    glDeleteTextures(1, &container2Specular);
+    GLState::deleteTextures(1, &container2Texture);
+    GLState::deleteTextures(1, &container2Specular);
 
     glfwTerminate();
 
@@ -357,7 +358,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
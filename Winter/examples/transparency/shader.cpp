@@ -1,12 +1,14 @@
 #include "shader.h"
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <iostream>
 
 #include "glad/glad.h"
 
-unsigned int Shader::UNUSED_ID = 0;
+#include "glState.h"
 
 Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath, const std::string& geometryPath)
 	: ID(UNUSED_ID), vertexPath(vertexPath), fragmentPath(fragmentPath), geometryPath(geometryPath)
@@ -18,7 +20,7 @@ Shader::~Shader()
 {
     if (ID != UNUSED_ID)
     {
-	    glDeleteProgram(ID);
+	    GLState::deleteProgram(ID);
     }
 }
 
@@ -44,7 +46,7 @@ Shader& Shader::operator=(const Shader& other)
 
 Shader::Shader(Shader&& other) noexcept
 	: ID(std::move(other.ID)), vertexPath(std::move(other.vertexPath)), fragmentPath(std::move(other.fragmentPath)), 
-    geometryPath(std::move(other.geometryPath))
+    geometryPath(std::move(other.geometryPath)), uniforms(std::move(other.uniforms))
 {
 	other.ID = UNUSED_ID;
 }
@@ -61,71 +63,154 @@ Shader& Shader::operator=(Shader&& other) noexcept
     vertexPath = std::move(other.vertexPath);
     fragmentPath = std::move(other.fragmentPath);
 	geometryPath = std::move(other.geometryPath);
+    uniforms = std::move(other.uniforms);
     return *this;
 }
 
 void Shader::use() const
 {
-    glUseProgram(ID);
+    GLState::useProgram(ID);
+}
+
+UniformHandle Shader::getUniformHandle(std::string_view name) const
+{
+    UniformHandle handle;
+    if (uniforms.empty())
+    {
+        return handle;
+    }
+
+    const size_t hash = std::hash<std::string_view>{}(name);
+    const size_t mask = uniforms.size() - 1;
+    // the table is never more than half full, so the probing always reaches an empty slot
+    for (size_t i = hash & mask; !uniforms[i].name.empty(); i = (i + 1) & mask)
+    {
+        if (uniforms[i].hash == hash && uniforms[i].name == name)
+        {
+            handle.location = uniforms[i].location;
+            break;
+        }
+    }
+    return handle;
 }
 
 void Shader::setBool(const std::string& name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    setBool(getUniformHandle(name), value);
 }
 
 void Shader::setInt(const std::string& name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    setInt(getUniformHandle(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    setFloat(getUniformHandle(name), value);
 }
 
 void Shader::setVec2(const std::string& name, float v0, float v1) const
 {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), v0, v1);
+    setVec2(getUniformHandle(name), v0, v1);
 }
 
 void Shader::setVec2(const std::string& name, const glm::vec2& v) const
 {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), v.x, v.y);
+    setVec2(getUniformHandle(name), v);
 }
 
 void Shader::setVec3(const std::string& name, float v0, float v1, float v2) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), v0, v1, v2);
+    setVec3(getUniformHandle(name), v0, v1, v2);
 }
 
 void Shader::setVec3(const std::string& name, const glm::vec3& v) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), v.x, v.y, v.z);
+    setVec3(getUniformHandle(name), v);
 }
 
 void Shader::setVec4(const std::string& name, float v0, float v1, float v2, float v3) const
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), v0, v1, v2, v3);
+    setVec4(getUniformHandle(name), v0, v1, v2, v3);
 }
 
 void Shader::setVec4(const std::string& name, const glm::vec4& v) const
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), v.x, v.y, v.z, v.w);
+    setVec4(getUniformHandle(name), v);
 }
 void Shader::setMat2(const std::string& name, const float* value) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, value);
+    setMat2(getUniformHandle(name), value);
 }
 
 void Shader::setMat3(const std::string& name, const float* value) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, value);
+    setMat3(getUniformHandle(name), value);
 }
 
 void Shader::setMat4(const std::string& name, const float* value) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, value);
+    setMat4(getUniformHandle(name), value);
+}
+
+void Shader::setBool(UniformHandle handle, bool value) const
+{
+    glUniform1i(handle.location, (int)value);
+}
+
+void Shader::setInt(UniformHandle handle, int value) const
+{
+    glUniform1i(handle.location, value);
+}
+
+void Shader::setFloat(UniformHandle handle, float value) const
+{
+    glUniform1f(handle.location, value);
+}
+
+void Shader::setVec2(UniformHandle handle, float v0, float v1) const
+{
+    glUniform2f(handle.location, v0, v1);
+}
+
+void Shader::setVec2(UniformHandle handle, const glm::vec2& v) const
+{
+    glUniform2f(handle.location, v.x, v.y);
+}
+
+void Shader::setVec3(UniformHandle handle, float v0, float v1, float v2) const
+{
+    glUniform3f(handle.location, v0, v1, v2);
+}
+
+void Shader::setVec3(UniformHandle handle, const glm::vec3& v) const
+{
+    glUniform3f(handle.location, v.x, v.y, v.z);
+}
+
+void Shader::setVec4(UniformHandle handle, float v0, float v1, float v2, float v3) const
+{
+    glUniform4f(handle.location, v0, v1, v2, v3);
+}
+
+void Shader::setVec4(UniformHandle handle, const glm::vec4& v) const
+{
+    glUniform4f(handle.location, v.x, v.y, v.z, v.w);
+}
+
+void Shader::setMat2(UniformHandle handle, const float* value) const
+{
+    glUniformMatrix2fv(handle.location, 1, GL_FALSE, value);
+}
+
+void Shader::setMat3(UniformHandle handle, const float* value) const
+{
+    glUniformMatrix3fv(handle.location, 1, GL_FALSE, value);
+}
+
+void Shader::setMat4(UniformHandle handle, const float* value) const
+{
+	glUniformMatrix4fv(handle.location, 1, GL_FALSE, value);
 }
 
 void Shader::generateShader(const std::string& vertexPath, const std::string& fragmentPath, const std::string& geometryPath)
@@ -165,6 +250,8 @@ void Shader::generateShader(const std::string& vertexPath, const std::string& fr
     {
 		glDeleteShader(geometry);
     }
+
+    cacheUniformLocations();
 }
 
 unsigned int Shader::compileShaderSource(const std::string& shaderPath, GLenum shaderType)
@@ -208,6 +295,83 @@ unsigned int Shader::compileShaderSource(const std::string& shaderPath, GLenum s
 	return shaderID;
 }
 
+void Shader::cacheUniformLocations()
+{
+    uniforms.clear();
+
+    int uniformCount = 0;
+    int maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    struct ActiveUniform
+    {
+        std::string name;
+        int location;
+    };
+    std::vector<ActiveUniform> activeUniforms;
+    activeUniforms.reserve(uniformCount);
+
+    std::string name(std::max(maxNameLength, 1), '\0');
+    for (int i = 0; i < uniformCount; i++)
+    {
+        int nameLength = 0;
+        int size = 0;
+        GLenum type;
+        glGetActiveUniform(ID, i, static_cast<GLsizei>(name.size()), &nameLength, &size, &type, name.data());
+        const std::string uniformName = name.substr(0, nameLength);
+        const int location = glGetUniformLocation(ID, uniformName.c_str());
+        if (location == UniformHandle::UNUSED_LOCATION) // uniform block members
+        {
+            continue;
+        }
+        activeUniforms.push_back({ uniformName, location });
+
+        // arrays are reported once as "name[0]", register "name" and every element too
+        const size_t arraySuffix = uniformName.rfind("[0]");
+        if (arraySuffix != std::string::npos && arraySuffix + 3 == uniformName.size())
+        {
+            const std::string arrayName = uniformName.substr(0, arraySuffix);
+            activeUniforms.push_back({ arrayName, location });
+            for (int element = 1; element < size; element++)
+            {
+                const std::string elementName = arrayName + "[" + std::to_string(element) + "]";
+                activeUniforms.push_back({ elementName, glGetUniformLocation(ID, elementName.c_str()) });
+            }
+        }
+    }
+
+    // power of two capacity at most half full
+    size_t capacity = 16;
+    while (capacity < activeUniforms.size() * 2)
+    {
+        capacity *= 2;
+    }
+    uniforms.resize(capacity);
+    for (const ActiveUniform& uniform : activeUniforms)
+    {
+        insertUniform(uniform.name, uniform.location);
+    }
+}
+
+void Shader::insertUniform(const std::string& name, int location)
+{
+    const size_t hash = std::hash<std::string_view>{}(name);
+    const size_t mask = uniforms.size() - 1;
+    size_t i = hash & mask;
+    while (!uniforms[i].name.empty())
+    {
+        if (uniforms[i].hash == hash && uniforms[i].name == name)
+        {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    uniforms[i].hash = hash;
+    uniforms[i].name = name;
+    uniforms[i].location = location;
+}
+
 std::string Shader::getShaderTypeString(GLenum shaderType)
 {
     switch (shaderType)
@@ -7,9 +7,11 @@
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 
+#include "glState.h"
+
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void processInput(GLFWwindow* window)
@@ -80,7 +82,7 @@ int main()
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
 
     // SHADERS
@@ -177,7 +179,7 @@ int main()
 
     for (int i = 0; i < nbVAOs; i++)
     {
-        glBindVertexArray(VAOs[i]);
+        GLState::bindVertexArray(VAOs[i]);
         glBindBuffer(GL_ARRAY_BUFFER, VBOs[i]);
         auto verts = trianglesVertices[i];
         auto vertsSize = trianglesVerticesSizes[i];
@@ -203,8 +205,8 @@ int main()
         // Draw VAO (object)
         for (int i = 0; i < nbVAOs; i++)
         {
-            glUseProgram(shaderPrograms[i]);
-            glBindVertexArray(VAOs[i]);
+            GLState::useProgram(shaderPrograms[i]);
+            GLState::bindVertexArray(VAOs[i]);
             unsigned int nbTriangles = trianglesVerticesSizes[i] / 3 / sizeof(float);
             glDrawArrays(GL_TRIANGLES, 0, nbTriangles);
         }
@@ -216,10 +218,10 @@ int main()
 
     // CLEANUP
     // ------------------------------------
-    glDeleteVertexArrays(2, VAOs);
+    GLState::deleteVertexArrays(2, VAOs);
     glDeleteBuffers(2, VBOs);
-    glDeleteProgram(shaderProgram);
-    glDeleteProgram(shaderProgramRecolor);
+    GLState::deleteProgram(shaderProgram);
+    GLState::deleteProgram(shaderProgramRecolor);
     glfwTerminate();
 
     return 0;
@@ -0,0 +1,147 @@
+﻿// Benchmark: Uniforms
+// CPU time of 10k uniform sets with a glGetUniformLocation per set, with the cached string setters and with UniformHandle
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include "pathManager.h"
+#include "shader.h"
+
+const int NB_SETS = 10000;
+const int NB_RUNS = 10;
+
+double bestRunMs(const std::function<void()>& setUniforms);
+
+int main()
+{
+    // Init Paths
+    PathManager::projectPath = std::filesystem::current_path().string() + "/";
+
+    // DATA
+    // ------------------------------------
+    const std::string WINDOW_TITLE = "Uniform Benchmark";
+
+    // the lights of shaders/pbr.frag moved to a storage buffer, the pbr_spec copy still sets them as an array of uniforms
+    const std::string PATH_EXAMPLE = PathManager::getProjectPath() + "examples/pbr_spec/";
+    const std::string PATH_PBR_VERTEX_SHADER = PATH_EXAMPLE + "pbr.vert";
+    const std::string PATH_PBR_FRAGMENT_SHADER = PATH_EXAMPLE + "pbr.frag";
+
+    // INIT GLFW
+    // ------------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    // MAC only line to enable forward compatibility
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1, 1, WINDOW_TITLE.c_str(), nullptr, nullptr);
+    if (window == nullptr)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    // Init GLAD
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // BENCHMARK
+    // ------------------------------------
+    Shader pbrShader(PATH_PBR_VERTEX_SHADER, PATH_PBR_FRAGMENT_SHADER);
+    pbrShader.use();
+    const unsigned int programID = pbrShader.getID();
+    const glm::vec3 lightPosition(1.0f, 2.0f, 3.0f);
+    const glm::mat4 model(1.0f);
+
+    // what every setter did before the uniform locations were cached
+    const double lookupVec3Ms = bestRunMs([&]() {
+        for (int i = 0; i < NB_SETS; i++)
+        {
+            const std::string name = "lightPositions[" + std::to_string(i % 4) + "]";
+            glUniform3f(glGetUniformLocation(programID, name.c_str()), lightPosition.x, lightPosition.y, lightPosition.z);
+        }
+    });
+    const double lookupMat4Ms = bestRunMs([&]() {
+        for (int i = 0; i < NB_SETS; i++)
+        {
+            glUniformMatrix4fv(glGetUniformLocation(programID, "model"), 1, GL_FALSE, glm::value_ptr(model));
+        }
+    });
+
+    const double cachedVec3Ms = bestRunMs([&]() {
+        for (int i = 0; i < NB_SETS; i++)
+        {
+            pbrShader.setVec3("lightPositions[" + std::to_string(i % 4) + "]", lightPosition);
+        }
+    });
+    const std::string modelName = "model";
+    const double cachedMat4Ms = bestRunMs([&]() {
+        for (int i = 0; i < NB_SETS; i++)
+        {
+            pbrShader.setMat4(modelName, glm::value_ptr(model));
+        }
+    });
+
+    UniformHandle lightPositionHandles[4];
+    for (int i = 0; i < 4; i++)
+    {
+        lightPositionHandles[i] = pbrShader.getUniformHandle("lightPositions[" + std::to_string(i) + "]");
+    }
+    const UniformHandle modelHandle = pbrShader.getUniformHandle(modelName);
+    const double handleVec3Ms = bestRunMs([&]() {
+        for (int i = 0; i < NB_SETS; i++)
+        {
+            pbrShader.setVec3(lightPositionHandles[i % 4], lightPosition);
+        }
+    });
+    const double handleMat4Ms = bestRunMs([&]() {
+        for (int i = 0; i < NB_SETS; i++)
+        {
+            pbrShader.setMat4(modelHandle, glm::value_ptr(model));
+        }
+    });
+
+    std::cout << "CPU time per " << NB_SETS << " uniform sets (best of " << NB_RUNS << " runs)" << std::endl;
+    std::cout << "vec3 array element: glGetUniformLocation " << lookupVec3Ms << " ms, cached string " << cachedVec3Ms << " ms, handle " << handleVec3Ms << " ms" << std::endl;
+    std::cout << "mat4: glGetUniformLocation " << lookupMat4Ms << " ms, cached string " << cachedMat4Ms << " ms, handle " << handleMat4Ms << " ms" << std::endl;
+
+    // CLEANUP
+    // ------------------------------------
+    glfwTerminate();
+
+    return 0;
+}
+
+double bestRunMs(const std::function<void()>& setUniforms)
+{
+    double bestMs = 0.0;
+    for (int run = 0; run < NB_RUNS; run++)
+    {
+        glFinish();
+        const auto start = std::chrono::high_resolution_clock::now();
+        setUniforms();
+        const auto end = std::chrono::high_resolution_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (run == 0 || ms < bestMs)
+        {
+            bestMs = ms;
+        }
+    }
+    return bestMs;
+}
@@ -1,5 +1,5 @@
 
-#version 330 core
+#version 460 core
 out vec4 FragColor;
 in vec2 TexCoords;
 in vec3 WorldPos;
@@ -11,9 +11,35 @@ uniform float metallic;
 uniform float roughness;
 uniform float ao;
 
-// lights
-uniform vec3 lightPositions[4];
-uniform vec3 lightColors[4];
+// clustered lights, see LightClusters
+layout (std140, binding = 1) uniform ClusterParams
+{
+    mat4 clusterView;
+    uvec4 clusterGrid; // x, y and z cluster counts, max lights per cluster
+    vec4 clusterDepth; // slice scale and bias, tile width and height in pixels
+};
+
+struct PointLight
+{
+    vec4 positionRadius;
+    vec4 color;
+    vec4 attenuation; // constant, linear, quadratic
+};
+
+layout (std430, binding = 0) readonly buffer Lights
+{
+    PointLight lights[];
+};
+
+layout (std430, binding = 1) readonly buffer LightGrid
+{
+    uvec2 lightGrid[];
+};
+
+layout (std430, binding = 2) readonly buffer LightIndices
+{
+    uint lightIndices[];
+};
 
 uniform samplerCube irradianceMap;
 uniform samplerCube prefilterMap;
@@ -28,6 +54,8 @@ float GeometrySchlickGGX(float NdotV, float roughness);
 float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness);
 vec3 fresnelSchlick(float cosTheta, vec3 F0);
 vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness);
+uint getClusterIndex(vec2 fragCoord, vec3 worldPos);
+float getAttenuation(PointLight light, float distance);
 
 
 void main()
@@ -43,14 +71,16 @@ void main()
 
     // reflectance equation
     vec3 Lo = vec3(0.0);
-    for(int i = 0; i < 4; ++i) 
+    uvec2 cluster = lightGrid[getClusterIndex(gl_FragCoord.xy, WorldPos)];
+    for(uint i = 0u; i < cluster.y; ++i) 
     {
+        PointLight light = lights[lightIndices[cluster.x + i]];
         // calculate per-light radiance
-        vec3 L = normalize(lightPositions[i] - WorldPos);
+        vec3 L = normalize(light.positionRadius.xyz - WorldPos);
         vec3 H = normalize(V + L);
-        float distance = length(lightPositions[i] - WorldPos);
-        float attenuation = 1.0 / (distance * distance);
-        vec3 radiance = lightColors[i] * attenuation;
+        float distance = length(light.positionRadius.xyz - WorldPos);
+        float attenuation = getAttenuation(light, distance);
+        vec3 radiance = light.color.rgb * attenuation;
 
         // Cook-Torrance BRDF
         float NDF = DistributionGGX(N, H, roughness);   
@@ -150,4 +180,21 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0)
 vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
 {
     return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
-}   
\ No newline at end of file
+}
+
+uint getClusterIndex(vec2 fragCoord, vec3 worldPos)
+{
+    float viewDepth = max(-(clusterView * vec4(worldPos, 1.0)).z, 0.0001);
+    uint slice = uint(max(log(viewDepth) * clusterDepth.x - clusterDepth.y, 0.0));
+    uvec3 cluster = min(uvec3(uvec2(fragCoord / clusterDepth.zw), slice), clusterGrid.xyz - 1u);
+    return cluster.x + clusterGrid.x * (cluster.y + clusterGrid.y * cluster.z);
+}
+
+// smoothly reaches 0 at the radius the light was culled with
+float getAttenuation(PointLight light, float distance)
+{
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
+    float ratio = distance / light.positionRadius.w;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return attenuation * window * window;
+}
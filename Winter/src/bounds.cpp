@@ -0,0 +1,77 @@
+#include "bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+AABB AABB::transform(const glm::mat4& matrix) const
+{
+	// Arvo's method: each axis of the matrix adds its min and max contribution
+	const glm::vec3 translation(matrix[3]);
+	AABB result{ translation, translation };
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			const float a = matrix[column][row] * min[column];
+			const float b = matrix[column][row] * max[column];
+			result.min[row] += std::min(a, b);
+			result.max[row] += std::max(a, b);
+		}
+	}
+	return result;
+}
+
+AABB AABB::fromVertices(const std::vector<Vertex>& vertices)
+{
+	if (vertices.empty())
+	{
+		return AABB{ glm::vec3(0.0f), glm::vec3(0.0f) };
+	}
+
+	AABB aabb{ vertices[0].Position, vertices[0].Position };
+	for (const Vertex& vertex : vertices)
+	{
+		aabb.min = glm::min(aabb.min, vertex.Position);
+		aabb.max = glm::max(aabb.max, vertex.Position);
+	}
+	return aabb;
+}
+
+BoundingSphere BoundingSphere::transform(const glm::mat4& matrix) const
+{
+	const glm::vec3 transformedCenter(matrix * glm::vec4(center, 1.0f));
+	const float scaleX = glm::length(glm::vec3(matrix[0]));
+	const float scaleY = glm::length(glm::vec3(matrix[1]));
+	const float scaleZ = glm::length(glm::vec3(matrix[2]));
+	return BoundingSphere{ transformedCenter, radius * std::max(scaleX, std::max(scaleY, scaleZ)) };
+}
+
+BoundingSphere BoundingSphere::fromVertices(const std::vector<Vertex>& vertices, const AABB& aabb)
+{
+	const glm::vec3 center = aabb.getCenter();
+	float squaredRadius = 0.0f;
+	for (const Vertex& vertex : vertices)
+	{
+		const glm::vec3 offset = vertex.Position - center;
+		squaredRadius = std::max(squaredRadius, glm::dot(offset, offset));
+	}
+	return BoundingSphere{ center, std::sqrt(squaredRadius) };
+}
+
+BoundingSphere BoundingSphere::merge(const BoundingSphere& a, const BoundingSphere& b)
+{
+	const glm::vec3 offset = b.center - a.center;
+	const float distance = glm::length(offset);
+	if (distance + b.radius <= a.radius)
+	{
+		return a;
+	}
+	if (distance + a.radius <= b.radius)
+	{
+		return b;
+	}
+
+	const float radius = (distance + a.radius + b.radius) * 0.5f;
+	const glm::vec3 center = a.center + offset * ((radius - a.radius) / distance);
+	return BoundingSphere{ center, radius };
+}
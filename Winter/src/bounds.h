@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "vertex.h"
+
+struct AABB {
+	glm::vec3 min;
+	glm::vec3 max;
+
+	glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+	glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+	// AABB of the transformed box, larger than the transformed box itself when there is a rotation
+	AABB transform(const glm::mat4& matrix) const;
+
+	static AABB fromVertices(const std::vector<Vertex>& vertices);
+};
+
+struct BoundingSphere {
+	glm::vec3 center;
+	float radius;
+
+	// The radius is scaled by the largest scale of the matrix
+	BoundingSphere transform(const glm::mat4& matrix) const;
+
+	// Centered on the AABB of the vertices, not minimal but cheap and stable
+	static BoundingSphere fromVertices(const std::vector<Vertex>& vertices, const AABB& aabb);
+	static BoundingSphere merge(const BoundingSphere& a, const BoundingSphere& b);
+};
\ No newline at end of file
@@ -28,4 +28,9 @@ glm::mat4 Camera::getProjectionMatrix(int width, int height) const
 {
 	const glm::mat4 projection = glm::perspective(glm::radians(_fov), static_cast<float>(width) / static_cast<float>(height), _nearPlane, _farPlane);
 	return projection;
+}
+
+Frustum Camera::getFrustum(int width, int height) const
+{
+	return Frustum(getProjectionMatrix(width, height) * getViewMatrix());
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
 
+#include "frustum.h"
+
 class Camera
 {
 public:
@@ -29,6 +31,8 @@ public:
 	void SetFOV(float fov) { _fov = fov; }
 	glm::mat4 getViewMatrix() const;
 	glm::mat4 getProjectionMatrix(int width, int height) const;
+	// World space frustum, extracted from getProjectionMatrix() * getViewMatrix()
+	Frustum getFrustum(int width, int height) const;
 private:
 	glm::vec3 _pos;
 	glm::vec3 _front;
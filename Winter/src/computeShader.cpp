@@ -0,0 +1,175 @@
+#include "computeShader.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#include "glad/glad.h"
+
+#include "glState.h"
+
+ComputeShader::ComputeShader(const std::string& computePath)
+    : ID(UNUSED_ID), computePath(computePath)
+{
+    generateShader(computePath);
+}
+
+ComputeShader::~ComputeShader()
+{
+    if (ID != UNUSED_ID)
+    {
+        GLState::deleteProgram(ID);
+    }
+}
+
+ComputeShader::ComputeShader(ComputeShader&& other) noexcept
+    : ID(other.ID), computePath(std::move(other.computePath))
+{
+    other.ID = UNUSED_ID;
+}
+
+ComputeShader& ComputeShader::operator=(ComputeShader&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    if (ID != UNUSED_ID)
+    {
+        GLState::deleteProgram(ID);
+    }
+    ID = other.ID;
+    other.ID = UNUSED_ID;
+    computePath = std::move(other.computePath);
+    return *this;
+}
+
+void ComputeShader::use() const
+{
+    GLState::useProgram(ID);
+}
+
+void ComputeShader::dispatch(unsigned int nbGroupsX, unsigned int nbGroupsY, unsigned int nbGroupsZ) const
+{
+    glDispatchCompute(nbGroupsX, nbGroupsY, nbGroupsZ);
+}
+
+UniformHandle ComputeShader::getUniformHandle(std::string_view name) const
+{
+    UniformHandle handle;
+    handle.location = glGetUniformLocation(ID, std::string(name).c_str());
+    return handle;
+}
+
+void ComputeShader::setInt(const std::string& name, int value) const
+{
+    setInt(getUniformHandle(name), value);
+}
+
+void ComputeShader::setUInt(const std::string& name, unsigned int value) const
+{
+    setUInt(getUniformHandle(name), value);
+}
+
+void ComputeShader::setFloat(const std::string& name, float value) const
+{
+    setFloat(getUniformHandle(name), value);
+}
+
+void ComputeShader::setVec2(const std::string& name, const glm::vec2& v) const
+{
+    setVec2(getUniformHandle(name), v);
+}
+
+void ComputeShader::setVec3(const std::string& name, const glm::vec3& v) const
+{
+    setVec3(getUniformHandle(name), v);
+}
+
+void ComputeShader::setVec4(const std::string& name, const glm::vec4& v) const
+{
+    setVec4(getUniformHandle(name), v);
+}
+
+void ComputeShader::setMat4(const std::string& name, const float* value) const
+{
+    setMat4(getUniformHandle(name), value);
+}
+
+void ComputeShader::setInt(UniformHandle handle, int value) const
+{
+    glUniform1i(handle.location, value);
+}
+
+void ComputeShader::setUInt(UniformHandle handle, unsigned int value) const
+{
+    glUniform1ui(handle.location, value);
+}
+
+void ComputeShader::setFloat(UniformHandle handle, float value) const
+{
+    glUniform1f(handle.location, value);
+}
+
+void ComputeShader::setVec2(UniformHandle handle, const glm::vec2& v) const
+{
+    glUniform2f(handle.location, v.x, v.y);
+}
+
+void ComputeShader::setVec3(UniformHandle handle, const glm::vec3& v) const
+{
+    glUniform3f(handle.location, v.x, v.y, v.z);
+}
+
+void ComputeShader::setVec4(UniformHandle handle, const glm::vec4& v) const
+{
+    glUniform4f(handle.location, v.x, v.y, v.z, v.w);
+}
+
+void ComputeShader::setMat4(UniformHandle handle, const float* value) const
+{
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, value);
+}
+
+void ComputeShader::generateShader(const std::string& computePath)
+{
+    std::string code;
+    std::ifstream shaderFile(computePath);
+    if (shaderFile)
+    {
+        std::stringstream shaderStream;
+        shaderStream << shaderFile.rdbuf();
+        code = shaderStream.str();
+    }
+    else
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << computePath << std::endl;
+    }
+
+    const char* shaderCode = code.c_str();
+    int success;
+    char infoLog[512];
+
+    const unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(compute, 1, &shaderCode, nullptr);
+    glCompileShader(compute);
+    glGetShaderiv(compute, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(compute, sizeof(infoLog), nullptr, infoLog);
+        std::cout << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n" << computePath << "\n" << infoLog << std::endl;
+    }
+
+    ID = glCreateProgram();
+    glAttachShader(ID, compute);
+    glLinkProgram(ID);
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(ID, sizeof(infoLog), nullptr, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+
+    glDeleteShader(compute);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "glm/glm.hpp"
+#include "glad/glad.h"
+
+#include "shader.h"
+
+// Program made of a single compute shader, requires an OpenGL 4.3+ context
+class ComputeShader
+{
+private:
+    static constexpr unsigned int UNUSED_ID = 0;
+public:
+    ComputeShader(const std::string& computePath);
+    ~ComputeShader();
+    ComputeShader(const ComputeShader& other) = delete;
+    ComputeShader& operator=(const ComputeShader& other) = delete;
+    ComputeShader(ComputeShader&& other) noexcept;
+    ComputeShader& operator=(ComputeShader&& other) noexcept;
+    // use/activate the shader
+    void use() const;
+    unsigned int getID() const { return ID; }
+    // the shader has to be in use, the caller is responsible for the memory barriers
+    void dispatch(unsigned int nbGroupsX, unsigned int nbGroupsY = 1, unsigned int nbGroupsZ = 1) const;
+    // returns an invalid handle if the uniform is not active in the program, resolve the handles once for the uniforms set every dispatch
+    UniformHandle getUniformHandle(std::string_view name) const;
+    // utility uniform functions
+    void setInt(const std::string& name, int value) const;
+    void setUInt(const std::string& name, unsigned int value) const;
+    void setFloat(const std::string& name, float value) const;
+    void setVec2(const std::string& name, const glm::vec2& v) const;
+    void setVec3(const std::string& name, const glm::vec3& v) const;
+    void setVec4(const std::string& name, const glm::vec4& v) const;
+    void setMat4(const std::string& name, const float* value) const;
+    void setInt(UniformHandle handle, int value) const;
+    void setUInt(UniformHandle handle, unsigned int value) const;
+    void setFloat(UniformHandle handle, float value) const;
+    void setVec2(UniformHandle handle, const glm::vec2& v) const;
+    void setVec3(UniformHandle handle, const glm::vec3& v) const;
+    void setVec4(UniformHandle handle, const glm::vec4& v) const;
+    void setMat4(UniformHandle handle, const float* value) const;
+
+private:
+    unsigned int ID;
+    std::string computePath;
+
+    void generateShader(const std::string& computePath);
+};
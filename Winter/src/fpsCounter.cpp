@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include "traceRecorder.h"
+
 FPSCounter::FPSCounter(float timeForCalcs)
 	: frameTimes(), timeForCalcs(timeForCalcs)
 {
@@ -14,6 +16,7 @@ void FPSCounter::update(float time)
 		frameTimes.pop();
 	}
 	frameTimes.push(time);
+	TraceRecorder::nextFrame();
 }
 
 float FPSCounter::getFPS() const
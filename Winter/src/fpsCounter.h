@@ -5,6 +5,7 @@ class FPSCounter
 {
 public:
 	FPSCounter(float timeForCalcs);
+	// Called once per frame, also the frame boundary of the trace recording
 	void update(float time);
 	float getFPS() const;
 	void showFPS() const;
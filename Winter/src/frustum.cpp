@@ -0,0 +1,156 @@
+#include "frustum.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WINTER_FRUSTUM_SSE
+#include <emmintrin.h>
+#endif
+
+void BoundingSphereBatch::add(const BoundingSphere& sphere)
+{
+	centersX.push_back(sphere.center.x);
+	centersY.push_back(sphere.center.y);
+	centersZ.push_back(sphere.center.z);
+	radiuses.push_back(sphere.radius);
+}
+
+void BoundingSphereBatch::clear()
+{
+	centersX.clear();
+	centersY.clear();
+	centersZ.clear();
+	radiuses.clear();
+}
+
+void BoundingSphereBatch::reserve(size_t count)
+{
+	centersX.reserve(count);
+	centersY.reserve(count);
+	centersZ.reserve(count);
+	radiuses.reserve(count);
+}
+
+Frustum::Frustum(const glm::mat4& matrix)
+{
+	// Gribb-Hartmann: the planes are sums and differences of the rows of the matrix (glm is column major)
+	const glm::vec4 row0(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+	const glm::vec4 row1(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+	const glm::vec4 row2(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+	const glm::vec4 row3(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+	planes[LEFT_PLANE] = row3 + row0;
+	planes[RIGHT_PLANE] = row3 - row0;
+	planes[BOTTOM_PLANE] = row3 + row1;
+	planes[TOP_PLANE] = row3 - row1;
+	planes[NEAR_PLANE] = row3 + row2;
+	planes[FAR_PLANE] = row3 - row2;
+
+	// normalized so that the distance to a plane can be compared to a radius
+	for (glm::vec4& plane : planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+}
+
+bool Frustum::isVisible(const BoundingSphere& sphere) const
+{
+	for (const glm::vec4& plane : planes)
+	{
+		if (plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w < -sphere.radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::isVisible(const AABB& aabb) const
+{
+	const glm::vec3 center = aabb.getCenter();
+	const glm::vec3 extents = aabb.getExtents();
+	for (const glm::vec4& plane : planes)
+	{
+		const float radius = glm::dot(extents, glm::abs(glm::vec3(plane)));
+		if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void Frustum::cullSpheres(const BoundingSphereBatch& spheres, std::vector<unsigned int>& visibleIndices) const
+{
+	const size_t count = spheres.size();
+	visibleIndices.resize(count);
+	unsigned int* output = visibleIndices.data();
+	size_t nbVisible = 0;
+	size_t i = 0;
+
+#ifdef WINTER_FRUSTUM_SSE
+	__m128 planesX[PLANE_COUNT];
+	__m128 planesY[PLANE_COUNT];
+	__m128 planesZ[PLANE_COUNT];
+	__m128 planesW[PLANE_COUNT];
+	for (int plane = 0; plane < PLANE_COUNT; plane++)
+	{
+		planesX[plane] = _mm_set1_ps(planes[plane].x);
+		planesY[plane] = _mm_set1_ps(planes[plane].y);
+		planesZ[plane] = _mm_set1_ps(planes[plane].z);
+		planesW[plane] = _mm_set1_ps(planes[plane].w);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(&spheres.centersX[i]);
+		const __m128 y = _mm_loadu_ps(&spheres.centersY[i]);
+		const __m128 z = _mm_loadu_ps(&spheres.centersZ[i]);
+		const __m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(&spheres.radiuses[i]));
+
+		__m128 isVisible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int plane = 0; plane < PLANE_COUNT; plane++)
+		{
+			// same evaluation order as the scalar path, so both agree on the spheres touching a plane
+			__m128 distance = _mm_mul_ps(planesX[plane], x);
+			distance = _mm_add_ps(distance, _mm_mul_ps(planesY[plane], y));
+			distance = _mm_add_ps(distance, _mm_mul_ps(planesZ[plane], z));
+			distance = _mm_add_ps(distance, planesW[plane]);
+			isVisible = _mm_and_ps(isVisible, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		// branchless compaction, the index is always written but only kept if visible
+		const int mask = _mm_movemask_ps(isVisible);
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			output[nbVisible] = static_cast<unsigned int>(i + j);
+			nbVisible += (mask >> j) & 1;
+		}
+	}
+#endif
+
+	nbVisible += cullSpheresScalar(spheres, i, output + nbVisible);
+	visibleIndices.resize(nbVisible);
+}
+
+void Frustum::cullSpheresScalar(const BoundingSphereBatch& spheres, std::vector<unsigned int>& visibleIndices) const
+{
+	visibleIndices.resize(spheres.size());
+	const size_t nbVisible = cullSpheresScalar(spheres, 0, visibleIndices.data());
+	visibleIndices.resize(nbVisible);
+}
+
+size_t Frustum::cullSpheresScalar(const BoundingSphereBatch& spheres, size_t begin, unsigned int* visibleIndices) const
+{
+	size_t nbVisible = 0;
+	for (size_t i = begin; i < spheres.size(); i++)
+	{
+		bool isVisible = true;
+		for (const glm::vec4& plane : planes)
+		{
+			const float distance = plane.x * spheres.centersX[i] + plane.y * spheres.centersY[i] + plane.z * spheres.centersZ[i] + plane.w;
+			isVisible &= distance >= -spheres.radiuses[i];
+		}
+		visibleIndices[nbVisible] = static_cast<unsigned int>(i);
+		nbVisible += isVisible ? 1 : 0;
+	}
+	return nbVisible;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "bounds.h"
+
+// Bounding spheres stored as structure of arrays, so that they can be culled several at a time
+struct BoundingSphereBatch {
+	std::vector<float> centersX;
+	std::vector<float> centersY;
+	std::vector<float> centersZ;
+	std::vector<float> radiuses;
+
+	void add(const BoundingSphere& sphere);
+	void clear();
+	void reserve(size_t count);
+	size_t size() const { return radiuses.size(); }
+};
+
+// Planes pointing inside, extracted from a (projection * view * model) matrix.
+// Without the model matrix the planes are in world space, with it they are in the model's space.
+class Frustum {
+public:
+	enum Plane { LEFT_PLANE, RIGHT_PLANE, BOTTOM_PLANE, TOP_PLANE, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+
+	Frustum(const glm::mat4& matrix);
+
+	const glm::vec4& getPlane(Plane plane) const { return planes[plane]; }
+	bool isVisible(const BoundingSphere& sphere) const;
+	bool isVisible(const AABB& aabb) const;
+
+	// Writes the indices of the visible spheres, uses SSE to test 4 spheres at a time when available
+	void cullSpheres(const BoundingSphereBatch& spheres, std::vector<unsigned int>& visibleIndices) const;
+	// Same result as cullSpheres, one sphere at a time
+	void cullSpheresScalar(const BoundingSphereBatch& spheres, std::vector<unsigned int>& visibleIndices) const;
+private:
+	glm::vec4 planes[PLANE_COUNT];
+
+	size_t cullSpheresScalar(const BoundingSphereBatch& spheres, size_t begin, unsigned int* visibleIndices) const;
+};
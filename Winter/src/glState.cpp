@@ -0,0 +1,315 @@
+#include "glState.h"
+
+#include <iostream>
+
+template<typename T, size_t N>
+std::array<T, N> makeFilledArray(const T& value)
+{
+	std::array<T, N> values;
+	values.fill(value);
+	return values;
+}
+
+std::array<GLuint, GLState::CAPABILITY_COUNT> GLState::capabilities = makeFilledArray<GLuint, GLState::CAPABILITY_COUNT>(GLState::UNKNOWN);
+GLuint GLState::depthFuncValue = GLState::UNKNOWN;
+GLuint GLState::depthMaskValue = GLState::UNKNOWN;
+GLuint GLState::cullFaceValue = GLState::UNKNOWN;
+GLuint GLState::frontFaceValue = GLState::UNKNOWN;
+std::array<GLuint, 2> GLState::blendFuncValue = makeFilledArray<GLuint, 2>(GLState::UNKNOWN);
+GLuint GLState::drawFramebuffer = GLState::UNKNOWN;
+GLuint GLState::readFramebuffer = GLState::UNKNOWN;
+std::array<GLint, 4> GLState::viewportValue = {};
+bool GLState::isViewportKnown = false;
+GLuint GLState::program = GLState::UNKNOWN;
+GLuint GLState::activeUnit = GLState::UNKNOWN;
+std::array<std::array<GLuint, GLState::TEXTURE_TARGET_COUNT>, GLState::MAX_TEXTURE_UNITS> GLState::textures =
+	makeFilledArray<std::array<GLuint, GLState::TEXTURE_TARGET_COUNT>, GLState::MAX_TEXTURE_UNITS>(makeFilledArray<GLuint, GLState::TEXTURE_TARGET_COUNT>(GLState::UNKNOWN));
+GLuint GLState::vertexArray = GLState::UNKNOWN;
+
+GLState::Stats GLState::frameStats = {};
+GLState::Stats GLState::lastFrameStats = {};
+
+void GLState::enable(GLenum capability)
+{
+	setCapability(capability, true);
+}
+
+void GLState::disable(GLenum capability)
+{
+	setCapability(capability, false);
+}
+
+void GLState::depthFunc(GLenum func)
+{
+	if (update(depthFuncValue, func))
+	{
+		glDepthFunc(func);
+	}
+}
+
+void GLState::depthMask(GLboolean flag)
+{
+	if (update(depthMaskValue, flag))
+	{
+		glDepthMask(flag);
+	}
+}
+
+void GLState::cullFace(GLenum mode)
+{
+	if (update(cullFaceValue, mode))
+	{
+		glCullFace(mode);
+	}
+}
+
+void GLState::frontFace(GLenum mode)
+{
+	if (update(frontFaceValue, mode))
+	{
+		glFrontFace(mode);
+	}
+}
+
+void GLState::blendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	if (blendFuncValue[0] == sourceFactor && blendFuncValue[1] == destinationFactor)
+	{
+		frameStats.skipped++;
+		return;
+	}
+	blendFuncValue = { sourceFactor, destinationFactor };
+	frameStats.issued++;
+	glBlendFunc(sourceFactor, destinationFactor);
+}
+
+void GLState::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	const bool isDrawBound = drawFramebuffer == framebuffer;
+	const bool isReadBound = readFramebuffer == framebuffer;
+	const bool isBound = (target == GL_DRAW_FRAMEBUFFER && isDrawBound) || (target == GL_READ_FRAMEBUFFER && isReadBound)
+		|| (target == GL_FRAMEBUFFER && isDrawBound && isReadBound);
+	if (isBound)
+	{
+		frameStats.skipped++;
+		return;
+	}
+
+	if (target != GL_READ_FRAMEBUFFER)
+	{
+		drawFramebuffer = framebuffer;
+	}
+	if (target != GL_DRAW_FRAMEBUFFER)
+	{
+		readFramebuffer = framebuffer;
+	}
+	frameStats.issued++;
+	glBindFramebuffer(target, framebuffer);
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	const std::array<GLint, 4> value = { x, y, width, height };
+	if (isViewportKnown && viewportValue == value)
+	{
+		frameStats.skipped++;
+		return;
+	}
+	viewportValue = value;
+	isViewportKnown = true;
+	frameStats.issued++;
+	glViewport(x, y, width, height);
+}
+
+void GLState::useProgram(GLuint programID)
+{
+	if (update(program, programID))
+	{
+		glUseProgram(programID);
+	}
+}
+
+void GLState::activeTexture(GLenum unit)
+{
+	if (update(activeUnit, unit - GL_TEXTURE0))
+	{
+		glActiveTexture(unit);
+	}
+}
+
+void GLState::bindTexture(GLenum target, GLuint texture)
+{
+	const int targetIndex = getTextureTargetIndex(target);
+	if (targetIndex < 0 || activeUnit >= MAX_TEXTURE_UNITS)
+	{
+		frameStats.issued++;
+		glBindTexture(target, texture);
+		return;
+	}
+	if (update(textures[activeUnit][targetIndex], texture))
+	{
+		glBindTexture(target, texture);
+	}
+}
+
+void GLState::bindVertexArray(GLuint vertexArrayID)
+{
+	if (update(vertexArray, vertexArrayID))
+	{
+		glBindVertexArray(vertexArrayID);
+	}
+}
+
+void GLState::deleteTextures(GLsizei count, const GLuint* textureIDs)
+{
+	glDeleteTextures(count, textureIDs);
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (auto& unitTextures : textures)
+		{
+			for (GLuint& texture : unitTextures)
+			{
+				if (texture == textureIDs[i])
+				{
+					texture = 0;
+				}
+			}
+		}
+	}
+}
+
+void GLState::deleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+{
+	glDeleteVertexArrays(count, vertexArrays);
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (vertexArray == vertexArrays[i])
+		{
+			vertexArray = 0;
+		}
+	}
+}
+
+void GLState::deleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+{
+	glDeleteFramebuffers(count, framebuffers);
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (drawFramebuffer == framebuffers[i])
+		{
+			drawFramebuffer = 0;
+		}
+		if (readFramebuffer == framebuffers[i])
+		{
+			readFramebuffer = 0;
+		}
+	}
+}
+
+void GLState::deleteProgram(GLuint programID)
+{
+	glDeleteProgram(programID);
+	// a program in use is only deleted once it is not used anymore, its name could then be reused
+	if (program == programID)
+	{
+		program = UNKNOWN;
+	}
+}
+
+void GLState::invalidate()
+{
+	capabilities.fill(UNKNOWN);
+	depthFuncValue = UNKNOWN;
+	depthMaskValue = UNKNOWN;
+	cullFaceValue = UNKNOWN;
+	frontFaceValue = UNKNOWN;
+	blendFuncValue.fill(UNKNOWN);
+	drawFramebuffer = UNKNOWN;
+	readFramebuffer = UNKNOWN;
+	isViewportKnown = false;
+	program = UNKNOWN;
+	activeUnit = UNKNOWN;
+	for (auto& unitTextures : textures)
+	{
+		unitTextures.fill(UNKNOWN);
+	}
+	vertexArray = UNKNOWN;
+}
+
+void GLState::nextFrame()
+{
+	lastFrameStats = frameStats;
+	frameStats = {};
+}
+
+const GLState::Stats& GLState::getStats()
+{
+	return lastFrameStats;
+}
+
+void GLState::showStats()
+{
+	std::cout << "GL state calls: " << lastFrameStats.issued << " issued, " << lastFrameStats.skipped << " skipped" << std::endl;
+}
+
+int GLState::getCapabilityIndex(GLenum capability)
+{
+	switch (capability)
+	{
+	case GL_DEPTH_TEST: return DEPTH_TEST;
+	case GL_CULL_FACE: return CULL_FACE;
+	case GL_BLEND: return BLEND;
+	case GL_STENCIL_TEST: return STENCIL_TEST;
+	case GL_SCISSOR_TEST: return SCISSOR_TEST;
+	case GL_MULTISAMPLE: return MULTISAMPLE;
+	case GL_FRAMEBUFFER_SRGB: return FRAMEBUFFER_SRGB;
+	case GL_PROGRAM_POINT_SIZE: return PROGRAM_POINT_SIZE;
+	default: return -1;
+	}
+}
+
+int GLState::getTextureTargetIndex(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D: return TEXTURE_2D;
+	case GL_TEXTURE_CUBE_MAP: return TEXTURE_CUBE_MAP;
+	case GL_TEXTURE_2D_ARRAY: return TEXTURE_2D_ARRAY;
+	case GL_TEXTURE_2D_MULTISAMPLE: return TEXTURE_2D_MULTISAMPLE;
+	case GL_TEXTURE_3D: return TEXTURE_3D;
+	default: return -1;
+	}
+}
+
+void GLState::setCapability(GLenum capability, bool isEnabled)
+{
+	const int index = getCapabilityIndex(capability);
+	// the capabilities which are not cached are always issued
+	if (index < 0 || update(capabilities[index], isEnabled ? 1 : 0))
+	{
+		if (index < 0)
+		{
+			frameStats.issued++;
+		}
+		if (isEnabled)
+		{
+			glEnable(capability);
+		}
+		else
+		{
+			glDisable(capability);
+		}
+	}
+}
+
+bool GLState::update(GLuint& cached, GLuint value)
+{
+	if (cached == value)
+	{
+		frameStats.skipped++;
+		return false;
+	}
+	cached = value;
+	frameStats.issued++;
+	return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "glad/glad.h"
+
+// Shadow copy of the GL state most often re-issued, the calls which would not change it are dropped.
+// Same signatures as the GL functions they replace. The cache is only exact if every change of this state goes through it,
+// invalidate() has to be called after GL code which does not (e.g. a library).
+// Like the GL context, it must only be used from the thread owning the context.
+class GLState {
+public:
+	struct Stats {
+		uint64_t issued;
+		uint64_t skipped;
+	};
+
+	static void enable(GLenum capability);
+	static void disable(GLenum capability);
+	static void depthFunc(GLenum func);
+	static void depthMask(GLboolean flag);
+	static void cullFace(GLenum mode);
+	static void frontFace(GLenum mode);
+	static void blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+	static void bindFramebuffer(GLenum target, GLuint framebuffer);
+	static void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+	static void useProgram(GLuint program);
+	static void activeTexture(GLenum unit);
+	static void bindTexture(GLenum target, GLuint texture);
+	static void bindVertexArray(GLuint vertexArray);
+
+	// Deleting a bound object resets its binding to 0, the cache has to follow
+	static void deleteTextures(GLsizei count, const GLuint* textures);
+	static void deleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+	static void deleteFramebuffers(GLsizei count, const GLuint* framebuffers);
+	static void deleteProgram(GLuint program);
+
+	// Forgets the cached state, the next calls are all issued
+	static void invalidate();
+
+	// Ends the frame: getStats() returns the counts of the frame which just ended
+	static void nextFrame();
+	static const Stats& getStats();
+	static void showStats();
+private:
+	static constexpr GLuint UNKNOWN = 0xFFFFFFFF;
+	static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+	enum Capability { DEPTH_TEST, CULL_FACE, BLEND, STENCIL_TEST, SCISSOR_TEST, MULTISAMPLE, FRAMEBUFFER_SRGB, PROGRAM_POINT_SIZE, CAPABILITY_COUNT };
+	enum TextureTarget { TEXTURE_2D, TEXTURE_CUBE_MAP, TEXTURE_2D_ARRAY, TEXTURE_2D_MULTISAMPLE, TEXTURE_3D, TEXTURE_TARGET_COUNT };
+
+	static std::array<GLuint, CAPABILITY_COUNT> capabilities; // 0, 1 or UNKNOWN
+	static GLuint depthFuncValue;
+	static GLuint depthMaskValue;
+	static GLuint cullFaceValue;
+	static GLuint frontFaceValue;
+	static std::array<GLuint, 2> blendFuncValue;
+	static GLuint drawFramebuffer;
+	static GLuint readFramebuffer;
+	static std::array<GLint, 4> viewportValue;
+	static bool isViewportKnown;
+	static GLuint program;
+	static GLuint activeUnit; // index of the unit, not GL_TEXTUREi
+	static std::array<std::array<GLuint, TEXTURE_TARGET_COUNT>, MAX_TEXTURE_UNITS> textures;
+	static GLuint vertexArray;
+
+	static Stats frameStats;
+	static Stats lastFrameStats;
+
+	static int getCapabilityIndex(GLenum capability);
+	static int getTextureTargetIndex(GLenum target);
+	static void setCapability(GLenum capability, bool isEnabled);
+	// Updates the cached value and returns true if the call has to be issued
+	static bool update(GLuint& cached, GLuint value);
+};
@@ -0,0 +1,396 @@
+#include "glyphCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "glad/glad.h"
+#include "ft2build.h"
+#include FT_FREETYPE_H
+
+#include "glState.h"
+
+GlyphCache::GlyphCache(const std::string& fontPath, unsigned int pixelSize, unsigned int spread, unsigned int initialAtlasSize, unsigned int maxAtlasSize)
+	: library(nullptr), face(nullptr), pixelSize(pixelSize), spread(spread), glyphSize(pixelSize), cellSize(pixelSize + 2 * spread), atlasSize(0), maxAtlasSize(0),
+	texture(0), generation(0), frame(0), stats()
+{
+	if (FT_Init_FreeType(&library))
+	{
+		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+		library = nullptr;
+		return;
+	}
+	if (FT_New_Face(library, fontPath.c_str(), 0, &face))
+	{
+		std::cout << "ERROR::FREETYPE: Failed to load font " << fontPath << std::endl;
+		face = nullptr;
+		return;
+	}
+	FT_Select_Charmap(face, FT_ENCODING_UNICODE);
+	FT_Set_Pixel_Sizes(face, 0, pixelSize);
+	if (FT_IS_SCALABLE(face))
+	{
+		// the bounding box of all the glyphs at this size, in 26.6 fixed point, and a pixel for the rounding of the bitmap bounds
+		const FT_Pos bboxWidth = FT_MulFix(face->bbox.xMax - face->bbox.xMin, face->size->metrics.x_scale);
+		const FT_Pos bboxHeight = FT_MulFix(face->bbox.yMax - face->bbox.yMin, face->size->metrics.y_scale);
+		glyphSize = std::max(pixelSize, static_cast<unsigned int>((std::max(bboxWidth, bboxHeight) + 63) / 64) + 1);
+		cellSize = glyphSize + 2 * spread;
+	}
+	// the atlas holds at least one cell
+	this->maxAtlasSize = std::max(maxAtlasSize, cellSize);
+	this->atlasSize = std::clamp(initialAtlasSize, cellSize, this->maxAtlasSize);
+
+	glGenTextures(1, &texture);
+	GLState::bindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasSize, atlasSize, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	const unsigned int cellsPerRow = atlasSize / cellSize;
+	for (unsigned int y = cellsPerRow; y-- > 0;)
+	{
+		for (unsigned int x = cellsPerRow; x-- > 0;)
+		{
+			freeCells.push_back(y * (this->maxAtlasSize / cellSize) + x);
+		}
+	}
+	stats.atlasSize = atlasSize;
+}
+
+GlyphCache::~GlyphCache()
+{
+	GLState::deleteTextures(1, &texture);
+	if (face != nullptr)
+	{
+		FT_Done_Face(face);
+	}
+	if (library != nullptr)
+	{
+		FT_Done_FreeType(library);
+	}
+}
+
+bool GlyphCache::isLoaded() const
+{
+	return face != nullptr;
+}
+
+const SDFGlyph& GlyphCache::getGlyph(char32_t codePoint)
+{
+	const auto it = entries.find(codePoint);
+	if (it == entries.end())
+	{
+		stats.misses++;
+		return addGlyph(codePoint);
+	}
+
+	stats.hits++;
+	Entry& entry = it->second;
+	entry.lastUsedFrame = frame;
+	if (entry.cell != NO_CELL)
+	{
+		lru.splice(lru.begin(), lru, entry.lruPosition);
+	}
+	return entry.glyph;
+}
+
+uint64_t GlyphCache::getGeneration() const
+{
+	return generation;
+}
+
+void GlyphCache::nextFrame()
+{
+	frame++;
+}
+
+unsigned int GlyphCache::getTexture() const
+{
+	return texture;
+}
+
+float GlyphCache::getPixelSize() const
+{
+	return static_cast<float>(pixelSize);
+}
+
+float GlyphCache::getSpread() const
+{
+	return static_cast<float>(spread);
+}
+
+float GlyphCache::getLineHeight() const
+{
+	return face != nullptr ? face->size->metrics.height / 64.0f : 0.0f;
+}
+
+float GlyphCache::getAscender() const
+{
+	return face != nullptr ? face->size->metrics.ascender / 64.0f : 0.0f;
+}
+
+const GlyphCache::Stats& GlyphCache::getStats() const
+{
+	return stats;
+}
+
+void GlyphCache::showStats() const
+{
+	std::cout << "Glyph cache: " << stats.cachedGlyphs << " glyphs in a " << stats.atlasSize << "x" << stats.atlasSize << " atlas, "
+		<< stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions << " evictions" << std::endl;
+}
+
+std::u32string GlyphCache::decodeUTF8(const std::string& text)
+{
+	const char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+	std::u32string codePoints;
+	codePoints.reserve(text.size());
+	size_t i = 0;
+	while (i < text.size())
+	{
+		const unsigned char lead = static_cast<unsigned char>(text[i]);
+		unsigned int length = 0;
+		char32_t codePoint = 0;
+		char32_t minimum = 0;
+		if (lead < 0x80) { length = 1; codePoint = lead; }
+		else if ((lead & 0xE0) == 0xC0) { length = 2; codePoint = lead & 0x1F; minimum = 0x80; }
+		else if ((lead & 0xF0) == 0xE0) { length = 3; codePoint = lead & 0x0F; minimum = 0x800; }
+		else if ((lead & 0xF8) == 0xF0) { length = 4; codePoint = lead & 0x07; minimum = 0x10000; }
+
+		bool isValid = length > 0 && i + length <= text.size();
+		for (unsigned int j = 1; isValid && j < length; j++)
+		{
+			const unsigned char continuation = static_cast<unsigned char>(text[i + j]);
+			isValid = (continuation & 0xC0) == 0x80;
+			codePoint = (codePoint << 6) | (continuation & 0x3F);
+		}
+		// overlong encodings, surrogates and values past the last code point
+		isValid = isValid && codePoint >= minimum && codePoint <= 0x10FFFF && (codePoint < 0xD800 || codePoint > 0xDFFF);
+
+		codePoints.push_back(isValid ? codePoint : REPLACEMENT_CHARACTER);
+		i += isValid ? length : 1;
+	}
+	return codePoints;
+}
+
+const SDFGlyph& GlyphCache::addGlyph(char32_t codePoint)
+{
+	Entry entry = {};
+	entry.cell = NO_CELL;
+	entry.lastUsedFrame = frame;
+	entry.lruPosition = lru.end();
+
+	// the code points missing from the font get the .notdef glyph
+	if (face == nullptr || FT_Load_Char(face, codePoint, FT_LOAD_RENDER))
+	{
+		if (face != nullptr)
+		{
+			std::cout << "ERROR::FREETYPE: Failed to load Glyph " << static_cast<uint32_t>(codePoint) << std::endl;
+		}
+		return entries.emplace(codePoint, entry).first->second.glyph;
+	}
+
+	const FT_GlyphSlot slot = face->glyph;
+	entry.glyph.advance = slot->advance.x / 64.0f;
+	if (slot->bitmap.width > 0 && slot->bitmap.rows > 0)
+	{
+		// the cells fit the bounding box of the face, only a glyph outside of it (a broken font) is cropped
+		const int maxGlyphSize = static_cast<int>(glyphSize);
+		const int width = std::min(static_cast<int>(slot->bitmap.width), maxGlyphSize);
+		const int height = std::min(static_cast<int>(slot->bitmap.rows), maxGlyphSize);
+		const std::vector<unsigned char> field = computeDistanceField(slot->bitmap.buffer, width, height, slot->bitmap.pitch, spread);
+		const int paddedWidth = width + 2 * spread;
+		const int paddedHeight = height + 2 * spread;
+
+		entry.cell = allocateCell();
+		const glm::uvec2 position = getCellPosition(entry.cell);
+		GLState::bindTexture(GL_TEXTURE_2D, texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, position.x, position.y, paddedWidth, paddedHeight, GL_RED, GL_UNSIGNED_BYTE, field.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		entry.glyph.size = glm::vec2(paddedWidth, paddedHeight);
+		entry.glyph.bearing = glm::vec2(slot->bitmap_left - static_cast<int>(spread), slot->bitmap_top + static_cast<int>(spread));
+		lru.push_front(codePoint);
+		entry.lruPosition = lru.begin();
+		updateUVs(entry);
+		stats.cachedGlyphs++;
+	}
+	return entries.emplace(codePoint, entry).first->second.glyph;
+}
+
+unsigned int GlyphCache::allocateCell()
+{
+	if (freeCells.empty() && atlasSize * 2 <= maxAtlasSize)
+	{
+		growAtlas();
+	}
+	if (!freeCells.empty())
+	{
+		const unsigned int cell = freeCells.back();
+		freeCells.pop_back();
+		return cell;
+	}
+
+	// the least recently used glyph gives its cell away, it is rasterized again on its next use
+	const char32_t evicted = lru.back();
+	lru.pop_back();
+	const auto it = entries.find(evicted);
+	const unsigned int cell = it->second.cell;
+	if (it->second.lastUsedFrame == frame)
+	{
+		std::cout << "ERROR::GLYPH_CACHE::ATLAS_FULL: Glyphs drawn this frame are evicted, increase the maximum atlas size" << std::endl;
+	}
+	entries.erase(it);
+	generation++;
+	stats.evictions++;
+	stats.cachedGlyphs--;
+	return cell;
+}
+
+void GlyphCache::growAtlas()
+{
+	const unsigned int newSize = atlasSize * 2;
+	unsigned int newTexture;
+	glGenTextures(1, &newTexture);
+	GLState::bindTexture(GL_TEXTURE_2D, newTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, newSize, newSize, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// the cells keep their position, the glyphs are copied on the GPU
+	glCopyImageSubData(texture, GL_TEXTURE_2D, 0, 0, 0, 0, newTexture, GL_TEXTURE_2D, 0, 0, 0, 0, atlasSize, atlasSize, 1);
+	GLState::deleteTextures(1, &texture);
+	texture = newTexture;
+
+	const unsigned int oldCellsPerRow = atlasSize / cellSize;
+	const unsigned int newCellsPerRow = newSize / cellSize;
+	const unsigned int maxCellsPerRow = maxAtlasSize / cellSize;
+	for (unsigned int y = newCellsPerRow; y-- > 0;)
+	{
+		for (unsigned int x = newCellsPerRow; x-- > 0;)
+		{
+			if (x >= oldCellsPerRow || y >= oldCellsPerRow)
+			{
+				freeCells.push_back(y * maxCellsPerRow + x);
+			}
+		}
+	}
+	atlasSize = newSize;
+	stats.atlasSize = atlasSize;
+	for (auto& [codePoint, entry] : entries)
+	{
+		if (entry.cell != NO_CELL)
+		{
+			updateUVs(entry);
+		}
+	}
+	generation++;
+}
+
+glm::uvec2 GlyphCache::getCellPosition(unsigned int cell) const
+{
+	// the index of a cell does not depend on the atlas size, so that it survives a growth
+	const unsigned int maxCellsPerRow = maxAtlasSize / cellSize;
+	return glm::uvec2(cell % maxCellsPerRow, cell / maxCellsPerRow) * cellSize;
+}
+
+void GlyphCache::updateUVs(Entry& entry) const
+{
+	const glm::vec2 position = glm::vec2(getCellPosition(entry.cell));
+	entry.glyph.uvMin = position / static_cast<float>(atlasSize);
+	entry.glyph.uvMax = (position + entry.glyph.size) / static_cast<float>(atlasSize);
+}
+
+std::vector<unsigned char> GlyphCache::computeDistanceField(const unsigned char* coverage, int width, int height, int pitch, int spread)
+{
+	const float INF = 1e20f;
+	const int paddedWidth = width + 2 * spread;
+	const int paddedHeight = height + 2 * spread;
+	const int size = paddedWidth * paddedHeight;
+	const int maxLength = std::max(paddedWidth, paddedHeight);
+
+	// squared distances to the closest inside pixel, then to the closest outside pixel
+	std::vector<float> toInside(size, INF);
+	std::vector<float> toOutside(size, 0.0f);
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char* row = pitch >= 0 ? coverage + y * pitch : coverage + (height - 1 - y) * -pitch;
+		for (int x = 0; x < width; x++)
+		{
+			if (row[x] >= 128)
+			{
+				const int index = (y + spread) * paddedWidth + x + spread;
+				toInside[index] = 0.0f;
+				toOutside[index] = INF;
+			}
+		}
+	}
+
+	std::vector<float> f(maxLength);
+	std::vector<float> d(maxLength);
+	std::vector<int> v(maxLength);
+	std::vector<float> z(maxLength + 1);
+	for (std::vector<float>* distances : { &toInside, &toOutside })
+	{
+		std::vector<float>& grid = *distances;
+		// columns then rows, the 2D transform is separable
+		for (int x = 0; x < paddedWidth; x++)
+		{
+			for (int y = 0; y < paddedHeight; y++)
+				f[y] = grid[y * paddedWidth + x];
+			distanceTransform(f.data(), d.data(), paddedHeight, v, z);
+			for (int y = 0; y < paddedHeight; y++)
+				grid[y * paddedWidth + x] = d[y];
+		}
+		for (int y = 0; y < paddedHeight; y++)
+		{
+			std::copy_n(grid.begin() + y * paddedWidth, paddedWidth, f.begin());
+			distanceTransform(f.data(), d.data(), paddedWidth, v, z);
+			std::copy_n(d.begin(), paddedWidth, grid.begin() + y * paddedWidth);
+		}
+	}
+
+	// the edge lies half a pixel from the centers of the pixels on each side of it
+	std::vector<unsigned char> field(size);
+	for (int i = 0; i < size; i++)
+	{
+		const float distance = toInside[i] > 0.0f ? std::sqrt(toInside[i]) - 0.5f : -(std::sqrt(toOutside[i]) - 0.5f);
+		const float value = 0.5f - distance / (2.0f * spread);
+		field[i] = static_cast<unsigned char>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+	return field;
+}
+
+void GlyphCache::distanceTransform(const float* f, float* d, int n, std::vector<int>& v, std::vector<float>& z)
+{
+	// lower envelope of the parabolas rooted at the samples (Felzenszwalb and Huttenlocher)
+	int k = 0;
+	v[0] = 0;
+	z[0] = -std::numeric_limits<float>::infinity();
+	z[1] = std::numeric_limits<float>::infinity();
+	for (int q = 1; q < n; q++)
+	{
+		float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+		while (s <= z[k])
+		{
+			k--;
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = std::numeric_limits<float>::infinity();
+	}
+	k = 0;
+	for (int q = 0; q < n; q++)
+	{
+		while (z[k + 1] < q)
+			k++;
+		d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+// Glyph of a GlyphCache, in pixels of the rasterization size: scale by fontSize / getPixelSize() to draw
+struct SDFGlyph {
+	glm::vec2 uvMin; // top left corner in the atlas
+	glm::vec2 uvMax; // bottom right corner in the atlas
+	glm::vec2 size; // size of the quad, the distance field's padding included
+	glm::vec2 bearing; // offset from the pen position on the baseline to the left/top of the quad
+	float advance; // horizontal offset to the next glyph
+};
+
+// Signed distance fields of the glyphs of a font, rasterized once on their first use for any code point.
+// A glyph takes a fixed size cell of a single channel atlas: the atlas doubles when it is full,
+// up to its maximum size, then the least recently used glyphs are evicted.
+// One rasterization is drawn at any scale, the edge is at 0.5 and the field covers +-spread pixels around it.
+class GlyphCache
+{
+public:
+	static const unsigned int DEFAULT_PIXEL_SIZE = 48;
+	static const unsigned int DEFAULT_SPREAD = 8;
+
+	struct Stats {
+		unsigned int hits;
+		unsigned int misses;
+		unsigned int evictions;
+		unsigned int cachedGlyphs;
+		unsigned int atlasSize;
+	};
+
+	GlyphCache(const std::string& fontPath, unsigned int pixelSize = DEFAULT_PIXEL_SIZE, unsigned int spread = DEFAULT_SPREAD,
+		unsigned int initialAtlasSize = 512, unsigned int maxAtlasSize = 2048);
+	~GlyphCache();
+	GlyphCache(const GlyphCache& other) = delete;
+	GlyphCache& operator=(const GlyphCache& other) = delete;
+
+	bool isLoaded() const;
+	// Rasterizes the glyph on a miss. The reference is valid until the next call.
+	const SDFGlyph& getGlyph(char32_t codePoint);
+	// Changes when the atlas grows or a glyph is evicted: the UVs of the glyphs kept by the caller are then out of date
+	uint64_t getGeneration() const;
+	// Glyphs used during the current frame are only evicted if there is no other choice
+	void nextFrame();
+
+	unsigned int getTexture() const;
+	float getPixelSize() const;
+	float getSpread() const;
+	// distance between two baselines, and from the top of a line to its baseline
+	float getLineHeight() const;
+	float getAscender() const;
+
+	const Stats& getStats() const;
+	void showStats() const;
+
+	// Invalid sequences are decoded as U+FFFD
+	static std::u32string decodeUTF8(const std::string& text);
+private:
+	static const unsigned int NO_CELL = 0xFFFFFFFF;
+
+	struct Entry {
+		SDFGlyph glyph;
+		unsigned int cell; // NO_CELL for the glyphs without any pixel, like spaces
+		uint64_t lastUsedFrame;
+		std::list<char32_t>::iterator lruPosition;
+	};
+
+	FT_LibraryRec_* library;
+	FT_FaceRec_* face;
+	unsigned int pixelSize;
+	unsigned int spread;
+	// largest glyph bitmap of the face, a cell adds spread pixels on every side
+	unsigned int glyphSize;
+	unsigned int cellSize;
+	unsigned int atlasSize;
+	unsigned int maxAtlasSize;
+	unsigned int texture;
+
+	std::unordered_map<char32_t, Entry> entries;
+	// glyphs with a cell, the most recently used first
+	std::list<char32_t> lru;
+	std::vector<unsigned int> freeCells;
+	uint64_t generation;
+	uint64_t frame;
+	Stats stats;
+
+	const SDFGlyph& addGlyph(char32_t codePoint);
+	unsigned int allocateCell();
+	void growAtlas();
+	glm::uvec2 getCellPosition(unsigned int cell) const;
+	void updateUVs(Entry& entry) const;
+	// Distance field of a coverage bitmap, padded by spread pixels on every side
+	static std::vector<unsigned char> computeDistanceField(const unsigned char* coverage, int width, int height, int pitch, int spread);
+	// Squared distance transform of a sampled function, f and d may not alias
+	static void distanceTransform(const float* f, float* d, int n, std::vector<int>& v, std::vector<float>& z);
+};
\ No newline at end of file
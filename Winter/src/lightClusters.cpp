@@ -0,0 +1,152 @@
+#include "lightClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "glm/gtc/type_ptr.hpp"
+
+#include "pathManager.h"
+
+// Same local sizes as the compute shaders
+const unsigned int BOUNDS_GROUP_SIZE = 64;
+const unsigned int CULL_GROUP_SIZE = 128;
+
+// Binding points shared with the lighting shaders
+const unsigned int LIGHTS_BINDING = 0;
+const unsigned int LIGHT_GRID_BINDING = 1;
+const unsigned int LIGHT_INDICES_BINDING = 2;
+const unsigned int BOUNDS_BINDING = 3;
+const unsigned int PARAMS_BINDING = 1;
+
+static size_t getUniformBufferAlignment()
+{
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	return static_cast<size_t>(std::max(alignment, 1));
+}
+
+LightClusters::LightClusters()
+	: boundsShader(PathManager::getShadersPath() + "clusterBounds.comp"),
+	cullShader(PathManager::getShadersPath() + "clusterCull.comp"),
+	inverseProjectionHandle(boundsShader.getUniformHandle("inverseProjection")), screenSizeHandle(boundsShader.getUniformHandle("screenSize")),
+	nearPlaneHandle(boundsShader.getUniformHandle("nearPlane")), farPlaneHandle(boundsShader.getUniformHandle("farPlane")),
+	lightCountHandle(cullShader.getUniformHandle("lightCount")),
+	lightBuffer(0), lightGridBuffer(0), lightIndexBuffer(0), boundsBuffer(0),
+	paramsAlignment(getUniformBufferAlignment()), paramsBuffer(sizeof(ClusterParams) + paramsAlignment),
+	lightCount(0), lightCapacity(0), boundsProjection(0.0f), boundsSize(0)
+{
+	glGenBuffers(1, &lightBuffer);
+	glGenBuffers(1, &lightGridBuffer);
+	glGenBuffers(1, &lightIndexBuffer);
+	glGenBuffers(1, &boundsBuffer);
+
+	// only written and read by the GPU
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightGridBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, CLUSTER_COUNT * sizeof(glm::uvec2), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightIndexBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<size_t>(CLUSTER_COUNT) * MAX_LIGHTS_PER_CLUSTER * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+	// min and max corners of each cluster
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, boundsBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, CLUSTER_COUNT * 2 * sizeof(glm::vec4), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+LightClusters::~LightClusters()
+{
+	glDeleteBuffers(1, &lightBuffer);
+	glDeleteBuffers(1, &lightGridBuffer);
+	glDeleteBuffers(1, &lightIndexBuffer);
+	glDeleteBuffers(1, &boundsBuffer);
+}
+
+void LightClusters::setLights(const std::vector<PointLight>& lights)
+{
+	lightCount = static_cast<unsigned int>(lights.size());
+	const size_t size = lights.size() * sizeof(PointLight);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+	if (size > lightCapacity || lightCapacity == 0)
+	{
+		// an empty storage block still has to be backed by a buffer
+		lightCapacity = std::max(size, sizeof(PointLight));
+		glBufferData(GL_SHADER_STORAGE_BUFFER, lightCapacity, nullptr, GL_DYNAMIC_DRAW);
+	}
+	if (size > 0)
+	{
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, lights.data());
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+unsigned int LightClusters::getLightCount() const
+{
+	return lightCount;
+}
+
+unsigned int LightClusters::getLightBuffer() const
+{
+	return lightBuffer;
+}
+
+void LightClusters::update(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, unsigned int width, unsigned int height)
+{
+	if (lightCapacity == 0)
+	{
+		setLights({});
+	}
+
+	// the slice of a view depth is log(depth) * scale - bias
+	const float logDepthRange = std::log(farPlane / nearPlane);
+	ClusterParams params;
+	params.view = view;
+	params.grid = glm::uvec4(GRID_X, GRID_Y, GRID_Z, MAX_LIGHTS_PER_CLUSTER);
+	params.depth = glm::vec4(GRID_Z / logDepthRange, GRID_Z * std::log(nearPlane) / logDepthRange,
+		static_cast<float>((width + GRID_X - 1) / GRID_X), static_cast<float>((height + GRID_Y - 1) / GRID_Y));
+	paramsBuffer.beginFrame();
+	const size_t paramsOffset = paramsBuffer.write(&params, sizeof(params), paramsAlignment);
+	glBindBufferRange(GL_UNIFORM_BUFFER, PARAMS_BINDING, paramsBuffer.getID(), paramsOffset, sizeof(params));
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHTS_BINDING, lightBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_GRID_BINDING, lightGridBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_INDICES_BINDING, lightIndexBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BOUNDS_BINDING, boundsBuffer);
+
+	const glm::uvec2 size(width, height);
+	if (projection != boundsProjection || size != boundsSize)
+	{
+		boundsShader.use();
+		boundsShader.setMat4(inverseProjectionHandle, glm::value_ptr(glm::inverse(projection)));
+		boundsShader.setVec2(screenSizeHandle, glm::vec2(size));
+		boundsShader.setFloat(nearPlaneHandle, nearPlane);
+		boundsShader.setFloat(farPlaneHandle, farPlane);
+		boundsShader.dispatch((CLUSTER_COUNT + BOUNDS_GROUP_SIZE - 1) / BOUNDS_GROUP_SIZE);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		boundsProjection = projection;
+		boundsSize = size;
+	}
+
+	cullShader.use();
+	cullShader.setUInt(lightCountHandle, lightCount);
+	cullShader.dispatch((CLUSTER_COUNT + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+float LightClusters::getLightRadius(const glm::vec3& color, const glm::vec3& attenuation, float cutoff)
+{
+	// solves brightest / (constant + linear * d + quadratic * d^2) = cutoff
+	const float brightest = std::max(std::max(color.r, color.g), color.b);
+	const float constant = attenuation.x - brightest / cutoff;
+	if (attenuation.z > 0.0f)
+	{
+		// no positive root when the light is dimmer than the cutoff at its center
+		const float discriminant = std::max(attenuation.y * attenuation.y - 4.0f * attenuation.z * constant, 0.0f);
+		return std::max((-attenuation.y + std::sqrt(discriminant)) / (2.0f * attenuation.z), 0.0f);
+	}
+	if (attenuation.y > 0.0f)
+	{
+		return std::max(-constant / attenuation.y, 0.0f);
+	}
+	std::cout << "ERROR::LIGHT_CLUSTERS: A light without attenuation lights every cluster" << std::endl;
+	return std::numeric_limits<float>::max();
+}
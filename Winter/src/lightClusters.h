@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "computeShader.h"
+#include "streamBuffer.h"
+
+// Same layout as the PointLight of the shaders (std430)
+struct PointLight {
+	glm::vec4 positionRadius; // world space position, and distance past which the light is culled
+	glm::vec4 color;
+	glm::vec4 attenuation; // constant, linear and quadratic terms
+};
+
+// Clustered light culling: the view frustum is split into GRID_X * GRID_Y tiles of the screen and GRID_Z slices exponential in depth,
+// and a compute pass lists the lights whose sphere touches each cluster. A lighting shader then only iterates the lights
+// of the cluster of its pixel instead of all of them, the same lists serving forward and deferred shading.
+// update() binds the buffers read by the lighting shaders:
+// storage buffers 0: lights, 1: (offset, count) per cluster, 2: light indices, 3: cluster bounds; uniform buffer 1: ClusterParams.
+// The cluster bounds are only rebuilt when the projection or the screen size change.
+class LightClusters {
+public:
+	static const unsigned int GRID_X = 16;
+	static const unsigned int GRID_Y = 9;
+	static const unsigned int GRID_Z = 24;
+	static const unsigned int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+	// the lights past it are left out of the cluster
+	static const unsigned int MAX_LIGHTS_PER_CLUSTER = 512;
+	// fraction of the brightest channel under which a light is considered out of range
+	static constexpr float DEFAULT_CUTOFF = 5.0f / 256.0f;
+
+	LightClusters();
+	~LightClusters();
+	LightClusters(const LightClusters& other) = delete;
+	LightClusters& operator=(const LightClusters& other) = delete;
+
+	void setLights(const std::vector<PointLight>& lights);
+	unsigned int getLightCount() const;
+	// Storage buffer of the lights, for the passes reading them without the clusters
+	unsigned int getLightBuffer() const;
+	// Assigns the lights to the clusters of the view, once per frame before the lighting passes
+	void update(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, unsigned int width, unsigned int height);
+
+	// Distance at which the attenuated light falls under cutoff times its brightest channel
+	static float getLightRadius(const glm::vec3& color, const glm::vec3& attenuation, float cutoff = DEFAULT_CUTOFF);
+private:
+	// Same layout as the ClusterParams uniform block (std140)
+	struct ClusterParams {
+		glm::mat4 view;
+		glm::uvec4 grid; // x, y and z cluster counts, max lights per cluster
+		glm::vec4 depth; // slice scale and bias, tile width and height in pixels
+	};
+
+	ComputeShader boundsShader;
+	ComputeShader cullShader;
+	UniformHandle inverseProjectionHandle;
+	UniformHandle screenSizeHandle;
+	UniformHandle nearPlaneHandle;
+	UniformHandle farPlaneHandle;
+	UniformHandle lightCountHandle;
+	unsigned int lightBuffer;
+	unsigned int lightGridBuffer;
+	unsigned int lightIndexBuffer;
+	unsigned int boundsBuffer;
+	// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, initialized before paramsBuffer
+	size_t paramsAlignment;
+	StreamBuffer paramsBuffer;
+	unsigned int lightCount;
+	size_t lightCapacity;
+	// projection and screen size the bounds were built for
+	glm::mat4 boundsProjection;
+	glm::uvec2 boundsSize;
+};
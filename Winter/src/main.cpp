@@ -1,5 +1,6 @@
 ﻿#include <array>
 #include <algorithm>
+#include <cctype>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -19,10 +20,16 @@
 
 #include "camera.h"
 #include "fpsCounter.h"
+#include "glState.h"
+#include "lightClusters.h"
 #include "model.h"
 #include "pathManager.h"
+#include "profiler.h"
+#include "renderQueue.h"
 #include "shader.h"
+#include "streamBuffer.h"
 #include "texture.h"
+#include "traceRecorder.h"
 
 // Time
 float deltaTime = 0.0f;
@@ -30,6 +37,7 @@ float lastFrameTime = 0.0f;
 
 // Input
 bool firstMouseInput = true;
+bool wasTraceKeyPressed = false;
 float lastMouseX = 0.0f;
 float lastMouseY = 0.0f;
 
@@ -70,6 +78,9 @@ void setShaderLights(Shader& shader);
 void renderQuad();
 void renderCube();
 void renderSphere();
+void createSphere();
+extern unsigned int sphereVAO;
+extern unsigned int indexCount;
 
 void APIENTRY glDebugOutput(GLenum source,
     GLenum type,
@@ -79,7 +90,7 @@ void APIENTRY glDebugOutput(GLenum source,
     const char* message,
     const void* userParam);
 
-int main()
+int main(int argc, char* argv[])
 {
     // Init Paths
 	PathManager::projectPath = std::filesystem::current_path().string() + "/";
@@ -89,6 +100,26 @@ int main()
     const int32_t WINDOW_WIDTH = 800;
     const int32_t WINDOW_HEIGHT = 600;
     const std::string WINDOW_TITLE = "LearnOpenGL";
+
+    // --no-render-queue-sort submits the draws in code order, to compare the state switches
+    // --trace [frames] records the first frames into trace.json, F12 starts and stops a recording at any time
+    bool sortRenderQueue = true;
+    unsigned int traceFrames = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--no-render-queue-sort")
+        {
+            sortRenderQueue = false;
+        }
+        else if (std::string(argv[i]) == "--trace")
+        {
+            traceFrames = TraceRecorder::DEFAULT_FRAME_COUNT;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+            {
+                traceFrames = static_cast<unsigned int>(std::stoul(argv[++i]));
+            }
+        }
+    }
     
     const std::string PATH_SKYBOX_VERTEX_SHADER = PathManager::getShadersPath() + "skybox.vert";
     const std::string PATH_SKYBOX_FRAGMENT_SHADER = PathManager::getShadersPath() + "skybox.frag";
@@ -139,7 +170,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    // For easy MSAA Don't forget to call: glEnable(GL_MULTISAMPLE);
+    // For easy MSAA Don't forget to call: GLState::enable(GL_MULTISAMPLE);
     // ------------------------------------
     glfwWindowHint(GLFW_SAMPLES, 4);
     // ------------------------------------
@@ -175,13 +206,13 @@ int main()
     if (flags & GL_CONTEXT_FLAG_DEBUG_BIT)
     {
         std::cout << "OpenGL Debug Context is enabled" << std::endl;
-        glEnable(GL_DEBUG_OUTPUT);
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        GLState::enable(GL_DEBUG_OUTPUT);
+        GLState::enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
         glDebugMessageCallback(glDebugOutput, nullptr);
         glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // CAMERA
     // ------------------------------------
@@ -250,13 +281,10 @@ int main()
 
     // Uniform Buffers
 	// ------------------------------------
-    unsigned int uboMatrices;
-    glGenBuffers(1, &uboMatrices);
-    glBindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
-	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), nullptr, GL_STATIC_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-	glBindBufferRange(GL_UNIFORM_BUFFER, 0, uboMatrices, 0, 2 * sizeof(glm::mat4));
+    // the matrices are written every frame, each frame's copy is bound to the binding point 0
+    GLint uniformBufferAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferAlignment);
+    StreamBuffer uboMatrices(2 * sizeof(glm::mat4) + uniformBufferAlignment);
 
     unsigned int uboIndexPBR = glGetUniformBlockIndex(pbrShader.getID(), "Matrices");
     glUniformBlockBinding(pbrShader.getID(), uboIndexPBR, 0);
@@ -278,6 +306,26 @@ int main()
         glm::vec3(300.0f, 300.0f, 300.0f),
         glm::vec3(300.0f, 300.0f, 300.0f)
     };
+    // both PBR shaders read the lights of their cluster, inverse square attenuation
+    std::vector<PointLight> pointLights;
+    for (unsigned int i = 0; i < NR_LIGHTS; i++)
+    {
+        const glm::vec3 attenuation(0.0f, 0.0f, 1.0f);
+        const float radius = LightClusters::getLightRadius(lightColors[i], attenuation);
+        pointLights.push_back({ glm::vec4(lightPositions[i], radius), glm::vec4(lightColors[i], 1.0f), glm::vec4(attenuation, 0.0f) });
+    }
+    LightClusters lightClusters;
+    lightClusters.setLights(pointLights);
+    // Resolve the uniforms set in the render loop once instead of looking them up by name every frame
+    const UniformHandle pbrModelHandle = pbrShader.getUniformHandle("model");
+    const UniformHandle pbrNormalMatrixHandle = pbrShader.getUniformHandle("normalMatrix");
+    const UniformHandle pbrAlbedoHandle = pbrShader.getUniformHandle("albedo");
+    const UniformHandle pbrMetallicHandle = pbrShader.getUniformHandle("metallic");
+    const UniformHandle pbrRoughnessHandle = pbrShader.getUniformHandle("roughness");
+    const UniformHandle pbrAOHandle = pbrShader.getUniformHandle("ao");
+    const UniformHandle pbrTextureModelHandle = pbrTextureShader.getUniformHandle("model");
+    const UniformHandle pbrTextureNormalMatrixHandle = pbrTextureShader.getUniformHandle("normalMatrix");
+
     // Models and Meshes
 	// ------------------------------------
     Mesh quad = createQuad();
@@ -287,9 +335,15 @@ int main()
 
     // Pre-Render
 	// ------------------------------------
+    if (traceFrames > 0)
+    {
+        TraceRecorder::start(PathManager::projectPath + "trace.json", traceFrames);
+    }
 
     // Enable seamless cubemap sampling for lower mip levels in the pre-filter map.
-    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    GLState::enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    // the precompute is profiled as a part of the first frame
+    Profiler::beginScope("IBL precompute");
 
 	// Map the HDR equirectangular environment map to a cubemap
     glm::mat4 captureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
@@ -310,14 +364,14 @@ int main()
     glGenFramebuffers(1, &captureFBO);
     glGenRenderbuffers(1, &captureRBO);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, cubemapSize, cubemapSize);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
 
     unsigned int envCubemap;
     glGenTextures(1, &envCubemap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
     for (unsigned int i = 0; i < 6; ++i)
     {
         // note that we store each face with 16 bit floating point values
@@ -333,11 +387,12 @@ int main()
     equirectangularToCubemapShader.use();
     equirectangularToCubemapShader.setInt("equirectangularMap", 0);
     equirectangularToCubemapShader.setMat4("projection", value_ptr(captureProjection));
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, hdrTexture);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, hdrTexture);
 
-    glViewport(0, 0, cubemapSize, cubemapSize); // don't forget to configure the viewport to the capture dimensions.
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    Profiler::beginScope("Equirectangular to cubemap");
+    GLState::viewport(0, 0, cubemapSize, cubemapSize); // don't forget to configure the viewport to the capture dimensions.
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     for (unsigned int i = 0; i < 6; ++i)
     {
         equirectangularToCubemapShader.setMat4("view", value_ptr(captureViews[i]));
@@ -346,12 +401,13 @@ int main()
 
         renderCube(); // renders a 1x1 cube
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    Profiler::endScope();
 
 
     unsigned int irradianceMap;
     glGenTextures(1, &irradianceMap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
     for (unsigned int i = 0; i < 6; ++i)
     {
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 32, 32, 0, GL_RGB, GL_FLOAT, nullptr);
@@ -362,7 +418,7 @@ int main()
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
 
@@ -370,11 +426,12 @@ int main()
     irradianceShader.use();
     irradianceShader.setInt("environmentMap", 0);
     irradianceShader.setMat4("projection", value_ptr(captureProjection));
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
-    glViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    Profiler::beginScope("Irradiance convolution");
+    GLState::viewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     for (unsigned int i = 0; i < 6; ++i)
     {
         irradianceShader.setMat4("view", value_ptr(captureViews[i]));
@@ -383,12 +440,13 @@ int main()
 
         renderCube();
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    Profiler::endScope();
 
 
     unsigned int prefilterMap;
     glGenTextures(1, &prefilterMap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
     for (unsigned int i = 0; i < 6; ++i)
     {
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 128, 128, 0, GL_RGB, GL_FLOAT, nullptr);
@@ -406,10 +464,11 @@ int main()
     prefilterShader.use();
     prefilterShader.setInt("environmentMap", 0);
     prefilterShader.setMat4("projection", value_ptr(captureProjection));
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    Profiler::beginScope("Prefilter");
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     unsigned int maxMipLevels = 5;
     for (unsigned int mip = 0; mip < maxMipLevels; ++mip)
     {
@@ -418,7 +477,7 @@ int main()
         unsigned int mipHeight = static_cast<unsigned int>(128 * std::pow(0.5, mip));
         glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
-        glViewport(0, 0, mipWidth, mipHeight);
+        GLState::viewport(0, 0, mipWidth, mipHeight);
 
         float roughness = (float)mip / (float)(maxMipLevels - 1);
         prefilterShader.setFloat("roughness", roughness);
@@ -431,7 +490,8 @@ int main()
             renderCube();
         }
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    Profiler::endScope();
 
     // pbr: generate a 2D LUT from the BRDF equations used.
     // ----------------------------------------------------
@@ -439,7 +499,7 @@ int main()
     glGenTextures(1, &brdfLUTTexture);
 
     // pre-allocate enough memory for the LUT texture.
-    glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+    GLState::bindTexture(GL_TEXTURE_2D, brdfLUTTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, 512, 512, 0, GL_RG, GL_FLOAT, 0);
     // be sure to set wrapping mode to GL_CLAMP_TO_EDGE
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -448,17 +508,20 @@ int main()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     // then re-configure capture framebuffer object and render screen-space quad with BRDF shader.
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUTTexture, 0);
 
-    glViewport(0, 0, 512, 512);
+    Profiler::beginScope("BRDF LUT");
+    GLState::viewport(0, 0, 512, 512);
     brdfShader.use();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     renderQuad();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    Profiler::endScope();
+    Profiler::endScope();
 
 
     // Render Loop
@@ -467,10 +530,38 @@ int main()
     FPSCounter fpsCounter(1.0f);
     unsigned int frameCount = 0;
 
+    // Render queue, the materials are registered once, the draws every frame
+    RenderQueue renderQueue;
+    renderQueue.setSortEnabled(sortRenderQueue);
+    createSphere();
+    const std::vector<TextureBinding> iblTextures = {
+        { 0, GL_TEXTURE_CUBE_MAP, irradianceMap },
+        { 1, GL_TEXTURE_CUBE_MAP, prefilterMap },
+        { 2, GL_TEXTURE_2D, brdfLUTTexture }
+    };
+    const uint32_t iblMaterial = renderQueue.addMaterial(RenderMaterial{ iblTextures });
+    const std::array<std::array<unsigned int, 5>, 5> pbrTextureSets = { {
+        { rustedIronAlbedoMap, rustedIronNormalMap, rustedIronMetallicMap, rustedIronRoughnessMap, rustedIronAOMap },
+        { goldAlbedoMap, goldNormalMap, goldMetallicMap, goldRoughnessMap, goldAOMap },
+        { grassAlbedoMap, grassNormalMap, grassMetallicMap, grassRoughnessMap, grassAOMap },
+        { plasticAlbedoMap, plasticNormalMap, plasticMetallicMap, plasticRoughnessMap, plasticAOMap },
+        { wallAlbedoMap, wallNormalMap, wallMetallicMap, wallRoughnessMap, wallAOMap }
+    } };
+    std::vector<uint32_t> texturedMaterials;
+    for (const auto& textureSet : pbrTextureSets)
+    {
+        RenderMaterial material{ iblTextures };
+        for (unsigned int i = 0; i < textureSet.size(); i++)
+        {
+            material.textures.push_back({ 3 + i, GL_TEXTURE_2D, textureSet[i] });
+        }
+        texturedMaterials.push_back(renderQueue.addMaterial(material));
+    }
+
 
 
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+	GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
     while (!glfwWindowShouldClose(window))
     {
         frameCount++;
@@ -480,24 +571,27 @@ int main()
 		if (frameCount % 60 == 0)
 		{
 			fpsCounter.showFPS();
+			GLState::showStats();
+			uboMatrices.showStats("Matrices");
+			Profiler::showStats();
 		}
         // input
         processInput(window);
 
         // rendering commands
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(0.0f, 0.5f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
-        glEnable(GL_MULTISAMPLE);
-        glEnable(GL_FRAMEBUFFER_SRGB);
+        GLState::enable(GL_MULTISAMPLE);
+        GLState::enable(GL_FRAMEBUFFER_SRGB);
 
         // matrixes
 		glm::mat4 model = glm::mat4(1.0f);
@@ -507,221 +601,141 @@ int main()
         glm::vec3 viewPos = camera.GetPosition();
 
 
-        glBindBuffer(GL_UNIFORM_BUFFER, uboMatrices);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(projection));
-		glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(view));
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        uboMatrices.beginFrame();
+        const glm::mat4 matrices[2] = { projection, view };
+        const size_t matricesOffset = uboMatrices.write(matrices, sizeof(matrices), uniformBufferAlignment);
+        glBindBufferRange(GL_UNIFORM_BUFFER, 0, uboMatrices.getID(), matricesOffset, sizeof(matrices));
+
+        Profiler::beginScope("Light culling");
+        lightClusters.update(view, projection, cameraNearPlane, cameraFarPlane, WINDOW_WIDTH, WINDOW_HEIGHT);
+        Profiler::endScope();
 
         // Draw scene
 		// ------------------------------------
-		// Use shader program
+        Profiler::beginScope("Scene");
+        // Uniforms shared by all the draws of a program, the per draw ones are given to the render queue
         pbrShader.use();
 		pbrShader.setVec2("texScale", glm::vec2(1.0f));
 		pbrShader.setVec3("camPos", viewPos);
-		pbrShader.setMat4("model", value_ptr(model));
-
-        glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
-
 		pbrShader.setInt("irradianceMap", 0);
 		pbrShader.setInt("prefilterMap", 1);
 		pbrShader.setInt("brdfLUT", 2);
 
-		pbrShader.setFloat("ao", 1.0f);
-		pbrShader.setFloat("metallic", 0.0f);
-		pbrShader.setFloat("roughness", 0.5f);
-		pbrShader.setVec3("albedo", glm::vec3(0.5f, 0.0f, 0.0f));
-
-        for (unsigned int i = 0; i < NR_LIGHTS; i++)
-        {
-			std::string lightName = "lightPositions[" + std::to_string(i) + "]";
-			pbrShader.setVec3(lightName, lightPositions[i]);
-			lightName = "lightColors[" + std::to_string(i) + "]";
-			pbrShader.setVec3(lightName, lightColors[i]);
-        }
+		pbrTextureShader.use();
+		pbrTextureShader.setInt("irradianceMap", 0);
+		pbrTextureShader.setInt("prefilterMap", 1);
+		pbrTextureShader.setInt("brdfLUT", 2);
+		pbrTextureShader.setInt("albedoMap", 3);
+		pbrTextureShader.setInt("normalMap", 4);
+		pbrTextureShader.setInt("metallicMap", 5);
+		pbrTextureShader.setInt("roughnessMap", 6);
+		pbrTextureShader.setInt("aoMap", 7);
+		pbrTextureShader.setVec3("camPos", viewPos);
+        pbrTextureShader.setVec2("texScale", glm::vec2(1.0f, 1.0f));
 
+        DrawItem sphereItem;
+        sphereItem.shader = &pbrShader;
+        sphereItem.material = iblMaterial;
+        sphereItem.VAO = sphereVAO;
+        sphereItem.mode = GL_TRIANGLE_STRIP;
+        sphereItem.indexType = GL_UNSIGNED_INT;
+        sphereItem.count = indexCount;
 
         // Colored PBR Spheres
-        pbrShader.use();
 		int nbRows = 7;
 		int nbColumns = 7;
 		float spacing = 2.5;
         for (int row = 0; row < nbRows; ++row)
         {
-            pbrShader.setFloat("metallic", (float)row / (float)nbRows);
             for (int col = 0; col < nbColumns; ++col)
             {
-                // we clamp the roughness to 0.05 - 1.0 as perfectly smooth surfaces (roughness of 0.0) tend to look a bit off
-                // on direct lighting.
-                pbrShader.setFloat("roughness", glm::clamp((float)col / (float)nbColumns, 0.05f, 1.0f));
-                pbrShader.setFloat("ao", 1.0f);
-                pbrShader.setFloat("metallic", (float)row / (float)nbRows);
-                pbrShader.setVec3("albedo", glm::vec3(0.5f, 0.0f, 0.0f));
-
                 model = glm::mat4(1.0f);
                 model = glm::translate(model, glm::vec3((col - (nbColumns / 2)) * spacing, (row - (nbRows / 2)) * spacing, 0.0f));
-                pbrShader.setMat4("model", value_ptr(model));
-                pbrShader.setMat3("normalMatrix", value_ptr(glm::transpose(glm::inverse(glm::mat3(model)))));
-                renderSphere();
+                sphereItem.depth = glm::distance(viewPos, glm::vec3(model[3]));
+                renderQueue.add(sphereItem);
+                // we clamp the roughness to 0.05 - 1.0 as perfectly smooth surfaces (roughness of 0.0) tend to look a bit off
+                // on direct lighting.
+                renderQueue.setConstant(pbrRoughnessHandle, glm::clamp((float)col / (float)nbColumns, 0.05f, 1.0f));
+                renderQueue.setConstant(pbrAOHandle, 1.0f);
+                renderQueue.setConstant(pbrMetallicHandle, (float)row / (float)nbRows);
+                renderQueue.setConstant(pbrAlbedoHandle, glm::vec3(0.5f, 0.0f, 0.0f));
+                renderQueue.setConstant(pbrModelHandle, model);
+                renderQueue.setConstant(pbrNormalMatrixHandle, glm::transpose(glm::inverse(glm::mat3(model))));
             }
         }
 		model = glm::mat4(1.0f);
 		normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
-		pbrShader.setMat4("model", value_ptr(model));
-		pbrShader.setMat3("normalMatrix", value_ptr(normalMatrix));
-        renderSphere();
-
-		// PBR Spheres with textures
-		pbrTextureShader.use();
-		pbrTextureShader.setInt("irradianceMap", 0);
-		pbrTextureShader.setInt("prefilterMap", 1);
-		pbrTextureShader.setInt("brdfLUT", 2);
-		pbrTextureShader.setInt("albedoMap", 3);
-		pbrTextureShader.setInt("normalMap", 4);
-		pbrTextureShader.setInt("metallicMap", 5);
-		pbrTextureShader.setInt("roughnessMap", 6);
-		pbrTextureShader.setInt("aoMap", 7);
-		pbrTextureShader.setVec3("camPos", viewPos);
-        pbrTextureShader.setVec2("texScale", glm::vec2(1.0f, 1.0f));
-
-        // bind pre-computed IBL data
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
-
-        // rusted iron
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, rustedIronAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, rustedIronNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, rustedIronMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, rustedIronRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, rustedIronAOMap);
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-10.0, 0.0, 13.0));
-        pbrTextureShader.setMat4("model", value_ptr(model));
-        pbrTextureShader.setMat3("normalMatrix", value_ptr(glm::transpose(glm::inverse(glm::mat3(model)))));
-        renderSphere();
-
-        // gold
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, goldAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, goldNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, goldMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, goldRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, goldAOMap);
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-10.0, 0.0, 10.0));
-        pbrTextureShader.setMat4("model", value_ptr(model));
-        pbrTextureShader.setMat3("normalMatrix", value_ptr(glm::transpose(glm::inverse(glm::mat3(model)))));
-        renderSphere();
-
-        // grass
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, grassAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, grassNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, grassMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, grassRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, grassAOMap);
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-10.0, 0.0, 7.0));
-        pbrTextureShader.setMat4("model", value_ptr(model));
-        pbrTextureShader.setMat3("normalMatrix", value_ptr(glm::transpose(glm::inverse(glm::mat3(model)))));
-        renderSphere();
-
-        // plastic
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, plasticAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, plasticNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, plasticMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, plasticRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, plasticAOMap);
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-10.0, 0.0, 4.0));
-        pbrTextureShader.setMat4("model", value_ptr(model));
-        pbrTextureShader.setMat3("normalMatrix", value_ptr(glm::transpose(glm::inverse(glm::mat3(model)))));
-        renderSphere();
-
-        // wall
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, wallAlbedoMap);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, wallNormalMap);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, wallMetallicMap);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, wallRoughnessMap);
-        glActiveTexture(GL_TEXTURE7);
-        glBindTexture(GL_TEXTURE_2D, wallAOMap);
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-10.0, 0.0, 1.0));
-        pbrTextureShader.setMat4("model", value_ptr(model));
-        pbrTextureShader.setMat3("normalMatrix", value_ptr(glm::transpose(glm::inverse(glm::mat3(model)))));
-        renderSphere();
-
+        sphereItem.depth = glm::distance(viewPos, glm::vec3(model[3]));
+        renderQueue.add(sphereItem);
+        renderQueue.setConstant(pbrRoughnessHandle, 0.5f);
+        renderQueue.setConstant(pbrAOHandle, 1.0f);
+        renderQueue.setConstant(pbrMetallicHandle, 0.0f);
+        renderQueue.setConstant(pbrAlbedoHandle, glm::vec3(0.5f, 0.0f, 0.0f));
+        renderQueue.setConstant(pbrModelHandle, model);
+        renderQueue.setConstant(pbrNormalMatrixHandle, normalMatrix);
+
+		// PBR Spheres with textures: rusted iron, gold, grass, plastic and wall
+        sphereItem.shader = &pbrTextureShader;
+        for (unsigned int i = 0; i < texturedMaterials.size(); i++)
+        {
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(-10.0, 0.0, 13.0 - 3.0 * i));
+            sphereItem.material = texturedMaterials[i];
+            sphereItem.depth = glm::distance(viewPos, glm::vec3(model[3]));
+            renderQueue.add(sphereItem);
+            renderQueue.setConstant(pbrTextureModelHandle, model);
+            renderQueue.setConstant(pbrTextureNormalMatrixHandle, glm::transpose(glm::inverse(glm::mat3(model))));
+        }
 
-        pbrShader.use();
         // Render lights
+        sphereItem.shader = &pbrShader;
+        sphereItem.material = iblMaterial;
         for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
         {
-            glm::vec3 newPos = lightPositions[i];
-            pbrShader.setVec3("lightPositions[" + std::to_string(i) + "]", newPos);
-            pbrShader.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
-
             model = glm::mat4(1.0f);
-            model = glm::translate(model, newPos);
+            model = glm::translate(model, lightPositions[i]);
             model = glm::scale(model, glm::vec3(0.5f));
-            pbrShader.setMat4("model", value_ptr(model));
-            pbrShader.setMat3("normalMatrix", value_ptr(glm::transpose(glm::inverse(glm::mat3(model)))));
-			pbrShader.setVec3("albedo", lightColors[i]);
-            renderSphere();
+            sphereItem.depth = glm::distance(viewPos, lightPositions[i]);
+            renderQueue.add(sphereItem);
+            renderQueue.setConstant(pbrRoughnessHandle, 0.5f);
+            renderQueue.setConstant(pbrAOHandle, 1.0f);
+            renderQueue.setConstant(pbrMetallicHandle, 0.0f);
+            renderQueue.setConstant(pbrAlbedoHandle, lightColors[i]);
+            renderQueue.setConstant(pbrModelHandle, model);
+            renderQueue.setConstant(pbrNormalMatrixHandle, glm::transpose(glm::inverse(glm::mat3(model))));
         }
 
+        renderQueue.submit();
+		if (frameCount % 60 == 0)
+		{
+			renderQueue.showStats();
+		}
+        TraceRecorder::counter("Draw calls", renderQueue.getStats().drawCalls);
+        TraceRecorder::counter("Bytes uploaded", static_cast<double>(uboMatrices.getStats().frameBytes));
+        Profiler::endScope();
 
         // Skybox
-        glDepthFunc(GL_LEQUAL);
-		glCullFace(GL_FRONT);
+        Profiler::beginScope("Skybox");
+        GLState::depthFunc(GL_LEQUAL);
+		GLState::cullFace(GL_FRONT);
 
 		skyboxShader.use();
 		skyboxShader.setMat4("view", value_ptr(view));
 		skyboxShader.setMat4("projection", value_ptr(projection));
 		skyboxShader.setInt("skybox", 0);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 		renderCube();
 
-		glCullFace(GL_BACK);
-		glDepthFunc(GL_LESS);
+		GLState::cullFace(GL_BACK);
+		GLState::depthFunc(GL_LESS);
+        Profiler::endScope();
 
         // check and call events and swap the buffers
         glfwSwapBuffers(window);
+        GLState::nextFrame();
+        TraceRecorder::counter("GL state calls", static_cast<double>(GLState::getStats().issued));
+        Profiler::nextFrame();
         glfwPollEvents();
 
         lastFrameTime = curFrameTime;
@@ -729,6 +743,7 @@ int main()
 
     // CLEANUP
     // ------------------------------------
+    Profiler::release();
 
     glfwTerminate();
 
@@ -743,6 +758,12 @@ void processInput(GLFWwindow* window)
     {
         glfwSetWindowShouldClose(window, true);
     }
+    const bool isTraceKeyPressed = glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS;
+    if (isTraceKeyPressed && !wasTraceKeyPressed)
+    {
+        TraceRecorder::toggle(PathManager::projectPath + "trace.json");
+    }
+    wasTraceKeyPressed = isTraceKeyPressed;
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
     {
 		const glm::vec3 movement = cameraSpeed * pCamera->GetFront();
@@ -777,7 +798,7 @@ void processInput(GLFWwindow* window)
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void mouseCallback(GLFWwindow* window, double xPos, double yPos)
@@ -933,7 +954,7 @@ void renderQuad()
         // configure plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        GLState::bindVertexArray(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -947,9 +968,9 @@ void renderQuad()
         glEnableVertexAttribArray(4);
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GLState::bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 unsigned int cubeVAO = 0;
@@ -1009,7 +1030,7 @@ void renderCube()
         glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
         // link vertex attributes
-        glBindVertexArray(cubeVAO);
+        GLState::bindVertexArray(cubeVAO);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
@@ -1017,12 +1038,12 @@ void renderCube()
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        GLState::bindVertexArray(0);
     }
     // render Cube
-    glBindVertexArray(cubeVAO);
+    GLState::bindVertexArray(cubeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 
@@ -1031,6 +1052,14 @@ void renderCube()
 unsigned int sphereVAO = 0;
 unsigned int indexCount;
 void renderSphere()
+{
+    createSphere();
+
+    GLState::bindVertexArray(sphereVAO);
+    glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
+}
+
+void createSphere()
 {
     if (sphereVAO == 0)
     {
@@ -1105,7 +1134,7 @@ void renderSphere()
                 data.push_back(uv[i].y);
             }
         }
-        glBindVertexArray(sphereVAO);
+        GLState::bindVertexArray(sphereVAO);
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
         glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
@@ -1118,9 +1147,6 @@ void renderSphere()
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
     }
-
-    glBindVertexArray(sphereVAO);
-    glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
 }
 
 
@@ -1,13 +1,28 @@
 #include "mesh.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 
 #include "glad/glad.h"
+#include "glState.h"
+#include "renderQueue.h"
 #include "shader.h"
 
-Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Texture>& textures)
-	: vertices(vertices), indices(indices), textures(textures), VAO(UNUSED_VAO), VBO(UNUSED_VAO), EBO(UNUSED_VAO)
+Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Texture>& textures, VertexFormat format)
+	: vertices(vertices), indices(indices), textures(textures), VAO(UNUSED_VAO), VBO(UNUSED_VAO), EBO(UNUSED_VAO), 
+	aabb(), boundingSphere(), format(format), dequantization(), indexType(GL_UNSIGNED_INT)
 {
+	computeBounds();
+	setupMesh();
+}
+
+Mesh::Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices, std::vector<Texture>&& textures, VertexFormat format)
+	: vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)), VAO(UNUSED_VAO), VBO(UNUSED_VAO), EBO(UNUSED_VAO), 
+	aabb(), boundingSphere(), format(format), dequantization(), indexType(GL_UNSIGNED_INT)
+{
+	computeBounds();
 	setupMesh();
 }
 
@@ -15,14 +30,15 @@ Mesh::~Mesh()
 {
 	if (VAO != UNUSED_VAO) // Only delete if it was initialized
 	{
-		glDeleteVertexArrays(1, &VAO);
+		GLState::deleteVertexArrays(1, &VAO);
 		glDeleteBuffers(1, &VBO);
 		glDeleteBuffers(1, &EBO);
 	}
 }
 
 Mesh::Mesh(const Mesh& other)
-	: vertices(other.vertices), indices(other.indices), textures(other.textures), VAO(0), VBO(0), EBO(0)
+	: vertices(other.vertices), indices(other.indices), textures(other.textures), VAO(0), VBO(0), EBO(0), 
+	aabb(other.aabb), boundingSphere(other.boundingSphere), format(other.format), dequantization(), indexType(GL_UNSIGNED_INT)
 {
 	setupMesh();
 }
@@ -37,6 +53,9 @@ Mesh& Mesh::operator=(const Mesh& other)
 	vertices = other.vertices;
 	indices = other.indices;
 	textures = other.textures;
+	aabb = other.aabb;
+	boundingSphere = other.boundingSphere;
+	format = other.format;
 	setupMesh();
 
 	return *this;
@@ -44,7 +63,9 @@ Mesh& Mesh::operator=(const Mesh& other)
 
 Mesh::Mesh(Mesh&& other) noexcept
 	: vertices(std::move(other.vertices)), indices(std::move(other.indices)), textures(std::move(other.textures)),
-	 VAO(other.VAO), VBO(other.VBO), EBO(other.EBO)
+	 VAO(other.VAO), VBO(other.VBO), EBO(other.EBO), 
+	 aabb(other.aabb), boundingSphere(other.boundingSphere), format(other.format), dequantization(other.dequantization), indexType(other.indexType),
+	 samplerNames(std::move(other.samplerNames))
 {
 	other.VAO = UNUSED_VAO;
 	other.VBO = UNUSED_VAO;
@@ -64,6 +85,12 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept
 	VAO = other.VAO;
 	VBO = other.VBO;
 	EBO = other.EBO;
+	aabb = other.aabb;
+	boundingSphere = other.boundingSphere;
+	format = other.format;
+	dequantization = other.dequantization;
+	indexType = other.indexType;
+	samplerNames = std::move(other.samplerNames);
 	other.VAO = UNUSED_VAO;
 	other.VBO = UNUSED_VAO;
 	other.EBO = UNUSED_VAO;
@@ -73,62 +100,163 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept
 
 void Mesh::draw(Shader& shader) const
 {
-	unsigned int diffuseNb = 0;
-	unsigned int specularNb = 0;
 	shader.use();
 	for (unsigned int i = 0; i < textures.size(); i++)
 	{
 		// bind to texture
-		glActiveTexture(GL_TEXTURE0 + i);
-		// get name in shader according to convention
-		std::string number;
-		std::string name = textures[i].type;
-		if (name == Texture::DIFFUSE_TYPENAME)
-			number = std::to_string(diffuseNb++);
-		else if (name == Texture::SPECULAR_TYPENAME)
-			number = std::to_string(specularNb++);
+		GLState::activeTexture(GL_TEXTURE0 + i);
+		shader.setInt(samplerNames[i], i);
+		GLState::bindTexture(GL_TEXTURE_2D, textures[i].id);
+	}
+	GLState::activeTexture(GL_TEXTURE0);
+	setDequantizationUniforms(shader);
+	// draw mesh, the VAO stays bound so that drawing the same mesh again does not rebind it
+	GLState::bindVertexArray(VAO);
+	glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), indexType, 0);
+}
 
-		shader.setInt(("material." + name + number).c_str(), i);
-		glBindTexture(GL_TEXTURE_2D, textures[i].id);
+void Mesh::enqueue(RenderQueue& queue, const Shader& shader, float depth, uint8_t layer) const
+{
+	DrawItem item;
+	item.layer = layer;
+	item.shader = &shader;
+	item.material = textures.empty() ? RenderQueue::NO_MATERIAL : queue.addMaterial(getRenderMaterial());
+	item.VAO = VAO;
+	item.indexType = indexType;
+	item.count = static_cast<unsigned int>(indices.size());
+	item.depth = depth;
+	queue.add(item);
+
+	for (unsigned int i = 0; i < textures.size(); i++)
+	{
+		queue.setConstant(shader.getUniformHandle(samplerNames[i]), static_cast<int>(i));
+	}
+	if (format == VertexFormat::PACKED)
+	{
+		queue.setConstant(shader.getUniformHandle("positionOffset"), dequantization.offset);
+		queue.setConstant(shader.getUniformHandle("positionScale"), dequantization.scale);
+	}
+}
+
+RenderMaterial Mesh::getRenderMaterial() const
+{
+	RenderMaterial material;
+	material.textures.reserve(textures.size());
+	for (unsigned int i = 0; i < textures.size(); i++)
+	{
+		material.textures.push_back(TextureBinding{ i, GL_TEXTURE_2D, textures[i].id });
+	}
+	return material;
+}
+
+void Mesh::setDequantizationUniforms(Shader& shader) const
+{
+	if (format == VertexFormat::PACKED)
+	{
+		shader.setVec3("positionOffset", dequantization.offset);
+		shader.setVec3("positionScale", dequantization.scale);
 	}
-	glActiveTexture(GL_TEXTURE0);
-	// draw mesh
-	glBindVertexArray(VAO);
-	glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
 }
 
 void Mesh::AddTexture(const Texture& texture)
 {
 	textures.push_back(texture);
+	updateSamplerNames();
 }
 
 void Mesh::RemoveTexture(const std::string& path)
 {
 	textures.erase(std::remove_if(textures.begin(), textures.end(), [&path](const Texture& texture) { return texture.path == path; }), textures.end());
+	updateSamplerNames();
+}
+
+VertexFormat Mesh::getFormat() const
+{
+	return format;
+}
+
+GLenum Mesh::getIndexType() const
+{
+	return indexType;
+}
+
+size_t Mesh::getGPUSize() const
+{
+	const size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+	return vertices.size() * VertexLayout::get(format).stride + indices.size() * indexSize;
+}
+
+const AABB& Mesh::getAABB() const
+{
+	return aabb;
+}
+
+const BoundingSphere& Mesh::getBoundingSphere() const
+{
+	return boundingSphere;
+}
+
+void Mesh::computeBounds()
+{
+	aabb = AABB::fromVertices(vertices);
+	boundingSphere = BoundingSphere::fromVertices(vertices, aabb);
+}
+
+void Mesh::updateSamplerNames()
+{
+	unsigned int diffuseNb = 0;
+	unsigned int specularNb = 0;
+	samplerNames.clear();
+	samplerNames.reserve(textures.size());
+	for (const Texture& texture : textures)
+	{
+		// get name in shader according to convention
+		std::string number;
+		const std::string& name = texture.type;
+		if (name == Texture::DIFFUSE_TYPENAME)
+			number = std::to_string(diffuseNb++);
+		else if (name == Texture::SPECULAR_TYPENAME)
+			number = std::to_string(specularNb++);
+		samplerNames.push_back("material." + name + number);
+	}
 }
 
 void Mesh::setupMesh()
 {
+	updateSamplerNames();
+
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
 	glGenBuffers(1, &EBO);
 
-	glBindVertexArray(VAO);
+	GLState::bindVertexArray(VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-	// vertex positions
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
-	// vertex normals
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-	// vertex texture coords
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+	if (format == VertexFormat::PACKED)
+	{
+		dequantization = VertexPacking::computeDequantization(vertices);
+		const std::vector<PackedVertex> packedVertices = VertexPacking::packVertices(vertices, dequantization);
+		glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(PackedVertex), packedVertices.data(), GL_STATIC_DRAW);
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+	}
+
+	const bool hasShortIndices = format == VertexFormat::PACKED && vertices.size() <= std::numeric_limits<uint16_t>::max();
+	if (hasShortIndices)
+	{
+		const std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+		indexType = GL_UNSIGNED_SHORT;
+	}
+	else
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+		indexType = GL_UNSIGNED_INT;
+	}
+
+	VertexLayout::get(format).apply();
 	
-	glBindVertexArray(0);
+	GLState::bindVertexArray(0);
 }
\ No newline at end of file
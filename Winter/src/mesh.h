@@ -1,13 +1,32 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "glm/glm.hpp"
 
+#include "bounds.h"
 #include "vertex.h"
+#include "vertexLayout.h"
 #include "texture.h"
 
+class RenderQueue;
 class Shader;
+struct RenderMaterial;
+
+// CPU side data of a mesh before its upload, the textures are referenced by their path relative to the model's directory
+struct MeshData {
+	struct TextureRef {
+		std::string type;
+		std::string relativePath;
+	};
+
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<TextureRef> textures;
+
+	size_t getUploadSize() const { return vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int); }
+};
 
 class Mesh {
 public:
@@ -15,7 +34,8 @@ public:
 	std::vector<unsigned int> indices;
 	std::vector<Texture> textures;
 
-	Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Texture>& textures);
+	Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Texture>& textures, VertexFormat format = VertexFormat::FLOAT);
+	Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices, std::vector<Texture>&& textures, VertexFormat format = VertexFormat::FLOAT);
 	~Mesh();
 	Mesh(const Mesh& other);
 	Mesh& operator=(const Mesh& other);
@@ -23,11 +43,34 @@ public:
 	Mesh& operator=(Mesh&& other) noexcept;
 
 	void draw(Shader& shader) const;
+	// Adds the draw to the queue instead of issuing it, the uniforms of the caller (e.g. model) can be added right after
+	void enqueue(RenderQueue& queue, const Shader& shader, float depth = 0.0f, uint8_t layer = 0) const;
+	// The textures bound to the units 0 to n, in the order of the textures
+	RenderMaterial getRenderMaterial() const;
+	// Sets positionOffset and positionScale for the shaders reading packed positions, done by draw
+	void setDequantizationUniforms(Shader& shader) const;
 	void AddTexture(const Texture& texture);
 	void RemoveTexture(const std::string& path);
+	VertexFormat getFormat() const;
+	// Type of the indices in the EBO, to give to glDrawElements
+	GLenum getIndexType() const;
+	size_t getGPUSize() const;
+	// Bounds in the mesh's space, computed at creation
+	const AABB& getAABB() const;
+	const BoundingSphere& getBoundingSphere() const;
 	unsigned int VAO, VBO, EBO;
 private:
+	AABB aabb;
+	BoundingSphere boundingSphere;
+	VertexFormat format;
+	PositionDequantization dequantization;
+	GLenum indexType;
+	// "material." + type + number of each texture, the sampler uniform bound to its unit
+	std::vector<std::string> samplerNames;
+
 	static const unsigned int UNUSED_VAO = 0;
 	
+	void computeBounds();
+	void updateSamplerNames();
 	void setupMesh();
 };
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "meshCache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+const uint32_t MeshCache::VERSION = 2;
+const std::string MeshCache::EXTENSION = ".wmesh";
+
+const char MESH_CACHE_MAGIC[4] = { 'W', 'M', 'S', 'H' };
+
+template<typename T>
+void writeCacheValue(std::ofstream& file, const T& value)
+{
+	file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool readCacheValue(std::ifstream& file, T& value)
+{
+	return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void writeCacheString(std::ofstream& file, const std::string& str)
+{
+	writeCacheValue(file, static_cast<uint32_t>(str.size()));
+	file.write(str.data(), str.size());
+}
+
+// The length is checked against what is left of the file, a corrupted one must not allocate past it
+bool readCacheString(std::ifstream& file, std::string& str, uint64_t fileSize)
+{
+	uint32_t size = 0;
+	if (!readCacheValue(file, size) || size > fileSize - static_cast<uint64_t>(file.tellg()))
+	{
+		return false;
+	}
+	str.resize(size);
+	return static_cast<bool>(file.read(str.data(), size));
+}
+
+std::string MeshCache::getCachePath(const std::string& sourcePath)
+{
+	return sourcePath + EXTENSION;
+}
+
+bool MeshCache::load(const std::string& sourcePath, uint32_t processingFlags, std::vector<MeshData>& meshes)
+{
+	SourceStamp sourceStamp;
+	if (!getSourceStamp(sourcePath, sourceStamp))
+	{
+		return false;
+	}
+
+	const std::string cachePath = getCachePath(sourcePath);
+	std::error_code error;
+	const uint64_t fileSize = std::filesystem::file_size(cachePath, error);
+	if (error)
+	{
+		return false;
+	}
+	std::ifstream file(cachePath, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	// header
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t vertexSize = 0;
+	uint32_t cacheProcessingFlags = 0;
+	SourceStamp cacheStamp;
+	uint32_t meshCount = 0;
+	file.read(magic, sizeof(magic));
+	readCacheValue(file, version);
+	readCacheValue(file, vertexSize);
+	readCacheValue(file, cacheProcessingFlags);
+	readCacheValue(file, cacheStamp.writeTime);
+	readCacheValue(file, cacheStamp.size);
+	readCacheValue(file, meshCount);
+	if (!file || !std::equal(std::begin(magic), std::end(magic), std::begin(MESH_CACHE_MAGIC)) ||
+		version != VERSION || vertexSize != sizeof(Vertex) || cacheProcessingFlags != processingFlags ||
+		cacheStamp.writeTime != sourceStamp.writeTime || cacheStamp.size != sourceStamp.size)
+	{
+		return false;
+	}
+
+	// each mesh has at least its vertex, index and texture counts
+	const uint64_t minimumMeshBytes = 3 * sizeof(uint32_t);
+	if (static_cast<uint64_t>(meshCount) * minimumMeshBytes > fileSize - static_cast<uint64_t>(file.tellg()))
+	{
+		std::cout << "ERROR::MESH_CACHE::CORRUPTED: " << cachePath << std::endl;
+		return false;
+	}
+
+	// meshes, the vertex and index data is read in bulk directly into the arrays later given to glBufferData
+	meshes.clear();
+	meshes.resize(meshCount);
+	for (MeshData& mesh : meshes)
+	{
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+		uint32_t textureCount = 0;
+		readCacheValue(file, vertexCount);
+		readCacheValue(file, indexCount);
+		readCacheValue(file, textureCount);
+		const uint64_t remainingBytes = fileSize - static_cast<uint64_t>(file.tellg());
+		const uint64_t dataBytes = static_cast<uint64_t>(vertexCount) * sizeof(Vertex) + static_cast<uint64_t>(indexCount) * sizeof(unsigned int);
+		if (!file || dataBytes > remainingBytes)
+		{
+			std::cout << "ERROR::MESH_CACHE::CORRUPTED: " << cachePath << std::endl;
+			return false;
+		}
+
+		mesh.vertices.resize(vertexCount);
+		mesh.indices.resize(indexCount);
+		file.read(reinterpret_cast<char*>(mesh.vertices.data()), static_cast<std::streamsize>(vertexCount) * sizeof(Vertex));
+		file.read(reinterpret_cast<char*>(mesh.indices.data()), static_cast<std::streamsize>(indexCount) * sizeof(unsigned int));
+
+		mesh.textures.resize(textureCount);
+		for (MeshData::TextureRef& texture : mesh.textures)
+		{
+			if (!readCacheString(file, texture.type, fileSize) || !readCacheString(file, texture.relativePath, fileSize))
+			{
+				std::cout << "ERROR::MESH_CACHE::CORRUPTED: " << cachePath << std::endl;
+				return false;
+			}
+		}
+	}
+
+	return static_cast<bool>(file);
+}
+
+bool MeshCache::save(const std::string& sourcePath, uint32_t processingFlags, const std::vector<MeshData>& meshes)
+{
+	SourceStamp sourceStamp;
+	if (!getSourceStamp(sourcePath, sourceStamp))
+	{
+		return false;
+	}
+
+	const std::string cachePath = getCachePath(sourcePath);
+	const std::string tmpPath = cachePath + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+	std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "ERROR::MESH_CACHE::FILE_NOT_WRITABLE: " << tmpPath << std::endl;
+		return false;
+	}
+
+	// header
+	file.write(MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+	writeCacheValue(file, VERSION);
+	writeCacheValue(file, static_cast<uint32_t>(sizeof(Vertex)));
+	writeCacheValue(file, processingFlags);
+	writeCacheValue(file, sourceStamp.writeTime);
+	writeCacheValue(file, sourceStamp.size);
+	writeCacheValue(file, static_cast<uint32_t>(meshes.size()));
+
+	// meshes
+	for (const MeshData& mesh : meshes)
+	{
+		writeCacheValue(file, static_cast<uint32_t>(mesh.vertices.size()));
+		writeCacheValue(file, static_cast<uint32_t>(mesh.indices.size()));
+		writeCacheValue(file, static_cast<uint32_t>(mesh.textures.size()));
+		file.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+		file.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(unsigned int));
+
+		for (const MeshData::TextureRef& texture : mesh.textures)
+		{
+			writeCacheString(file, texture.type);
+			writeCacheString(file, texture.relativePath);
+		}
+	}
+
+	file.close();
+	std::error_code error;
+	if (!file)
+	{
+		std::cout << "ERROR::MESH_CACHE::WRITE_FAILED: " << tmpPath << std::endl;
+		std::filesystem::remove(tmpPath, error);
+		return false;
+	}
+	// replaces the cache in one step, the last of several saves of the same path wins
+	std::filesystem::rename(tmpPath, cachePath, error);
+	if (error)
+	{
+		std::cout << "ERROR::MESH_CACHE::RENAME_FAILED: " << cachePath << " " << error.message() << std::endl;
+		std::filesystem::remove(tmpPath, error);
+		return false;
+	}
+	return true;
+}
+
+bool MeshCache::getSourceStamp(const std::string& sourcePath, SourceStamp& stamp)
+{
+	std::error_code error;
+	const auto writeTime = std::filesystem::last_write_time(sourcePath, error);
+	if (error)
+	{
+		return false;
+	}
+	const uint64_t size = std::filesystem::file_size(sourcePath, error);
+	if (error)
+	{
+		return false;
+	}
+
+	stamp.writeTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+	stamp.size = size;
+	return true;
+}
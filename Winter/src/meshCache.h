@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mesh.h"
+#include "vertex.h"
+
+// Versioned binary cache of the flattened meshes of a model, written next to the source file.
+// Lets a model skip the assimp import when the source file has not changed since the cache was written.
+// Does not use GL, so it can be used from the loader threads.
+class MeshCache {
+public:
+	static const uint32_t VERSION;
+	static const std::string EXTENSION;
+
+	// Import options which change the cached data, a cache written with other flags is outdated
+	enum ProcessingFlags : uint32_t {
+		PROCESSING_NONE = 0,
+		PROCESSING_OPTIMIZED = 1 << 0,
+	};
+
+	static std::string getCachePath(const std::string& sourcePath);
+	// Returns false if there is no cache or if it is outdated compared to the source file
+	static bool load(const std::string& sourcePath, uint32_t processingFlags, std::vector<MeshData>& meshes);
+	// Written to a file of the calling thread then renamed, so that concurrent saves of a path and loads never see a partial cache
+	static bool save(const std::string& sourcePath, uint32_t processingFlags, const std::vector<MeshData>& meshes);
+private:
+	// Used to invalidate the cache when the source file changes
+	struct SourceStamp {
+		int64_t writeTime;
+		uint64_t size;
+	};
+
+	static bool getSourceStamp(const std::string& sourcePath, SourceStamp& stamp);
+};
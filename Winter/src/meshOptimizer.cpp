@@ -0,0 +1,307 @@
+#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "glm/glm.hpp"
+
+const unsigned int MeshOptimizer::VERTEX_CACHE_SIZE = 16;
+const float MeshOptimizer::OVERDRAW_THRESHOLD = 1.05f;
+const unsigned int MeshOptimizer::NO_VERTEX = static_cast<unsigned int>(-1);
+
+void MeshOptimizer::optimize(MeshData& mesh)
+{
+	const std::vector<unsigned int> clusters = optimizeVertexCache(mesh.indices, mesh.vertices.size());
+	optimizeOverdraw(mesh.indices, mesh.vertices, clusters);
+	optimizeVertexFetch(mesh.vertices, mesh.indices);
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+	VertexCacheStats stats{ 0.0f, 0.0f };
+	// no whole triangle to divide by
+	if (indices.size() < 3)
+	{
+		return stats;
+	}
+
+	// a vertex is in the FIFO cache if less than cacheSize misses happened since its own miss
+	std::vector<unsigned int> cacheTimestamps(vertexCount, 0);
+	std::vector<bool> isUsed(vertexCount, false);
+	unsigned int timestamp = cacheSize + 1;
+	size_t nbMisses = 0;
+	size_t nbUsedVertices = 0;
+	for (const unsigned int index : indices)
+	{
+		if (timestamp - cacheTimestamps[index] > cacheSize)
+		{
+			cacheTimestamps[index] = timestamp++;
+			nbMisses++;
+		}
+		if (!isUsed[index])
+		{
+			isUsed[index] = true;
+			nbUsedVertices++;
+		}
+	}
+
+	stats.acmr = static_cast<float>(nbMisses) / static_cast<float>(indices.size() / 3);
+	stats.atvr = static_cast<float>(nbMisses) / static_cast<float>(nbUsedVertices);
+	return stats;
+}
+
+std::vector<unsigned int> MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+	std::vector<unsigned int> clusters;
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return clusters;
+	}
+
+	// triangles using each vertex
+	std::vector<unsigned int> liveTriangles(vertexCount, 0);
+	for (const unsigned int index : indices)
+	{
+		liveTriangles[index]++;
+	}
+	std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+	std::partial_sum(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin() + 1);
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> adjacencyCursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		adjacency[adjacencyCursors[indices[i]]++] = static_cast<unsigned int>(i / 3);
+	}
+
+	std::vector<unsigned int> cacheTimestamps(vertexCount, 0);
+	std::vector<bool> isEmitted(triangleCount, false);
+	std::vector<unsigned int> deadEnds;
+	deadEnds.reserve(indices.size());
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> output;
+	output.reserve(indices.size());
+	unsigned int timestamp = cacheSize + 1;
+	unsigned int cursor = 0;
+
+	unsigned int fanningVertex = skipDeadEnd(deadEnds, liveTriangles, cursor);
+	bool isNewCluster = true;
+	while (fanningVertex != NO_VERTEX)
+	{
+		if (isNewCluster)
+		{
+			clusters.push_back(static_cast<unsigned int>(output.size() / 3));
+		}
+
+		// emit every remaining triangle around the fanning vertex
+		candidates.clear();
+		for (unsigned int i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++)
+		{
+			const unsigned int triangle = adjacency[i];
+			if (isEmitted[triangle])
+			{
+				continue;
+			}
+			for (unsigned int j = 0; j < 3; j++)
+			{
+				const unsigned int vertex = indices[triangle * 3 + j];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if (timestamp - cacheTimestamps[vertex] > cacheSize)
+				{
+					cacheTimestamps[vertex] = timestamp++;
+				}
+			}
+			isEmitted[triangle] = true;
+		}
+
+		// next fanning vertex: the oldest candidate which stays in the cache while its remaining triangles are emitted
+		unsigned int nextVertex = NO_VERTEX;
+		int bestPriority = -1;
+		for (const unsigned int vertex : candidates)
+		{
+			if (liveTriangles[vertex] == 0)
+			{
+				continue;
+			}
+			int priority = 0;
+			if (timestamp - cacheTimestamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+			{
+				priority = static_cast<int>(timestamp - cacheTimestamps[vertex]);
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				nextVertex = vertex;
+			}
+		}
+
+		isNewCluster = nextVertex == NO_VERTEX;
+		if (isNewCluster)
+		{
+			nextVertex = skipDeadEnd(deadEnds, liveTriangles, cursor);
+		}
+		fanningVertex = nextVertex;
+	}
+
+	indices.swap(output);
+	return clusters;
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& clusters, 
+	float threshold, unsigned int cacheSize)
+{
+	if (indices.empty() || clusters.empty())
+	{
+		return;
+	}
+
+	const std::vector<unsigned int> splitClusterStarts = splitClusters(indices, vertices.size(), clusters, threshold, cacheSize);
+	const size_t triangleCount = indices.size() / 3;
+	const size_t clusterCount = splitClusterStarts.size();
+
+	// area weighted centroid and normal of each cluster
+	std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+	std::vector<float> clusterAreas(clusterCount, 0.0f);
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	for (size_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		const size_t end = cluster + 1 < clusterCount ? splitClusterStarts[cluster + 1] : triangleCount;
+		for (size_t triangle = splitClusterStarts[cluster]; triangle < end; triangle++)
+		{
+			const glm::vec3& p0 = vertices[indices[triangle * 3 + 0]].Position;
+			const glm::vec3& p1 = vertices[indices[triangle * 3 + 1]].Position;
+			const glm::vec3& p2 = vertices[indices[triangle * 3 + 2]].Position;
+			const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			const float area = glm::length(normal);
+			const glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+
+			clusterCentroids[cluster] += centroid * area;
+			clusterNormals[cluster] += normal;
+			clusterAreas[cluster] += area;
+		}
+		meshCentroid += clusterCentroids[cluster];
+		meshArea += clusterAreas[cluster];
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCentroid /= meshArea;
+	}
+
+	std::vector<float> sortKeys(clusterCount, 0.0f);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		if (clusterAreas[cluster] > 0.0f)
+		{
+			const glm::vec3 centroid = clusterCentroids[cluster] / clusterAreas[cluster];
+			const float normalLength = glm::length(clusterNormals[cluster]);
+			const glm::vec3 normal = normalLength > 0.0f ? clusterNormals[cluster] / normalLength : glm::vec3(0.0f);
+			sortKeys[cluster] = glm::dot(centroid - meshCentroid, normal);
+		}
+	}
+
+	std::vector<unsigned int> clusterOrder(clusterCount);
+	std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](unsigned int a, unsigned int b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<unsigned int> output;
+	output.reserve(indices.size());
+	for (const unsigned int cluster : clusterOrder)
+	{
+		const size_t begin = splitClusterStarts[cluster];
+		const size_t end = cluster + 1 < clusterCount ? splitClusterStarts[cluster + 1] : triangleCount;
+		output.insert(output.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+	}
+	indices.swap(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	std::vector<unsigned int> remap(vertices.size(), NO_VERTEX);
+	std::vector<Vertex> output;
+	output.reserve(vertices.size());
+	for (unsigned int& index : indices)
+	{
+		if (remap[index] == NO_VERTEX)
+		{
+			remap[index] = static_cast<unsigned int>(output.size());
+			output.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices.swap(output);
+}
+
+unsigned int MeshOptimizer::skipDeadEnd(std::vector<unsigned int>& deadEnds, const std::vector<unsigned int>& liveTriangles, unsigned int& cursor)
+{
+	// most recently used vertex which still has triangles
+	while (!deadEnds.empty())
+	{
+		const unsigned int vertex = deadEnds.back();
+		deadEnds.pop_back();
+		if (liveTriangles[vertex] > 0)
+		{
+			return vertex;
+		}
+	}
+	// else the next one in input order
+	while (cursor < liveTriangles.size())
+	{
+		if (liveTriangles[cursor] > 0)
+		{
+			return cursor;
+		}
+		cursor++;
+	}
+	return NO_VERTEX;
+}
+
+std::vector<unsigned int> MeshOptimizer::splitClusters(const std::vector<unsigned int>& indices, size_t vertexCount, const std::vector<unsigned int>& clusters, 
+	float threshold, unsigned int cacheSize)
+{
+	// smaller clusters can be sorted more finely, they are split as long as the vertex cache stays almost as efficient
+	const float maxAcmr = analyzeVertexCache(indices, vertexCount, cacheSize).acmr * threshold;
+	const size_t triangleCount = indices.size() / 3;
+
+	std::vector<unsigned int> splitClusterStarts;
+	splitClusterStarts.reserve(clusters.size());
+	std::vector<unsigned int> cacheTimestamps(vertexCount, 0);
+	unsigned int timestamp = cacheSize + 1;
+	for (size_t cluster = 0; cluster < clusters.size(); cluster++)
+	{
+		const size_t end = cluster + 1 < clusters.size() ? clusters[cluster + 1] : triangleCount;
+		size_t start = clusters[cluster];
+		size_t nbMisses = 0;
+		splitClusterStarts.push_back(static_cast<unsigned int>(start));
+		// Tipsify restarted from a dead end here, the cache does not hold anything useful
+		timestamp += cacheSize + 1;
+		for (size_t triangle = start; triangle < end; triangle++)
+		{
+			for (unsigned int j = 0; j < 3; j++)
+			{
+				const unsigned int vertex = indices[triangle * 3 + j];
+				if (timestamp - cacheTimestamps[vertex] > cacheSize)
+				{
+					cacheTimestamps[vertex] = timestamp++;
+					nbMisses++;
+				}
+			}
+
+			const size_t nbTriangles = triangle + 1 - start;
+			const bool isSplit = triangle + 1 < end && static_cast<float>(nbMisses) / static_cast<float>(nbTriangles) <= maxAcmr;
+			if (isSplit)
+			{
+				start = triangle + 1;
+				nbMisses = 0;
+				splitClusterStarts.push_back(static_cast<unsigned int>(start));
+				// a split cluster may be drawn after any other one, its vertices have to be assumed out of the cache
+				timestamp += cacheSize + 1;
+			}
+		}
+	}
+	return splitClusterStarts;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+
+#include "mesh.h"
+#include "vertex.h"
+
+// Import time reordering of a mesh for the GPU caches: Tipsify vertex cache optimization, overdraw aware ordering
+// of the resulting clusters and vertex fetch remapping.
+// Sander, Nehab, Barczak - Fast Triangle Reordering for Vertex Locality and Reduced Overdraw (2007)
+class MeshOptimizer {
+public:
+	static const unsigned int VERTEX_CACHE_SIZE;
+	// Clusters are split while their ACMR stays under OVERDRAW_THRESHOLD times the mesh's ACMR, higher values favor overdraw
+	static const float OVERDRAW_THRESHOLD;
+
+	struct VertexCacheStats {
+		float acmr; // average cache miss ratio, transformed vertices per triangle (0.5 at best on big meshes, 3 at worst)
+		float atvr; // average transformed vertex ratio, transformed vertices per used vertex (1 at best)
+	};
+
+	// Runs the three passes in order
+	static void optimize(MeshData& mesh);
+	// Simulates a FIFO post-transform cache
+	static VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+	// Returns the first triangle of each cluster, a cluster starts when Tipsify has to restart from a dead end
+	static std::vector<unsigned int> optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+	// Draws first the clusters facing away from the center of the mesh, they are the most likely to occlude the others
+	static void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& clusters, 
+		float threshold = OVERDRAW_THRESHOLD, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+	// Stores the vertices in the order of their first use and drops the unused ones
+	static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+private:
+	static const unsigned int NO_VERTEX;
+
+	static unsigned int skipDeadEnd(std::vector<unsigned int>& deadEnds, const std::vector<unsigned int>& liveTriangles, unsigned int& cursor);
+	static std::vector<unsigned int> splitClusters(const std::vector<unsigned int>& indices, size_t vertexCount, const std::vector<unsigned int>& clusters, 
+		float threshold, unsigned int cacheSize);
+};
@@ -1,6 +1,7 @@
 #include "model.h"
 
 #include <algorithm>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -10,12 +11,46 @@
 #include "assimp/postprocess.h"
 
 #include "mesh.h"
+#include "meshCache.h"
+#include "meshOptimizer.h"
+#include "textureCache.h"
+#include "threadPool.h"
 
-std::vector<Texture> Model::texturesLoaded;
+struct Model::AsyncLoad {
+	struct PendingTexture {
+		std::string path;
+		std::string type;
+		// set if the texture was already cached when the import finished, the image is not decoded then
+		std::shared_ptr<const CachedTexture> cachedTexture;
+		// decoded by its own job on the pool, the textures of a model are decoded concurrently
+		std::future<Texture::ImageData> decoded;
+		Texture::ImageData image;
+	};
 
-Model::Model(const std::string& path)
+	// Returned by the import job, which shares nothing else with the load: the job may outlive it (e.g. at exit)
+	struct ImportResult {
+		bool isImported = false;
+		std::vector<MeshData> meshData;
+		std::vector<PendingTexture> textures;
+	};
+
+	std::string path;
+	std::promise<Model> promise;
+	std::future<ImportResult> imported;
+	bool isImported = false;
+	Model model;
+	// moved from the import result by the GL thread
+	std::vector<MeshData> meshData;
+	std::vector<PendingTexture> textures;
+	size_t nextTexture = 0;
+	size_t nextMesh = 0;
+};
+
+std::vector<std::shared_ptr<Model::AsyncLoad>> Model::asyncLoads;
+
+Model::Model(const std::string& path, const ModelLoadOptions& options)
 {
-	loadModel(path);
+	loadModel(path, options);
 }
 
 void Model::draw(Shader& shader) const
@@ -26,28 +61,252 @@ void Model::draw(Shader& shader) const
 	}
 }
 
-void Model::loadModel(const std::string& path)
+void Model::draw(Shader& shader, const Frustum& frustum) const
+{
+	frustum.cullSpheres(meshBounds, visibleMeshes);
+	for (const unsigned int meshIndex : visibleMeshes)
+	{
+		meshes[meshIndex].draw(shader);
+	}
+}
+
+const BoundingSphereBatch& Model::getMeshBounds() const
+{
+	return meshBounds;
+}
+
+BoundingSphere Model::getBoundingSphere() const
+{
+	if (meshes.empty())
+	{
+		return BoundingSphere{ glm::vec3(0.0f), 0.0f };
+	}
+
+	BoundingSphere sphere = meshes[0].getBoundingSphere();
+	for (const auto& mesh : meshes)
+	{
+		sphere = BoundingSphere::merge(sphere, mesh.getBoundingSphere());
+	}
+	return sphere;
+}
+
+std::future<Model> Model::loadAsync(const std::string& path, const ModelLoadOptions& options)
+{
+	auto load = std::make_shared<AsyncLoad>();
+	load->path = path;
+	load->model.directory = path.substr(0, path.find_last_of('/'));
+	load->model.vertexFormat = options.packVertices ? VertexFormat::PACKED : VertexFormat::FLOAT;
+	std::future<Model> result = load->promise.get_future();
+
+	const std::string directoryPrefix = load->model.directory + '/';
+	load->imported = ThreadPool::getShared().submit([path, options, directoryPrefix]() {
+		AsyncLoad::ImportResult result;
+		if (!importMeshes(path, options, result.meshData))
+		{
+			return result;
+		}
+
+		// decode every texture once, even if several meshes use it, and only if it is not already cached
+		for (const MeshData& mesh : result.meshData)
+		{
+			for (const MeshData::TextureRef& textureRef : mesh.textures)
+			{
+				const std::string texturePath = directoryPrefix + textureRef.relativePath;
+				const auto it = std::find_if(result.textures.begin(), result.textures.end(),
+					[&texturePath](const AsyncLoad::PendingTexture& t) { return t.path == texturePath; }
+				);
+				if (it == result.textures.end())
+				{
+					AsyncLoad::PendingTexture& texture = result.textures.emplace_back();
+					texture.path = texturePath;
+					texture.type = textureRef.type;
+					texture.cachedTexture = TextureCache::find(texturePath, isLoadedAsSRGB(textureRef.type));
+					if (!texture.cachedTexture)
+					{
+						// not waited for here, a job blocking on jobs queued behind it could deadlock the pool
+						texture.decoded = ThreadPool::getShared().submit([texturePath]() { return Texture::decodeImage(texturePath); });
+					}
+				}
+			}
+		}
+		result.isImported = true;
+		return result;
+	});
+
+	asyncLoads.push_back(std::move(load));
+	return result;
+}
+
+void Model::updateAsyncLoads(size_t uploadBudget)
+{
+	auto it = asyncLoads.begin();
+	while (it != asyncLoads.end())
+	{
+		if (updateAsyncLoad(**it, uploadBudget))
+		{
+			it = asyncLoads.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+size_t Model::getPendingAsyncLoadCount()
+{
+	return asyncLoads.size();
+}
+
+bool Model::updateAsyncLoad(AsyncLoad& load, size_t& uploadBudget)
+{
+	if (!load.isImported)
+	{
+		if (load.imported.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return false;
+		}
+		AsyncLoad::ImportResult result = load.imported.get();
+		if (!result.isImported)
+		{
+			std::cout << "ERROR::MODEL::ASYNC_LOAD_FAILED: " << load.path << std::endl;
+			load.promise.set_value(std::move(load.model));
+			return true;
+		}
+		load.meshData = std::move(result.meshData);
+		load.textures = std::move(result.textures);
+		load.isImported = true;
+	}
+
+	// every decode is joined before the first upload
+	for (const AsyncLoad::PendingTexture& texture : load.textures)
+	{
+		if (texture.decoded.valid() && texture.decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return false;
+		}
+	}
+
+	// textures first, so that the meshes find them in the TextureCache
+	while (load.nextTexture < load.textures.size())
+	{
+		if (uploadBudget == 0)
+		{
+			return false;
+		}
+		AsyncLoad::PendingTexture& texture = load.textures[load.nextTexture++];
+		if (!texture.cachedTexture)
+		{
+			texture.image = texture.decoded.get();
+			texture.cachedTexture = TextureCache::insert(texture.path, texture.image, isLoadedAsSRGB(texture.type));
+			uploadBudget -= std::min(uploadBudget, texture.image.getSize());
+		}
+		texture.image.pixels.reset();
+	}
+
+	if (load.nextMesh == 0)
+	{
+		load.model.meshes.reserve(load.meshData.size());
+	}
+	while (load.nextMesh < load.meshData.size())
+	{
+		if (uploadBudget == 0)
+		{
+			return false;
+		}
+		MeshData& meshData = load.meshData[load.nextMesh++];
+		uploadBudget -= std::min(uploadBudget, meshData.getUploadSize());
+		load.model.meshes.push_back(load.model.createMesh(meshData));
+	}
+
+	load.model.computeMeshBounds();
+	load.promise.set_value(std::move(load.model));
+	return true;
+}
+
+void Model::loadModel(const std::string& path, const ModelLoadOptions& options)
+{
+	directory = path.substr(0, path.find_last_of('/'));
+	vertexFormat = options.packVertices ? VertexFormat::PACKED : VertexFormat::FLOAT;
+	std::vector<MeshData> meshData;
+	if (!importMeshes(path, options, meshData))
+	{
+		return;
+	}
+
+	meshes.reserve(meshData.size());
+	for (MeshData& data : meshData)
+	{
+		meshes.push_back(createMesh(data));
+	}
+	computeMeshBounds();
+}
+
+Mesh Model::createMesh(MeshData& meshData) const
+{
+	std::vector<Texture> textures;
+	textures.reserve(meshData.textures.size());
+	for (const MeshData::TextureRef& textureRef : meshData.textures)
+	{
+		textures.push_back(loadMaterialTexture(directory + '/' + textureRef.relativePath, textureRef.type));
+	}
+	return Mesh(std::move(meshData.vertices), std::move(meshData.indices), std::move(textures), vertexFormat);
+}
+
+void Model::computeMeshBounds()
+{
+	meshBounds.clear();
+	meshBounds.reserve(meshes.size());
+	for (const auto& mesh : meshes)
+	{
+		meshBounds.add(mesh.getBoundingSphere());
+	}
+}
+
+bool Model::importMeshes(const std::string& path, const ModelLoadOptions& options, std::vector<MeshData>& meshes)
 {
+	const uint32_t processingFlags = options.optimizeMeshes ? MeshCache::PROCESSING_OPTIMIZED : MeshCache::PROCESSING_NONE;
+	if (MeshCache::load(path, processingFlags, meshes))
+	{
+		return true;
+	}
+
 	Assimp::Importer importer;
 	const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
 
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 	{
 		std::cout << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
-		return;
+		return false;
 	}
-	directory = path.substr(0, path.find_last_of('/'));
 
-	processNode(scene->mRootNode, scene);
+	meshes.clear();
+	meshes.reserve(scene->mNumMeshes);
+	processNode(scene->mRootNode, scene, meshes);
+	if (options.optimizeMeshes)
+	{
+		optimizeMeshes(meshes);
+	}
+	MeshCache::save(path, processingFlags, meshes);
+	return true;
 }
 
-void Model::processNode(aiNode* node, const aiScene* scene)
+void Model::optimizeMeshes(std::vector<MeshData>& meshes)
 {
-	// process all the node's meshes (if any)
-	if (meshes.size() == 0)
+	for (size_t i = 0; i < meshes.size(); i++)
 	{
-		meshes.reserve(scene->mNumMeshes);
+		MeshData& mesh = meshes[i];
+		const MeshOptimizer::VertexCacheStats before = MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size());
+		MeshOptimizer::optimize(mesh);
+		const MeshOptimizer::VertexCacheStats after = MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size());
+		std::cout << "Mesh " << i << " (" << mesh.indices.size() / 3 << " triangles): ACMR " << before.acmr << " -> " << after.acmr 
+			<< ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
 	}
+}
+
+void Model::processNode(aiNode* node, const aiScene* scene, std::vector<MeshData>& meshes)
+{
+	// process all the node's meshes (if any)
 	for (unsigned int i = 0; i < node->mNumMeshes; i++)
 	{
 		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
@@ -56,17 +315,15 @@ void Model::processNode(aiNode* node, const aiScene* scene)
 	// then do the same for each of its children
 	for (unsigned int i = 0; i < node->mNumChildren; i++)
 	{
-		processNode(node->mChildren[i], scene);
+		processNode(node->mChildren[i], scene, meshes);
 	}
 }
 
-Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) const
+MeshData Model::processMesh(aiMesh* mesh, const aiScene* scene)
 {
-	std::vector<Vertex> vertices;
-	std::vector<unsigned int> indices;
-	std::vector<Texture> textures;
+	MeshData meshData;
 
-	vertices.reserve(mesh->mNumVertices);
+	meshData.vertices.reserve(mesh->mNumVertices);
 	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 	{
 		// process vertex positions, normals and texture coordinates
@@ -78,17 +335,17 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) const
 		{
 			texCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
 		}
-		vertices.emplace_back(pos, normal, texCoords);
+		meshData.vertices.emplace_back(pos, normal, texCoords);
 	}
 
 	// process indices
-	indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
+	meshData.indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
 	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
 	{
 		const aiFace face = mesh->mFaces[i];
 		for (unsigned int j = 0; j < face.mNumIndices; j++)
 		{
-			indices.push_back(face.mIndices[j]);
+			meshData.indices.push_back(face.mIndices[j]);
 		}
 	}
 
@@ -96,47 +353,29 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) const
 	if (mesh->mMaterialIndex >= 0)
 	{
 		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-		const std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, Texture::DIFFUSE_TYPENAME);
-		const std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, Texture::SPECULAR_TYPENAME);
-
-		textures.reserve(diffuseMaps.size() + specularMaps.size());
-		textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-		textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+		loadMaterialTextures(material, aiTextureType_DIFFUSE, Texture::DIFFUSE_TYPENAME, meshData.textures);
+		loadMaterialTextures(material, aiTextureType_SPECULAR, Texture::SPECULAR_TYPENAME, meshData.textures);
 	}
 
-	return Mesh(vertices, indices, textures);
+	return meshData;
 }
 
-std::vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName) const
+void Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName, std::vector<MeshData::TextureRef>& textures)
 {
-	std::vector<Texture> textures;
-	textures.reserve(mat->GetTextureCount(type));
 	for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
 	{
 		aiString strPath;
 		mat->GetTexture(type, i, &strPath);
-		const std::string path = directory + '/' + strPath.C_Str();
-		
-		const auto it = std::find_if(texturesLoaded.begin(), texturesLoaded.end(), 
-			[&path](Texture t) { return t.path == path; }
-		);
-		const bool isAlreadyLoaded = it != texturesLoaded.end();
-
-		if (isAlreadyLoaded)
-		{
-			textures.push_back(*it);
-		}
-		else
-		{
-			bool loadAsSRGB = false;
-			if (typeName == Texture::DIFFUSE_TYPENAME)
-			{
-				loadAsSRGB = true;
-			}
-			const unsigned int id = Texture::loadTexture(path, loadAsSRGB);
-			textures.emplace_back(id, typeName, path);
-			texturesLoaded.emplace_back(id, typeName, path);
-		}
+		textures.push_back({ typeName, strPath.C_Str() });
 	}
-	return textures;
+}
+
+bool Model::isLoadedAsSRGB(const std::string& typeName)
+{
+	return typeName == Texture::DIFFUSE_TYPENAME;
+}
+
+Texture Model::loadMaterialTexture(const std::string& path, const std::string& typeName) const
+{
+	return TextureCache::acquire(path, typeName, isLoadedAsSRGB(typeName));
 }
\ No newline at end of file
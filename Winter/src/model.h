@@ -1,10 +1,13 @@
 #pragma once
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "assimp/material.h"
 
+#include "bounds.h"
+#include "frustum.h"
 #include "mesh.h"
 #include "texture.h"
 
@@ -13,17 +16,57 @@ struct aiNode;
 struct aiScene;
 struct aiMesh;
 
+struct ModelLoadOptions {
+	// Reorders the triangles and vertices of each mesh for the GPU caches (see MeshOptimizer), reports ACMR/ATVR when importing
+	bool optimizeMeshes = false;
+	// Uploads the meshes with VertexFormat::PACKED, their shaders have to dequantize the attributes
+	bool packVertices = false;
+};
+
 class Model {
 public:
-	Model(const std::string& path);
+	// Bytes of textures and vertex/index data uploaded per call to updateAsyncLoads
+	static const size_t DEFAULT_UPLOAD_BUDGET = 4 * 1024 * 1024;
+
+	Model(const std::string& path, const ModelLoadOptions& options = ModelLoadOptions());
 	void draw(Shader& shader) const;
+	// Only draws the meshes whose bounding sphere intersects the frustum, which has to be in the model's space
+	// (extracted from projection * view * model)
+	void draw(Shader& shader, const Frustum& frustum) const;
+	// Bounds of the meshes in the model's space, computed at load
+	const BoundingSphereBatch& getMeshBounds() const;
+	BoundingSphere getBoundingSphere() const;
 	std::vector<Mesh> meshes;
+
+	// Imports the meshes on the shared thread pool, then decodes each texture in its own job there, the GL objects are then created by updateAsyncLoads.
+	// The future is ready once every mesh is uploaded, a model that failed to load has no meshes.
+	static std::future<Model> loadAsync(const std::string& path, const ModelLoadOptions& options = ModelLoadOptions());
+	// Must be called once per frame on the thread owning the GL context, uploads at most uploadBudget bytes
+	// (but always at least one texture or mesh so that every load makes progress)
+	static void updateAsyncLoads(size_t uploadBudget = DEFAULT_UPLOAD_BUDGET);
+	static size_t getPendingAsyncLoadCount();
 private:
-	static std::vector<Texture> texturesLoaded;
+	struct AsyncLoad;
+
+	static std::vector<std::shared_ptr<AsyncLoad>> asyncLoads;
 	std::string directory;
+	VertexFormat vertexFormat = VertexFormat::FLOAT;
+	BoundingSphereBatch meshBounds;
+	mutable std::vector<unsigned int> visibleMeshes;
+
+	Model() = default;
 
-	void loadModel(const std::string& path);
-	void processNode(aiNode* node, const aiScene* scene);
-	Mesh processMesh(aiMesh* mesh, const aiScene* scene) const;
-	std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName) const;
+	void loadModel(const std::string& path, const ModelLoadOptions& options);
+	Mesh createMesh(MeshData& meshData) const;
+	void computeMeshBounds();
+	// Only uses the CPU, safe to call from the loader threads
+	static bool importMeshes(const std::string& path, const ModelLoadOptions& options, std::vector<MeshData>& meshes);
+	static void optimizeMeshes(std::vector<MeshData>& meshes);
+	static void processNode(aiNode* node, const aiScene* scene, std::vector<MeshData>& meshes);
+	static MeshData processMesh(aiMesh* mesh, const aiScene* scene);
+	static void loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName, std::vector<MeshData::TextureRef>& textures);
+	static bool isLoadedAsSRGB(const std::string& typeName);
+	Texture loadMaterialTexture(const std::string& path, const std::string& typeName) const;
+	// Returns true if the load is finished
+	static bool updateAsyncLoad(AsyncLoad& load, size_t& uploadBudget);
 };
\ No newline at end of file
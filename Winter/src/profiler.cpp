@@ -0,0 +1,264 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+#include "traceRecorder.h"
+
+std::vector<Profiler::Pass> Profiler::passes;
+std::unordered_map<const char*, unsigned int> Profiler::passIndices;
+std::vector<Profiler::OpenScope> Profiler::openScopes;
+Profiler::QueryPool Profiler::pools[Profiler::POOL_COUNT] = {};
+unsigned int Profiler::currentPool = 0;
+unsigned int Profiler::stalls = 0;
+
+void Profiler::beginScope(const char* name)
+{
+	QueryPool& pool = pools[currentPool];
+	const unsigned int pass = getPassIndex(name);
+	const GLuint begin = nextQuery(pool);
+	const GLuint end = nextQuery(pool);
+	glQueryCounter(begin, GL_TIMESTAMP);
+	pool.scopes.push_back({ name, pass, begin, end });
+	const bool isTraced = TraceRecorder::isRecording();
+	if (isTraced)
+	{
+		TraceRecorder::beginScope(name);
+	}
+	openScopes.push_back({ pass, pool.scopes.size() - 1, std::chrono::steady_clock::now(), isTraced });
+}
+
+void Profiler::endScope()
+{
+	if (openScopes.empty())
+	{
+		std::cout << "ERROR::PROFILER: No scope to end" << std::endl;
+		return;
+	}
+	const OpenScope scope = openScopes.back();
+	openScopes.pop_back();
+	glQueryCounter(pools[currentPool].scopes[scope.scope].end, GL_TIMESTAMP);
+	addSample(passes[scope.pass].cpu, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - scope.start).count());
+	if (scope.isTraced)
+	{
+		TraceRecorder::endScope();
+	}
+}
+
+void Profiler::nextFrame()
+{
+	if (!openScopes.empty())
+	{
+		std::cout << "ERROR::PROFILER: " << openScopes.size() << " scopes still open at the end of the frame" << std::endl;
+		while (!openScopes.empty())
+		{
+			endScope();
+		}
+	}
+	currentPool = (currentPool + 1) % POOL_COUNT;
+	readBack(pools[currentPool]);
+}
+
+const std::vector<Profiler::Pass>& Profiler::getPasses()
+{
+	return passes;
+}
+
+const Profiler::Pass* Profiler::findPass(const char* name)
+{
+	const unsigned int index = lookupPass(name);
+	return index != NO_PASS ? &passes[index] : nullptr;
+}
+
+double Profiler::getAverageMs(const Timings& start, const Timings& end)
+{
+	if (end.count <= start.count)
+	{
+		return 0.0;
+	}
+	return (end.totalMs - start.totalMs) / (end.count - start.count);
+}
+
+unsigned int Profiler::getStalls()
+{
+	return stalls;
+}
+
+void Profiler::showStats()
+{
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << std::left << std::setw(32) << "Pass (ms)" << std::right << std::setw(30) << "CPU last / avg / max" << std::setw(30) << "GPU last / avg / max" << std::endl;
+	for (Pass& pass : passes)
+	{
+		std::cout << std::left << std::setw(32) << std::string(2 * pass.depth, ' ') + pass.name << std::right;
+		showTimings(pass.cpu);
+		showTimings(pass.gpu);
+		std::cout << std::endl;
+		pass.cpu.totalMs = pass.cpu.maxMs = 0.0;
+		pass.cpu.count = 0;
+		pass.gpu.totalMs = pass.gpu.maxMs = 0.0;
+		pass.gpu.count = 0;
+	}
+	std::cout << "GPU query stalls: " << stalls << std::endl;
+	std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+void Profiler::release()
+{
+	for (QueryPool& pool : pools)
+	{
+		if (!pool.queries.empty())
+		{
+			glDeleteQueries(static_cast<GLsizei>(pool.queries.size()), pool.queries.data());
+		}
+		pool = {};
+	}
+	passes.clear();
+	passIndices.clear();
+	openScopes.clear();
+	currentPool = 0;
+	stalls = 0;
+}
+
+unsigned int Profiler::getPassIndex(const char* name)
+{
+	const unsigned int found = lookupPass(name);
+	if (found != NO_PASS)
+	{
+		return found;
+	}
+	const unsigned int index = static_cast<unsigned int>(passes.size());
+	passes.push_back({ name, static_cast<unsigned int>(openScopes.size()), {}, {} });
+	passIndices.emplace(name, index);
+	return index;
+}
+
+unsigned int Profiler::lookupPass(const char* name)
+{
+	const auto it = passIndices.find(name);
+	if (it != passIndices.end())
+	{
+		return it->second;
+	}
+	// first use of this address, the literal may be a copy from another translation unit
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		if (passes[i].name == name)
+		{
+			passIndices.emplace(name, static_cast<unsigned int>(i));
+			return static_cast<unsigned int>(i);
+		}
+	}
+	return NO_PASS;
+}
+
+GLuint Profiler::nextQuery(QueryPool& pool)
+{
+	if (pool.usedQueries == pool.queries.size())
+	{
+		pool.queries.resize(pool.queries.size() + QUERY_BATCH);
+		glGenQueries(QUERY_BATCH, &pool.queries[pool.usedQueries]);
+	}
+	return pool.queries[pool.usedQueries++];
+}
+
+void Profiler::readBack(QueryPool& pool)
+{
+	if (!pool.scopes.empty())
+	{
+		// the queries complete in order, the last one issued is the last to be available
+		GLint available = 0;
+		glGetQueryObjectiv(pool.queries[pool.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			stalls++;
+		}
+	}
+	for (const ScopeQueries& scope : pool.scopes)
+	{
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(scope.begin, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(scope.end, GL_QUERY_RESULT, &end);
+		addSample(passes[scope.pass].gpu, static_cast<double>(end - begin) / 1000000.0);
+		TraceRecorder::gpuScope(scope.name, begin, end);
+	}
+	pool.scopes.clear();
+	pool.usedQueries = 0;
+}
+
+void Profiler::addSample(Timings& timings, double ms)
+{
+	timings.lastMs = ms;
+	timings.totalMs += ms;
+	timings.maxMs = std::max(timings.maxMs, ms);
+	timings.count++;
+}
+
+void Profiler::showTimings(const Timings& timings)
+{
+	if (timings.count == 0)
+	{
+		// not run since the last table
+		std::cout << std::setw(10) << timings.lastMs << std::setw(20) << "- / -";
+		return;
+	}
+	std::cout << std::setw(10) << timings.lastMs << " /" << std::setw(8) << timings.totalMs / timings.count << " /" << std::setw(8) << timings.maxMs;
+}
+
+PassBenchmark::PassBenchmark(std::vector<const char*> passNames, unsigned int warmupFrames, unsigned int measuredFrames)
+	: passNames(std::move(passNames)), warmupFrames(warmupFrames), measuredFrames(measuredFrames), step(0), frame(0),
+	startTimings(this->passNames.size()), gpuMs(this->passNames.size(), 0.0)
+{
+}
+
+PassBenchmark::Event PassBenchmark::nextFrame()
+{
+	if (frame == warmupFrames + measuredFrames)
+	{
+		// the GPU times arrive a frame late, the counts tell how many were read back
+		for (size_t i = 0; i < passNames.size(); i++)
+		{
+			gpuMs[i] = Profiler::getAverageMs(startTimings[i], getGPUTimings(passNames[i]));
+		}
+		step++;
+		frame = 0;
+		return Event::STEP_ENDED;
+	}
+	if (frame == warmupFrames)
+	{
+		for (size_t i = 0; i < passNames.size(); i++)
+		{
+			startTimings[i] = getGPUTimings(passNames[i]);
+		}
+	}
+	return frame++ == 0 ? Event::STEP_STARTED : Event::NONE;
+}
+
+unsigned int PassBenchmark::getStep() const
+{
+	return step;
+}
+
+double PassBenchmark::getGPUMs(size_t pass) const
+{
+	return gpuMs[pass];
+}
+
+Profiler::Timings PassBenchmark::getGPUTimings(const char* name)
+{
+	const Profiler::Pass* pass = Profiler::findPass(name);
+	return pass != nullptr ? pass->gpu : Profiler::Timings{};
+}
+
+ProfileScope::ProfileScope(const char* name)
+{
+	Profiler::beginScope(name);
+}
+
+ProfileScope::~ProfileScope()
+{
+	Profiler::endScope();
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glad/glad.h"
+
+// CPU and GPU times of the named passes of a frame, shown as a table by showStats.
+// The GPU time of a scope is measured by timestamp queries (glQueryCounter) around its commands rather than GL_TIME_ELAPSED,
+// which cannot nest. The queries alternate between two pools, one per frame: a pool is read back when it is reused,
+// one frame after its own, by which time the GPU is usually done with it. The reads which still have to wait are counted as stalls.
+// A pass is sampled once per scope, scopes must be closed in the frame they were opened in.
+// The scope names must be string literals: the passes are looked up by address, which does not allocate inside the measured code,
+// and the TraceRecorder keeps the pointers. The same name at another address (another translation unit) is matched by value once.
+// Like GLState, it must only be used from the thread owning the context.
+class Profiler {
+public:
+	struct Timings {
+		double lastMs;
+		// since the last showStats
+		double totalMs;
+		double maxMs;
+		unsigned int count;
+	};
+
+	struct Pass {
+		std::string name;
+		// scopes open around the first scope of the pass
+		unsigned int depth;
+		Timings cpu;
+		Timings gpu;
+	};
+
+	static void beginScope(const char* name);
+	static void endScope();
+
+	// Ends the frame and reads back the GPU times of the previous one
+	static void nextFrame();
+	// In the order the passes were first opened
+	static const std::vector<Pass>& getPasses();
+	// nullptr until a scope of this name is opened, the pointer is invalidated by the next new pass
+	static const Pass* findPass(const char* name);
+	// Average of the samples added between two copies of the same timings, 0 without any (or when showStats ran in between)
+	static double getAverageMs(const Timings& start, const Timings& end);
+	static unsigned int getStalls();
+	// Last, average and max times of the passes since the previous call
+	static void showStats();
+	// Deletes the queries and forgets the passes, to call before the context is destroyed
+	static void release();
+private:
+	static const unsigned int NO_PASS = ~0u;
+	static const unsigned int POOL_COUNT = 2;
+	static const unsigned int QUERY_BATCH = 64;
+
+	struct ScopeQueries {
+		const char* name;
+		unsigned int pass;
+		GLuint begin;
+		GLuint end;
+	};
+
+	struct QueryPool {
+		std::vector<GLuint> queries;
+		unsigned int usedQueries;
+		std::vector<ScopeQueries> scopes;
+	};
+
+	struct OpenScope {
+		unsigned int pass;
+		size_t scope;
+		std::chrono::steady_clock::time_point start;
+		bool isTraced;
+	};
+
+	static std::vector<Pass> passes;
+	static std::unordered_map<const char*, unsigned int> passIndices;
+	static std::vector<OpenScope> openScopes;
+	static QueryPool pools[POOL_COUNT];
+	static unsigned int currentPool;
+	static unsigned int stalls;
+
+	static unsigned int getPassIndex(const char* name);
+	// NO_PASS if no scope of this name was opened
+	static unsigned int lookupPass(const char* name);
+	static GLuint nextQuery(QueryPool& pool);
+	static void readBack(QueryPool& pool);
+	static void addSample(Timings& timings, double ms);
+	static void showTimings(const Timings& timings);
+};
+
+// Average GPU times of some passes in a sequence of steps (configurations) of warmupFrames + measuredFrames frames each.
+// nextFrame() is called at the start of every frame: the caller sets the step up on STEP_STARTED,
+// and reads the times of the step on STEP_ENDED, whose frame is not measured and can be skipped.
+class PassBenchmark {
+public:
+	enum class Event {
+		NONE,
+		STEP_STARTED,
+		STEP_ENDED
+	};
+
+	PassBenchmark(std::vector<const char*> passNames, unsigned int warmupFrames, unsigned int measuredFrames);
+
+	Event nextFrame();
+	// Steps ended so far
+	unsigned int getStep() const;
+	// GPU ms per frame of the step which just ended, in the order of passNames
+	double getGPUMs(size_t pass) const;
+private:
+	std::vector<const char*> passNames;
+	unsigned int warmupFrames;
+	unsigned int measuredFrames;
+	unsigned int step;
+	unsigned int frame;
+	std::vector<Profiler::Timings> startTimings;
+	std::vector<double> gpuMs;
+
+	static Profiler::Timings getGPUTimings(const char* name);
+};
+
+// Profiles the enclosing block
+class ProfileScope {
+public:
+	explicit ProfileScope(const char* name);
+	~ProfileScope();
+	ProfileScope(const ProfileScope& other) = delete;
+	ProfileScope& operator=(const ProfileScope& other) = delete;
+};
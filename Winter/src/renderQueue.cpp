@@ -0,0 +1,327 @@
+#include "renderQueue.h"
+
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "glm/gtc/type_ptr.hpp"
+
+#include "glState.h"
+
+const uint32_t RenderQueue::NO_MATERIAL = std::numeric_limits<uint32_t>::max();
+
+uint64_t hashMaterial(const RenderMaterial& material)
+{
+	uint64_t hash = 0xcbf29ce484222325;
+	for (const TextureBinding& binding : material.textures)
+	{
+		for (const uint64_t value : { uint64_t(binding.unit), uint64_t(binding.target), uint64_t(binding.id) })
+		{
+			hash = (hash ^ value) * 0x100000001b3;
+		}
+	}
+	return hash;
+}
+
+bool areMaterialsEqual(const RenderMaterial& a, const RenderMaterial& b)
+{
+	if (a.textures.size() != b.textures.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < a.textures.size(); i++)
+	{
+		const TextureBinding& bindingA = a.textures[i];
+		const TextureBinding& bindingB = b.textures[i];
+		if (bindingA.unit != bindingB.unit || bindingA.target != bindingB.target || bindingA.id != bindingB.id)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+uint32_t RenderQueue::addMaterial(const RenderMaterial& material)
+{
+	std::vector<uint32_t>& sameHashMaterials = materialsByHash[hashMaterial(material)];
+	for (const uint32_t index : sameHashMaterials)
+	{
+		if (areMaterialsEqual(materials[index], material))
+		{
+			return index;
+		}
+	}
+
+	const uint32_t index = static_cast<uint32_t>(materials.size());
+	materials.push_back(material);
+	sameHashMaterials.push_back(index);
+	return index;
+}
+
+const RenderMaterial& RenderQueue::getMaterial(uint32_t material) const
+{
+	return materials[material];
+}
+
+void RenderQueue::add(const DrawItem& item)
+{
+	items.push_back(QueuedItem{ item, static_cast<uint32_t>(constants.size()), 0 });
+	keys.push_back(makeSortKey(item));
+}
+
+void RenderQueue::setConstant(UniformHandle handle, int value)
+{
+	addConstant(handle, Constant::Type::INT).intValue = value;
+}
+
+void RenderQueue::setConstant(UniformHandle handle, float value)
+{
+	addConstant(handle, Constant::Type::FLOAT).floatValues[0] = value;
+}
+
+void RenderQueue::setConstant(UniformHandle handle, const glm::vec3& value)
+{
+	std::memcpy(addConstant(handle, Constant::Type::VEC3).floatValues, glm::value_ptr(value), sizeof(value));
+}
+
+void RenderQueue::setConstant(UniformHandle handle, const glm::vec4& value)
+{
+	std::memcpy(addConstant(handle, Constant::Type::VEC4).floatValues, glm::value_ptr(value), sizeof(value));
+}
+
+void RenderQueue::setConstant(UniformHandle handle, const glm::mat3& value)
+{
+	std::memcpy(addConstant(handle, Constant::Type::MAT3).floatValues, glm::value_ptr(value), sizeof(value));
+}
+
+void RenderQueue::setConstant(UniformHandle handle, const glm::mat4& value)
+{
+	std::memcpy(addConstant(handle, Constant::Type::MAT4).floatValues, glm::value_ptr(value), sizeof(value));
+}
+
+void RenderQueue::setSortEnabled(bool enabled)
+{
+	isSortEnabled = enabled;
+}
+
+void RenderQueue::submit()
+{
+	stats = {};
+	order.resize(items.size());
+	for (uint32_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	if (isSortEnabled)
+	{
+		radixSort(keys, order, tmpKeys, tmpOrder);
+	}
+
+	// 0 is never a valid program or VAO of a draw, so the first binds are always issued
+	unsigned int currentProgram = 0;
+	unsigned int currentVAO = 0;
+	uint32_t currentMaterial = NO_MATERIAL;
+	std::array<unsigned int, MAX_TEXTURE_UNITS> boundTextures;
+	boundTextures.fill(std::numeric_limits<unsigned int>::max());
+	unsigned int activeUnit = std::numeric_limits<unsigned int>::max();
+
+	for (const uint32_t index : order)
+	{
+		const QueuedItem& queued = items[index];
+		const DrawItem& item = queued.item;
+
+		const unsigned int program = item.shader->getID();
+		if (program != currentProgram)
+		{
+			GLState::useProgram(program);
+			currentProgram = program;
+			stats.programSwitches++;
+		}
+
+		if (item.material != currentMaterial && item.material != NO_MATERIAL)
+		{
+			for (const TextureBinding& binding : materials[item.material].textures)
+			{
+				if (binding.unit < MAX_TEXTURE_UNITS && boundTextures[binding.unit] == binding.id)
+				{
+					continue;
+				}
+				if (binding.unit != activeUnit)
+				{
+					GLState::activeTexture(GL_TEXTURE0 + binding.unit);
+					activeUnit = binding.unit;
+				}
+				GLState::bindTexture(binding.target, binding.id);
+				if (binding.unit < MAX_TEXTURE_UNITS)
+				{
+					boundTextures[binding.unit] = binding.id;
+				}
+				stats.textureSwitches++;
+			}
+			currentMaterial = item.material;
+		}
+
+		if (item.VAO != currentVAO)
+		{
+			GLState::bindVertexArray(item.VAO);
+			currentVAO = item.VAO;
+			stats.vaoSwitches++;
+		}
+
+		for (uint32_t i = 0; i < queued.constantCount; i++)
+		{
+			setUniform(constants[queued.firstConstant + i]);
+		}
+
+		if (item.indexType == DrawItem::NO_INDICES)
+		{
+			glDrawArrays(item.mode, static_cast<GLint>(item.first), static_cast<GLsizei>(item.count));
+		}
+		else
+		{
+			const size_t indexSize = item.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : (item.indexType == GL_UNSIGNED_BYTE ? sizeof(uint8_t) : sizeof(uint32_t));
+			glDrawElements(item.mode, static_cast<GLsizei>(item.count), item.indexType, (void*)(item.first * indexSize));
+		}
+		stats.drawCalls++;
+	}
+
+	GLState::bindVertexArray(0);
+	if (activeUnit != 0)
+	{
+		GLState::activeTexture(GL_TEXTURE0);
+	}
+	clear();
+}
+
+void RenderQueue::clear()
+{
+	items.clear();
+	constants.clear();
+	keys.clear();
+}
+
+const RenderQueue::Stats& RenderQueue::getStats() const
+{
+	return stats;
+}
+
+void RenderQueue::showStats() const
+{
+	std::cout << "Render queue: " << stats.drawCalls << " draws, " << stats.programSwitches << " program switches, "
+		<< stats.textureSwitches << " texture switches, " << stats.vaoSwitches << " VAO switches" << std::endl;
+}
+
+void RenderQueue::radixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, std::vector<uint64_t>& tmpKeys, std::vector<uint32_t>& tmpValues)
+{
+	const size_t count = keys.size();
+	tmpKeys.resize(count);
+	tmpValues.resize(count);
+
+	// all the histograms in a single pass over the keys
+	std::array<std::array<uint32_t, 256>, 8> histograms = {};
+	for (const uint64_t key : keys)
+	{
+		for (unsigned int pass = 0; pass < 8; pass++)
+		{
+			histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+		}
+	}
+
+	for (unsigned int pass = 0; pass < 8; pass++)
+	{
+		std::array<uint32_t, 256>& histogram = histograms[pass];
+		const unsigned int shift = pass * 8;
+		if (count == 0 || histogram[(keys[0] >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (uint32_t& bucket : histogram)
+		{
+			const uint32_t bucketSize = bucket;
+			bucket = offset;
+			offset += bucketSize;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			const uint32_t destination = histogram[(keys[i] >> shift) & 0xFF]++;
+			tmpKeys[destination] = keys[i];
+			tmpValues[destination] = values[i];
+		}
+		keys.swap(tmpKeys);
+		values.swap(tmpValues);
+	}
+}
+
+uint64_t RenderQueue::makeSortKey(const DrawItem& item)
+{
+	const uint64_t layer = item.layer & ((1u << LAYER_BITS) - 1);
+	const uint64_t program = getSlot(programSlots, item.shader->getID(), PROGRAM_BITS);
+	const uint64_t material = item.material == NO_MATERIAL ? 0 : (item.material + 1) & ((1u << MATERIAL_BITS) - 1);
+	const uint64_t vao = getSlot(vaoSlots, item.VAO, VAO_BITS);
+
+	// the bits of a positive float keep its order
+	const float depth = item.depth > 0.0f ? item.depth : 0.0f;
+	uint32_t depthBits;
+	std::memcpy(&depthBits, &depth, sizeof(depthBits));
+	const uint64_t quantizedDepth = depthBits >> (32 - DEPTH_BITS);
+
+	return layer << (PROGRAM_BITS + MATERIAL_BITS + VAO_BITS + DEPTH_BITS)
+		| program << (MATERIAL_BITS + VAO_BITS + DEPTH_BITS)
+		| material << (VAO_BITS + DEPTH_BITS)
+		| vao << DEPTH_BITS
+		| quantizedDepth;
+}
+
+RenderQueue::Constant& RenderQueue::addConstant(UniformHandle handle, Constant::Type type)
+{
+	if (items.empty())
+	{
+		std::cout << "ERROR::RENDER_QUEUE: Constant set before any draw was added" << std::endl;
+		return discardedConstant;
+	}
+	items.back().constantCount++;
+	Constant& constant = constants.emplace_back();
+	constant.location = handle.location;
+	constant.type = type;
+	return constant;
+}
+
+uint32_t RenderQueue::getSlot(std::unordered_map<unsigned int, uint32_t>& slots, unsigned int name, unsigned int bits)
+{
+	// once the bits are exhausted several names share a slot, which only makes the sort less effective
+	const auto it = slots.try_emplace(name, static_cast<uint32_t>(slots.size())).first;
+	return it->second & ((1u << bits) - 1);
+}
+
+void RenderQueue::setUniform(const Constant& constant)
+{
+	if (constant.location == UniformHandle::UNUSED_LOCATION)
+	{
+		return;
+	}
+
+	switch (constant.type)
+	{
+	case Constant::Type::INT:
+		glUniform1i(constant.location, constant.intValue);
+		break;
+	case Constant::Type::FLOAT:
+		glUniform1f(constant.location, constant.floatValues[0]);
+		break;
+	case Constant::Type::VEC3:
+		glUniform3fv(constant.location, 1, constant.floatValues);
+		break;
+	case Constant::Type::VEC4:
+		glUniform4fv(constant.location, 1, constant.floatValues);
+		break;
+	case Constant::Type::MAT3:
+		glUniformMatrix3fv(constant.location, 1, GL_FALSE, constant.floatValues);
+		break;
+	case Constant::Type::MAT4:
+		glUniformMatrix4fv(constant.location, 1, GL_FALSE, constant.floatValues);
+		break;
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glad/glad.h"
+
+#include "shader.h"
+
+// Texture bound to a texture unit by a material
+struct TextureBinding {
+	unsigned int unit;
+	GLenum target;
+	unsigned int id;
+};
+
+// Set of textures shared by several draws, registered once with RenderQueue::addMaterial
+struct RenderMaterial {
+	std::vector<TextureBinding> textures;
+};
+
+// State and geometry of a single draw call, its uniforms are added right after it with RenderQueue::setConstant
+struct DrawItem {
+	static const GLenum NO_INDICES = 0;
+
+	uint8_t layer = 0; // drawn in increasing order, before sorting by state
+	const Shader* shader = nullptr;
+	uint32_t material = 0; // index returned by RenderQueue::addMaterial
+	unsigned int VAO = 0;
+	GLenum mode = GL_TRIANGLES;
+	GLenum indexType = NO_INDICES; // glDrawArrays is used without indices
+	unsigned int count = 0;
+	unsigned int first = 0; // first index or first vertex
+	float depth = 0.0f; // distance to the camera, the draws sharing the same state are sorted front to back
+};
+
+// Collects the draws of a frame, sorts them by a 64-bit key so that the draws sharing a program, material and VAO
+// are submitted together, then issues them without the binds which would not change the GL state.
+class RenderQueue {
+public:
+	// Bindings changed during the last submit
+	struct Stats {
+		unsigned int drawCalls;
+		unsigned int programSwitches;
+		unsigned int textureSwitches;
+		unsigned int vaoSwitches;
+	};
+
+	static const uint32_t NO_MATERIAL;
+
+	// Key layout, from the most significant bits: layer, program, material, VAO, depth
+	static const unsigned int LAYER_BITS = 4;
+	static const unsigned int PROGRAM_BITS = 10;
+	static const unsigned int MATERIAL_BITS = 14;
+	static const unsigned int VAO_BITS = 12;
+	static const unsigned int DEPTH_BITS = 24;
+
+	// Returns the index of an identical material if it was already added.
+	// The key keeps MATERIAL_BITS bits of the index: from 2^MATERIAL_BITS - 1 (16383) materials on, several materials
+	// share the same key bits, which is not reported and only makes the sort less effective, the right textures are still bound.
+	uint32_t addMaterial(const RenderMaterial& material);
+	const RenderMaterial& getMaterial(uint32_t material) const;
+
+	void add(const DrawItem& item);
+	// Uniforms of the last added draw, set right before it. Ignored, with an error, before the first add.
+	void setConstant(UniformHandle handle, int value);
+	void setConstant(UniformHandle handle, float value);
+	void setConstant(UniformHandle handle, const glm::vec3& value);
+	void setConstant(UniformHandle handle, const glm::vec4& value);
+	void setConstant(UniformHandle handle, const glm::mat3& value);
+	void setConstant(UniformHandle handle, const glm::mat4& value);
+
+	// Sorting can be disabled to compare with the submission order
+	void setSortEnabled(bool enabled);
+	// Sorts and issues the draws, then clears the queue. The GL state is not assumed, the first binds are always issued.
+	void submit();
+	void clear();
+	size_t size() const { return items.size(); }
+
+	const Stats& getStats() const;
+	void showStats() const;
+
+	// Least significant byte first radix sort of the (key, item index) pairs, passes on a byte shared by all keys are skipped
+	static void radixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, std::vector<uint64_t>& tmpKeys, std::vector<uint32_t>& tmpValues);
+private:
+	struct Constant {
+		enum class Type : uint8_t { INT, FLOAT, VEC3, VEC4, MAT3, MAT4 };
+
+		int location;
+		Type type;
+		union {
+			int intValue;
+			float floatValues[16];
+		};
+	};
+	struct QueuedItem {
+		DrawItem item;
+		uint32_t firstConstant;
+		uint32_t constantCount;
+	};
+
+	static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+	std::vector<RenderMaterial> materials;
+	std::unordered_map<uint64_t, std::vector<uint32_t>> materialsByHash;
+	// dense indices of the GL names, so that they fit in the key
+	std::unordered_map<unsigned int, uint32_t> programSlots;
+	std::unordered_map<unsigned int, uint32_t> vaoSlots;
+
+	std::vector<QueuedItem> items;
+	std::vector<Constant> constants;
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> order;
+	std::vector<uint64_t> tmpKeys;
+	std::vector<uint32_t> tmpOrder;
+	bool isSortEnabled = true;
+	Stats stats = {};
+	// written by the setConstant calls without any draw, never read
+	Constant discardedConstant = {};
+
+	uint64_t makeSortKey(const DrawItem& item);
+	Constant& addConstant(UniformHandle handle, Constant::Type type);
+	static uint32_t getSlot(std::unordered_map<unsigned int, uint32_t>& slots, unsigned int name, unsigned int bits);
+	static void setUniform(const Constant& constant);
+};
@@ -0,0 +1,150 @@
+#include "streamBuffer.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+StreamBuffer::StreamBuffer(size_t regionSize)
+	: buffer(0), mapping(nullptr), regionSize(0), region(0), head(0), fences(), stats()
+{
+	create(regionSize > 0 ? regionSize : 1);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	destroy();
+}
+
+void StreamBuffer::beginFrame()
+{
+	// the commands of the previous frame were all issued
+	if (fences[region] != 0)
+	{
+		glDeleteSync(fences[region]);
+	}
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	region = (region + 1) % FRAME_COUNT;
+	head = 0;
+	stats.frameBytes = 0;
+	GLsync fence = fences[region];
+	if (fence == 0)
+	{
+		return;
+	}
+	fences[region] = 0;
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		while (result == GL_TIMEOUT_EXPIRED)
+		{
+			result = glClientWaitSync(fence, 0, 1000000000);
+		}
+		stats.stalls++;
+		stats.stallTimeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	if (result == GL_WAIT_FAILED)
+	{
+		std::cout << "ERROR::STREAM_BUFFER: Failed to wait for the GPU" << std::endl;
+	}
+	glDeleteSync(fence);
+}
+
+void* StreamBuffer::allocate(size_t size, size_t alignment, size_t& offset)
+{
+	const size_t regionStart = region * regionSize;
+	size_t start = regionStart + head;
+	if (alignment > 1)
+	{
+		start = (start + alignment - 1) / alignment * alignment;
+	}
+	if (start + size > regionStart + regionSize)
+	{
+		// the frame's earlier data stays in the previous buffer, which is only released once the draws reading it are done
+		size_t newRegionSize = regionSize * 2;
+		while (newRegionSize < size + alignment)
+		{
+			newRegionSize *= 2;
+		}
+		destroy();
+		create(newRegionSize);
+		stats.reallocations++;
+		return allocate(size, alignment, offset);
+	}
+	offset = start;
+	if (mapping == nullptr)
+	{
+		return nullptr;
+	}
+	head = start + size - regionStart;
+	stats.frameBytes += size;
+	return mapping + start;
+}
+
+size_t StreamBuffer::write(const void* data, size_t size, size_t alignment)
+{
+	size_t offset = 0;
+	void* destination = allocate(size, alignment, offset);
+	if (destination != nullptr)
+	{
+		std::memcpy(destination, data, size);
+	}
+	return offset;
+}
+
+unsigned int StreamBuffer::getID() const
+{
+	return buffer;
+}
+
+size_t StreamBuffer::getRegionSize() const
+{
+	return regionSize;
+}
+
+const StreamBuffer::Stats& StreamBuffer::getStats() const
+{
+	return stats;
+}
+
+void StreamBuffer::showStats(const char* name) const
+{
+	std::cout << name << " stream buffer: " << stats.frameBytes / 1024.0 << " / " << regionSize / 1024.0 << " KB written, "
+		<< stats.stalls << " stalls (" << stats.stallTimeMs << " ms), " << stats.reallocations << " reallocations" << std::endl;
+}
+
+void StreamBuffer::create(size_t newRegionSize)
+{
+	regionSize = newRegionSize;
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &buffer);
+	glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(regionSize * FRAME_COUNT), nullptr, flags);
+	mapping = static_cast<unsigned char*>(glMapNamedBufferRange(buffer, 0, static_cast<GLsizeiptr>(regionSize * FRAME_COUNT), flags));
+	if (mapping == nullptr)
+	{
+		// reported once, the writes are then dropped
+		std::cout << "ERROR::STREAM_BUFFER: Failed to map the buffer of " << regionSize * FRAME_COUNT << " bytes" << std::endl;
+	}
+	head = 0;
+}
+
+void StreamBuffer::destroy()
+{
+	// nothing will be written to the regions of the previous buffer anymore
+	for (GLsync& fence : fences)
+	{
+		if (fence != 0)
+		{
+			glDeleteSync(fence);
+			fence = 0;
+		}
+	}
+	if (buffer != 0)
+	{
+		glUnmapNamedBuffer(buffer);
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+		mapping = nullptr;
+	}
+}
\ No newline at end of file
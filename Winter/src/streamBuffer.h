@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+
+#include "glad/glad.h"
+
+// Buffer for the data rewritten every frame, written through a persistent coherent mapping instead of glBufferSubData.
+// It is split into FRAME_COUNT regions used in turn, one per frame in flight: beginFrame fences the region of the
+// previous frame and waits for the fence of the region it reuses, which only blocks when the CPU is FRAME_COUNT
+// frames ahead of the GPU. These waits are counted as stalls.
+// A region grows when a frame writes more than it holds: the buffer is then reallocated, and getID changes.
+class StreamBuffer {
+public:
+	static constexpr unsigned int FRAME_COUNT = 3;
+
+	struct Stats {
+		unsigned int stalls;
+		double stallTimeMs;
+		unsigned int reallocations;
+		size_t frameBytes; // written during the last frame
+	};
+
+	explicit StreamBuffer(size_t regionSize);
+	~StreamBuffer();
+	StreamBuffer(const StreamBuffer& other) = delete;
+	StreamBuffer& operator=(const StreamBuffer& other) = delete;
+
+	// Starts writing to the next region, once per frame before its first write
+	void beginFrame();
+	// Returns the offset in the buffer of size bytes of the current region, aligned to alignment (which need not be a power of 2).
+	// The pointer is valid until the next allocation, which may reallocate the buffer. nullptr if the buffer could not be mapped.
+	void* allocate(size_t size, size_t alignment, size_t& offset);
+	// Copies the data to the current region and returns its offset, the data is dropped if the buffer could not be mapped
+	size_t write(const void* data, size_t size, size_t alignment = 1);
+
+	unsigned int getID() const;
+	size_t getRegionSize() const;
+	const Stats& getStats() const;
+	void showStats(const char* name) const;
+private:
+	unsigned int buffer;
+	unsigned char* mapping;
+	size_t regionSize;
+	// region of the current frame, and first free byte in it
+	unsigned int region;
+	size_t head;
+	// signaled once the GPU is done with the commands of the frame which last used the region, 0 if none
+	GLsync fences[FRAME_COUNT];
+	Stats stats;
+
+	void create(size_t newRegionSize);
+	void destroy();
+};
\ No newline at end of file
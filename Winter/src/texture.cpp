@@ -4,21 +4,43 @@
 #include "stb_image.h"
 #include "glad/glad.h"
 
+#include "glState.h"
+
 const std::string Texture::DIFFUSE_TYPENAME = "texture_diffuse";
 const std::string Texture::SPECULAR_TYPENAME = "texture_specular";
 const std::string Texture::NORMAL_TYPENAME = "texture_normal";
 
+void Texture::ImageDeleter::operator()(unsigned char* pixels) const
+{
+    stbi_image_free(pixels);
+}
+
 unsigned int Texture::loadTexture(const std::string& path, bool loadSRGB, GLenum wrap)
 {
-    stbi_set_flip_vertically_on_load(true);
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-    if (!data)
+    const ImageData image = decodeImage(path);
+    if (!image.pixels)
     {
-        std::cout << "Failed to load texture:" << path << std::endl;
         return -1;
     }
+    return uploadTexture(image, loadSRGB, wrap);
+}
 
+Texture::ImageData Texture::decodeImage(const std::string& path)
+{
+    // the flip flag is per thread, so images can be decoded on worker threads
+    stbi_set_flip_vertically_on_load_thread(true);
+    ImageData image;
+    image.pixels.reset(stbi_load(path.c_str(), &image.width, &image.height, &image.nrChannels, 0));
+    if (!image.pixels)
+    {
+        std::cout << "Failed to load texture:" << path << std::endl;
+    }
+    return image;
+}
+
+unsigned int Texture::uploadTexture(const ImageData& image, bool loadSRGB, GLenum wrap)
+{
+    const int nrChannels = image.nrChannels;
     GLenum internalFormat = GL_SRGB;
     GLenum format = GL_RGB;
     if (nrChannels == 1)
@@ -48,16 +70,15 @@ unsigned int Texture::loadTexture(const std::string& path, bool loadSRGB, GLenum
 
     unsigned int textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    GLState::bindTexture(GL_TEXTURE_2D, textureID);
     // set the texture wrapping/filtering options (on the currently bound texture object)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.get());
     glGenerateMipmap(GL_TEXTURE_2D);
-    stbi_image_free(data);
 
     return textureID;
 }
@@ -67,14 +88,14 @@ unsigned int Texture::loadCubemap(const std::vector<std::string>& faces)
 {
     unsigned int cubemapTexture;
     glGenTextures(1, &cubemapTexture);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
 
     int width, height, nbChannels;
     unsigned char* data;
 
 	// Cubemap textures are read from the top to the bottom, so we dont flip the image vertically
     // https://stackoverflow.com/questions/11685608/convention-of-faces-in-opengl-cubemapping
-    stbi_set_flip_vertically_on_load(false);
+    stbi_set_flip_vertically_on_load_thread(false);
     for (unsigned int i = 0; i < faces.size(); i++)
     {
         data = stbi_load(faces[i].c_str(), &width, &height, &nbChannels, 0);
@@ -95,14 +116,14 @@ unsigned int Texture::loadCubemap(const std::vector<std::string>& faces)
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
     return cubemapTexture;
 }
 
 unsigned int Texture::loadHDR(const std::string& path)
 {
-    stbi_set_flip_vertically_on_load(true);
+    stbi_set_flip_vertically_on_load_thread(true);
     int width, height, nrComponents;
     float* data = stbi_loadf(path.c_str(), &width, &height, &nrComponents, 0);
     unsigned int hdrTexture;
@@ -113,7 +134,7 @@ unsigned int Texture::loadHDR(const std::string& path)
     }
 
     glGenTextures(1, &hdrTexture);
-    glBindTexture(GL_TEXTURE_2D, hdrTexture);
+    GLState::bindTexture(GL_TEXTURE_2D, hdrTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
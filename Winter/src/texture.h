@@ -1,18 +1,39 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "glad/glad.h"
 
+struct CachedTexture;
+
 struct Texture {
 	unsigned int id;
 	std::string type;
 	std::string path;
+	// keeps the texture alive when it comes from the TextureCache
+	std::shared_ptr<const CachedTexture> cacheReference;
 
 	static const std::string DIFFUSE_TYPENAME;
 	static const std::string SPECULAR_TYPENAME;
 	static const std::string NORMAL_TYPENAME;
+
+	struct ImageDeleter {
+		void operator()(unsigned char* pixels) const;
+	};
+	// Decoded image waiting for its upload, decodeImage does not use GL so it can run on any thread
+	struct ImageData {
+		int width = 0;
+		int height = 0;
+		int nrChannels = 0;
+		std::unique_ptr<unsigned char, ImageDeleter> pixels;
+
+		size_t getSize() const { return static_cast<size_t>(width) * height * nrChannels; }
+	};
+
     static unsigned int loadTexture(const std::string& path, bool loadSRGB = true, GLenum wrap = GL_REPEAT);
+	static ImageData decodeImage(const std::string& path);
+	static unsigned int uploadTexture(const ImageData& image, bool loadSRGB = true, GLenum wrap = GL_REPEAT);
 	static unsigned int loadCubemap(const std::vector<std::string>& faces);
 	static unsigned int loadHDR(const std::string& path);
 };
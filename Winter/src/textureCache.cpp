@@ -0,0 +1,194 @@
+#include "textureCache.h"
+
+#include <filesystem>
+#include <functional>
+#include <iostream>
+
+#include "glState.h"
+
+const unsigned int FAILED_TEXTURE_ID = static_cast<unsigned int>(-1);
+
+std::mutex TextureCache::mutex;
+std::unordered_map<TextureCache::Key, std::weak_ptr<const CachedTexture>, TextureCache::KeyHash> TextureCache::textures;
+std::vector<unsigned int> TextureCache::releasedTextures;
+size_t TextureCache::residentBytes = 0;
+std::atomic<uint64_t> TextureCache::hits = 0;
+std::atomic<uint64_t> TextureCache::misses = 0;
+
+size_t TextureCache::KeyHash::operator()(const Key& key) const
+{
+	size_t hash = std::hash<std::string>()(key.path);
+	hash ^= (static_cast<size_t>(key.wrap) << 1 | static_cast<size_t>(key.loadSRGB)) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+Texture TextureCache::acquire(const std::string& path, const std::string& typeName, bool loadSRGB, GLenum wrap)
+{
+	deleteReleasedTextures();
+
+	const Key key = makeKey(path, loadSRGB, wrap);
+	std::shared_ptr<const CachedTexture> texture;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		texture = findLocked(key);
+	}
+	if (!texture)
+	{
+		// a failed load is cached too, so that it is not retried by every mesh using it
+		const Texture::ImageData image = Texture::decodeImage(path);
+		unsigned int id = FAILED_TEXTURE_ID;
+		if (image.pixels)
+		{
+			id = Texture::uploadTexture(image, loadSRGB, wrap);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		texture = insertLocked(key, id, getResidentSize(image));
+	}
+	return Texture{ texture->id, typeName, path, texture };
+}
+
+std::shared_ptr<const CachedTexture> TextureCache::find(const std::string& path, bool loadSRGB, GLenum wrap)
+{
+	const Key key = makeKey(path, loadSRGB, wrap);
+	std::lock_guard<std::mutex> lock(mutex);
+	return findLocked(key);
+}
+
+std::shared_ptr<const CachedTexture> TextureCache::insert(const std::string& path, const Texture::ImageData& image, bool loadSRGB, GLenum wrap)
+{
+	deleteReleasedTextures();
+
+	const Key key = makeKey(path, loadSRGB, wrap);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const auto it = textures.find(key);
+		if (it != textures.end())
+		{
+			if (std::shared_ptr<const CachedTexture> texture = it->second.lock())
+			{
+				return texture;
+			}
+		}
+	}
+
+	unsigned int id = FAILED_TEXTURE_ID;
+	if (image.pixels)
+	{
+		id = Texture::uploadTexture(image, loadSRGB, wrap);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	return insertLocked(key, id, getResidentSize(image));
+}
+
+void TextureCache::deleteReleasedTextures()
+{
+	std::vector<unsigned int> ids;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ids.swap(releasedTextures);
+	}
+	if (!ids.empty())
+	{
+		GLState::deleteTextures(static_cast<GLsizei>(ids.size()), ids.data());
+	}
+}
+
+TextureCache::Stats TextureCache::getStats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return Stats{ hits, misses, textures.size(), residentBytes };
+}
+
+void TextureCache::showStats()
+{
+	const Stats stats = getStats();
+	std::cout << "Texture cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.residentCount << " textures, " 
+		<< stats.residentBytes / (1024.0 * 1024.0) << " MB resident" << std::endl;
+}
+
+TextureCache::Key TextureCache::makeKey(const std::string& path, bool loadSRGB, GLenum wrap)
+{
+	// the same file can be reached through different relative paths (e.g. "a/../b.png" and "b.png")
+	std::error_code error;
+	std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, error);
+	if (error)
+	{
+		canonicalPath = std::filesystem::path(path).lexically_normal();
+	}
+	return Key{ canonicalPath.generic_string(), loadSRGB, wrap };
+}
+
+size_t TextureCache::getResidentSize(const Texture::ImageData& image)
+{
+	if (!image.pixels)
+	{
+		return 0;
+	}
+	// the drivers store RGB as RGBA, plus a third for the mipmaps
+	const size_t bytesPerTexel = image.nrChannels == 3 ? 4 : image.nrChannels;
+	return static_cast<size_t>(image.width) * image.height * bytesPerTexel * 4 / 3;
+}
+
+std::shared_ptr<const CachedTexture> TextureCache::findLocked(const Key& key)
+{
+	const auto it = textures.find(key);
+	if (it != textures.end())
+	{
+		if (std::shared_ptr<const CachedTexture> texture = it->second.lock())
+		{
+			hits++;
+			return texture;
+		}
+	}
+	misses++;
+	return nullptr;
+}
+
+std::shared_ptr<const CachedTexture> TextureCache::insertLocked(const Key& key, unsigned int id, size_t sizeInBytes)
+{
+	// another thread may have loaded the same texture in the meantime, keep the first one
+	std::weak_ptr<const CachedTexture>& entry = textures[key];
+	if (std::shared_ptr<const CachedTexture> texture = entry.lock())
+	{
+		if (id != FAILED_TEXTURE_ID)
+		{
+			releasedTextures.push_back(id);
+		}
+		return texture;
+	}
+
+	std::shared_ptr<const CachedTexture> texture(new CachedTexture{ id, sizeInBytes, std::this_thread::get_id() },
+		[key](CachedTexture* texture) { release(key, texture); }
+	);
+	entry = texture;
+	residentBytes += sizeInBytes;
+	return texture;
+}
+
+void TextureCache::release(const Key& key, CachedTexture* texture)
+{
+	bool canDelete = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const auto it = textures.find(key);
+		if (it != textures.end() && it->second.expired())
+		{
+			textures.erase(it);
+		}
+		residentBytes -= texture->sizeInBytes;
+
+		canDelete = texture->glThread == std::this_thread::get_id();
+		if (!canDelete && texture->id != FAILED_TEXTURE_ID)
+		{
+			releasedTextures.push_back(texture->id);
+		}
+	}
+
+	if (canDelete && texture->id != FAILED_TEXTURE_ID)
+	{
+		GLState::deleteTextures(1, &texture->id);
+	}
+	delete texture;
+}
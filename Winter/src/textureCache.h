@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "glad/glad.h"
+
+#include "texture.h"
+
+// A texture owned by the TextureCache, the GL texture is deleted when the last reference is dropped
+struct CachedTexture {
+	unsigned int id;
+	size_t sizeInBytes;
+	std::thread::id glThread; // thread which created the texture, the only one allowed to delete it
+};
+
+// Shares the textures loaded from files, keyed by canonical path and load options.
+// The lookups can be done from any thread, the loads and uploads only from the thread owning the GL context.
+class TextureCache {
+public:
+	struct Stats {
+		uint64_t hits;
+		uint64_t misses;
+		size_t residentCount;
+		size_t residentBytes;
+	};
+
+	// Returns a texture referencing the cached GL texture, loads it on a miss
+	static Texture acquire(const std::string& path, const std::string& typeName, bool loadSRGB = true, GLenum wrap = GL_REPEAT);
+	// Returns nullptr on a miss, does not use GL
+	static std::shared_ptr<const CachedTexture> find(const std::string& path, bool loadSRGB = true, GLenum wrap = GL_REPEAT);
+	// Uploads an image decoded beforehand, returns the already cached texture if another load inserted it first
+	static std::shared_ptr<const CachedTexture> insert(const std::string& path, const Texture::ImageData& image, bool loadSRGB = true, GLenum wrap = GL_REPEAT);
+
+	// Deletes the textures released by other threads, called by acquire and insert
+	static void deleteReleasedTextures();
+
+	static Stats getStats();
+	static void showStats();
+private:
+	struct Key {
+		std::string path;
+		bool loadSRGB;
+		GLenum wrap;
+
+		bool operator==(const Key& other) const { return loadSRGB == other.loadSRGB && wrap == other.wrap && path == other.path; }
+	};
+	struct KeyHash {
+		size_t operator()(const Key& key) const;
+	};
+
+	static std::mutex mutex;
+	static std::unordered_map<Key, std::weak_ptr<const CachedTexture>, KeyHash> textures;
+	static std::vector<unsigned int> releasedTextures;
+	static size_t residentBytes;
+	static std::atomic<uint64_t> hits;
+	static std::atomic<uint64_t> misses;
+
+	static Key makeKey(const std::string& path, bool loadSRGB, GLenum wrap);
+	static size_t getResidentSize(const Texture::ImageData& image);
+	static std::shared_ptr<const CachedTexture> findLocked(const Key& key);
+	static std::shared_ptr<const CachedTexture> insertLocked(const Key& key, unsigned int id, size_t sizeInBytes);
+	static void release(const Key& key, CachedTexture* texture);
+};
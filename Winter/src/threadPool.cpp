@@ -0,0 +1,68 @@
+#include "threadPool.h"
+
+#include <algorithm>
+
+#include "traceRecorder.h"
+
+ThreadPool::ThreadPool(unsigned int nbThreads)
+	: workers(), jobs(), mutex(), jobAvailable(), isStopping(false)
+{
+	nbThreads = std::max(nbThreads, 1u);
+	workers.reserve(nbThreads);
+	for (unsigned int i = 0; i < nbThreads; i++)
+	{
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isStopping = true;
+	}
+	jobAvailable.notify_all();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+unsigned int ThreadPool::getThreadCount() const
+{
+	return static_cast<unsigned int>(workers.size());
+}
+
+ThreadPool& ThreadPool::getShared()
+{
+	static ThreadPool sharedPool;
+	return sharedPool;
+}
+
+unsigned int ThreadPool::getDefaultThreadCount()
+{
+	// keep one core for the render thread
+	const unsigned int nbCores = std::thread::hardware_concurrency();
+	return nbCores > 1 ? nbCores - 1 : 1;
+}
+
+void ThreadPool::workerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this]() { return isStopping || !jobs.empty(); });
+			// the remaining jobs are still run so that their futures are not left without a value
+			if (jobs.empty())
+			{
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop();
+		}
+		TraceScope scope("Job");
+		job();
+	}
+}
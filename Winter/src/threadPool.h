@@ -0,0 +1,48 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads running the submitted jobs in order, the jobs must not use GL
+class ThreadPool
+{
+public:
+	ThreadPool(unsigned int nbThreads = getDefaultThreadCount());
+	~ThreadPool();
+	ThreadPool(const ThreadPool& other) = delete;
+	ThreadPool& operator=(const ThreadPool& other) = delete;
+
+	template<typename Function>
+	auto submit(Function&& function) -> std::future<std::invoke_result_t<std::decay_t<Function>>>
+	{
+		using Result = std::invoke_result_t<std::decay_t<Function>>;
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+		std::future<Result> result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.emplace([task]() { (*task)(); });
+		}
+		jobAvailable.notify_one();
+		return result;
+	}
+
+	unsigned int getThreadCount() const;
+
+	// Pool shared by the engine's loaders, created on first use
+	static ThreadPool& getShared();
+	static unsigned int getDefaultThreadCount();
+private:
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	bool isStopping;
+
+	void workerLoop();
+};
@@ -0,0 +1,254 @@
+#include "traceRecorder.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "glad/glad.h"
+
+// tid of the GPU track, the threads are numbered from 1
+const unsigned int GPU_THREAD_ID = 0;
+
+std::atomic<bool> TraceRecorder::recording(false);
+std::atomic<unsigned int> TraceRecorder::recordingIndex(0);
+std::chrono::steady_clock::time_point TraceRecorder::startTime;
+int64_t TraceRecorder::gpuToCpuNs = 0;
+std::string TraceRecorder::path;
+unsigned int TraceRecorder::frameLimit = 0;
+unsigned int TraceRecorder::frames = 0;
+bool TraceRecorder::isFrameOpen = false;
+std::mutex TraceRecorder::buffersMutex;
+std::vector<std::unique_ptr<TraceRecorder::ThreadBuffer>> TraceRecorder::buffers;
+
+void TraceRecorder::start(const std::string& path, unsigned int frameCount)
+{
+	if (isRecording())
+	{
+		stop();
+	}
+	TraceRecorder::path = path;
+	frameLimit = frameCount;
+	frames = 0;
+	isFrameOpen = false;
+	startTime = std::chrono::steady_clock::now();
+	// the GPU timestamps are moved to the CPU clock, the drift over a recording is negligible
+	GLint64 gpuTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	gpuToCpuNs = now() - gpuTime;
+	recordingIndex++;
+	recording = true;
+	std::cout << "Trace recording started" << std::endl;
+}
+
+void TraceRecorder::stop()
+{
+	if (!isRecording())
+	{
+		return;
+	}
+	if (isFrameOpen)
+	{
+		endScope();
+		isFrameOpen = false;
+	}
+	recording = false;
+	write();
+}
+
+bool TraceRecorder::isRecording()
+{
+	return recording.load(std::memory_order_relaxed);
+}
+
+void TraceRecorder::toggle(const std::string& path, unsigned int frameCount)
+{
+	if (isRecording())
+	{
+		stop();
+	}
+	else
+	{
+		start(path, frameCount);
+	}
+}
+
+void TraceRecorder::beginScope(const char* name)
+{
+	if (isRecording())
+	{
+		record(name, 'B', now(), 0, 0.0);
+	}
+}
+
+void TraceRecorder::endScope()
+{
+	if (isRecording())
+	{
+		record(nullptr, 'E', now(), 0, 0.0);
+	}
+}
+
+void TraceRecorder::counter(const char* name, double value)
+{
+	if (isRecording())
+	{
+		record(name, 'C', now(), 0, value);
+	}
+}
+
+void TraceRecorder::gpuScope(const char* name, uint64_t gpuBeginNs, uint64_t gpuEndNs)
+{
+	// the results arrive a frame late, the ones of the frames before the recording started are left out
+	const int64_t timeNs = static_cast<int64_t>(gpuBeginNs) + gpuToCpuNs;
+	if (isRecording() && timeNs >= 0)
+	{
+		record(name, 'X', timeNs, static_cast<int64_t>(gpuEndNs - gpuBeginNs), 0.0);
+	}
+}
+
+void TraceRecorder::nextFrame()
+{
+	if (!isRecording())
+	{
+		return;
+	}
+	if (isFrameOpen)
+	{
+		endScope();
+		frames++;
+		if (frameLimit != 0 && frames >= frameLimit)
+		{
+			isFrameOpen = false;
+			stop();
+			return;
+		}
+	}
+	beginScope("Frame");
+	isFrameOpen = true;
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::getThreadBuffer()
+{
+	thread_local ThreadBuffer* threadBuffer = nullptr;
+	if (threadBuffer == nullptr)
+	{
+		// once per thread, the buffers are kept after their thread ends until the process exits
+		std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+		buffer->recording = 0;
+		buffer->events = std::make_unique<Event[]>(THREAD_CAPACITY);
+		buffer->count = 0;
+		buffer->dropped = 0;
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		buffer->threadID = static_cast<unsigned int>(buffers.size()) + 1;
+		threadBuffer = buffer.get();
+		buffers.push_back(std::move(buffer));
+	}
+	return *threadBuffer;
+}
+
+void TraceRecorder::record(const char* name, char phase, int64_t timeNs, int64_t durationNs, double value)
+{
+	ThreadBuffer& buffer = getThreadBuffer();
+	const unsigned int currentRecording = recordingIndex.load(std::memory_order_relaxed);
+	if (buffer.recording.load(std::memory_order_relaxed) != currentRecording)
+	{
+		buffer.recording.store(currentRecording, std::memory_order_relaxed);
+		buffer.count.store(0, std::memory_order_relaxed);
+		buffer.dropped.store(0, std::memory_order_relaxed);
+	}
+	const size_t count = buffer.count.load(std::memory_order_relaxed);
+	if (count == THREAD_CAPACITY)
+	{
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	Event& event = buffer.events[count];
+	event.name = name;
+	event.timeNs = timeNs;
+	if (phase == 'C')
+	{
+		event.value = value;
+	}
+	else
+	{
+		event.durationNs = durationNs;
+	}
+	event.phase = phase;
+	// the event is complete before the writer can see it
+	buffer.count.store(count + 1, std::memory_order_release);
+}
+
+int64_t TraceRecorder::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void TraceRecorder::write()
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "ERROR::TRACE_RECORDER: Failed to open " << path << std::endl;
+		return;
+	}
+	// the times are in microseconds, with a nanosecond precision
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << GPU_THREAD_ID << ",\"args\":{\"name\":\"GPU\"}}";
+
+	size_t eventCount = 0;
+	size_t droppedCount = 0;
+	const unsigned int currentRecording = recordingIndex.load(std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	for (const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+	{
+		// a thread which recorded nothing still holds the events of an earlier recording
+		const size_t count = buffer->count.load(std::memory_order_acquire);
+		if (buffer->recording.load(std::memory_order_relaxed) != currentRecording || count == 0)
+		{
+			continue;
+		}
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->threadID
+			<< ",\"args\":{\"name\":\"Thread " << buffer->threadID << "\"}}";
+		for (size_t i = 0; i < count; i++)
+		{
+			const Event& event = buffer->events[i];
+			const unsigned int threadID = event.phase == 'X' ? GPU_THREAD_ID : buffer->threadID;
+			file << ",\n{\"ph\":\"" << event.phase << "\",\"pid\":0,\"tid\":" << threadID << ",\"ts\":" << event.timeNs / 1000.0;
+			if (event.name != nullptr)
+			{
+				file << ",\"name\":\"" << event.name << "\"";
+			}
+			if (event.phase == 'X')
+			{
+				file << ",\"dur\":" << event.durationNs / 1000.0;
+			}
+			else if (event.phase == 'C')
+			{
+				file << ",\"args\":{\"value\":" << event.value << "}";
+			}
+			file << "}";
+		}
+		eventCount += count;
+		droppedCount += buffer->dropped.load(std::memory_order_relaxed);
+	}
+	file << "\n]}\n";
+	std::cout << "Trace of " << frames << " frames written to " << path << ": " << eventCount << " events, " << droppedCount << " dropped" << std::endl;
+}
+
+TraceScope::TraceScope(const char* name)
+	: isRecorded(TraceRecorder::isRecording())
+{
+	if (isRecorded)
+	{
+		TraceRecorder::beginScope(name);
+	}
+}
+
+TraceScope::~TraceScope()
+{
+	if (isRecorded)
+	{
+		TraceRecorder::endScope();
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Records a timeline of scopes, counters and GPU times, written as Chrome Trace Event JSON (chrome://tracing, ui.perfetto.dev).
+// Every thread appends to its own fixed size buffer without locking, the events past its capacity are dropped and counted.
+// The names are kept by pointer until the trace is written, they must be string literals.
+// Nothing is recorded outside of start and stop, which are called from the thread owning the GL context, like nextFrame.
+class TraceRecorder {
+public:
+	static const unsigned int DEFAULT_FRAME_COUNT = 300;
+
+	// Records until stop, or until frameCount frames have ended if not 0, then writes the trace to path
+	static void start(const std::string& path, unsigned int frameCount = 0);
+	static void stop();
+	static bool isRecording();
+	// Starts recording if it is not, stops it otherwise, e.g. on a key press
+	static void toggle(const std::string& path, unsigned int frameCount = 0);
+
+	static void beginScope(const char* name);
+	static void endScope();
+	static void counter(const char* name, double value);
+	// GPU times from glQueryCounter timestamps, on their own track
+	static void gpuScope(const char* name, uint64_t gpuBeginNs, uint64_t gpuEndNs);
+
+	// Frame boundary: ends the frame scope and starts the next one
+	static void nextFrame();
+private:
+	static const size_t THREAD_CAPACITY = 1 << 15;
+
+	struct Event {
+		const char* name;
+		int64_t timeNs; // since the start of the recording
+		union {
+			int64_t durationNs; // GPU scope
+			double value; // counter
+		};
+		char phase; // 'B', 'E', 'C' or 'X'
+	};
+
+	struct ThreadBuffer {
+		unsigned int threadID;
+		// recording the events were written in, the buffer is emptied by its thread when a new recording starts
+		std::atomic<unsigned int> recording;
+		std::unique_ptr<Event[]> events;
+		// events published to the writer
+		std::atomic<size_t> count;
+		std::atomic<size_t> dropped;
+	};
+
+	static std::atomic<bool> recording;
+	static std::atomic<unsigned int> recordingIndex;
+	static std::chrono::steady_clock::time_point startTime;
+	static int64_t gpuToCpuNs;
+	static std::string path;
+	static unsigned int frameLimit;
+	static unsigned int frames;
+	static bool isFrameOpen;
+
+	static std::mutex buffersMutex;
+	static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+	static ThreadBuffer& getThreadBuffer();
+	static void record(const char* name, char phase, int64_t timeNs, int64_t durationNs, double value);
+	static int64_t now();
+	static void write();
+};
+
+// Records the enclosing block as a scope
+class TraceScope {
+public:
+	explicit TraceScope(const char* name);
+	~TraceScope();
+	TraceScope(const TraceScope& other) = delete;
+	TraceScope& operator=(const TraceScope& other) = delete;
+private:
+	bool isRecorded;
+};
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+
 #include "glm/glm.hpp"
 
 struct Vertex {
@@ -6,3 +8,10 @@ struct Vertex {
 	glm::vec3 Normal;
 	glm::vec2 TexCoords;
 };
+
+// Half the size of Vertex, see VertexPacking
+struct PackedVertex {
+	uint16_t Position[4]; // unsigned normalized, relative to the AABB of the mesh (w is padding)
+	int16_t Normal[2]; // signed normalized, octahedral encoding
+	uint16_t TexCoords[2]; // half floats
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "vertexLayout.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "glm/gtc/packing.hpp"
+
+void VertexLayout::apply() const
+{
+	for (const VertexAttribute& attribute : attributes)
+	{
+		glEnableVertexAttribArray(attribute.location);
+		glVertexAttribPointer(attribute.location, attribute.nbComponents, attribute.type, attribute.isNormalized ? GL_TRUE : GL_FALSE, stride, (void*)attribute.offset);
+	}
+}
+
+const VertexLayout& VertexLayout::get(VertexFormat format)
+{
+	static const VertexLayout FLOAT_LAYOUT = {
+		VertexFormat::FLOAT,
+		sizeof(Vertex),
+		{
+			{ 0, 3, GL_FLOAT, false, offsetof(Vertex, Position) },
+			{ 1, 3, GL_FLOAT, false, offsetof(Vertex, Normal) },
+			{ 2, 2, GL_FLOAT, false, offsetof(Vertex, TexCoords) },
+		}
+	};
+	static const VertexLayout PACKED_LAYOUT = {
+		VertexFormat::PACKED,
+		sizeof(PackedVertex),
+		{
+			{ 0, 3, GL_UNSIGNED_SHORT, true, offsetof(PackedVertex, Position) },
+			{ 1, 2, GL_SHORT, true, offsetof(PackedVertex, Normal) },
+			{ 2, 2, GL_HALF_FLOAT, false, offsetof(PackedVertex, TexCoords) },
+		}
+	};
+
+	return format == VertexFormat::PACKED ? PACKED_LAYOUT : FLOAT_LAYOUT;
+}
+
+PositionDequantization VertexPacking::computeDequantization(const std::vector<Vertex>& vertices)
+{
+	if (vertices.empty())
+	{
+		return PositionDequantization{ glm::vec3(0.0f), glm::vec3(1.0f) };
+	}
+
+	glm::vec3 min = vertices[0].Position;
+	glm::vec3 max = vertices[0].Position;
+	for (const Vertex& vertex : vertices)
+	{
+		min = glm::min(min, vertex.Position);
+		max = glm::max(max, vertex.Position);
+	}
+	glm::vec3 scale = max - min;
+	// a flat axis still needs a valid scale
+	for (int i = 0; i < 3; i++)
+	{
+		if (scale[i] <= 0.0f)
+		{
+			scale[i] = 1.0f;
+		}
+	}
+	return PositionDequantization{ min, scale };
+}
+
+PackedVertex VertexPacking::packVertex(const Vertex& vertex, const PositionDequantization& dequantization)
+{
+	PackedVertex packed;
+	const glm::vec3 position = glm::clamp((vertex.Position - dequantization.offset) / dequantization.scale, 0.0f, 1.0f);
+	for (int i = 0; i < 3; i++)
+	{
+		packed.Position[i] = static_cast<uint16_t>(std::round(position[i] * 65535.0f));
+	}
+	packed.Position[3] = 0;
+
+	const glm::vec2 normal = encodeOctahedral(vertex.Normal);
+	for (int i = 0; i < 2; i++)
+	{
+		packed.Normal[i] = static_cast<int16_t>(std::round(glm::clamp(normal[i], -1.0f, 1.0f) * 32767.0f));
+		packed.TexCoords[i] = glm::packHalf1x16(vertex.TexCoords[i]);
+	}
+	return packed;
+}
+
+std::vector<PackedVertex> VertexPacking::packVertices(const std::vector<Vertex>& vertices, const PositionDequantization& dequantization)
+{
+	std::vector<PackedVertex> packedVertices;
+	packedVertices.reserve(vertices.size());
+	for (const Vertex& vertex : vertices)
+	{
+		packedVertices.push_back(packVertex(vertex, dequantization));
+	}
+	return packedVertices;
+}
+
+glm::vec2 VertexPacking::encodeOctahedral(const glm::vec3& normal)
+{
+	const float l1Norm = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (l1Norm <= 0.0f)
+	{
+		return glm::vec2(0.0f);
+	}
+	glm::vec2 encoded = glm::vec2(normal.x, normal.y) / l1Norm;
+	if (normal.z < 0.0f)
+	{
+		const glm::vec2 signs(encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f);
+		encoded = (glm::vec2(1.0f) - glm::vec2(std::abs(encoded.y), std::abs(encoded.x))) * signs;
+	}
+	return encoded;
+}
+
+glm::vec3 VertexPacking::decodeOctahedral(const glm::vec2& encoded)
+{
+	glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+	const float t = std::max(-normal.z, 0.0f);
+	normal.x += normal.x >= 0.0f ? -t : t;
+	normal.y += normal.y >= 0.0f ? -t : t;
+	return glm::normalize(normal);
+}
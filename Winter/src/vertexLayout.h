@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "vertex.h"
+
+enum class VertexFormat {
+	FLOAT, // Vertex, 32 bits indices
+	PACKED // PackedVertex, 16 bits indices when the mesh has less than 65536 vertices
+};
+
+struct VertexAttribute {
+	unsigned int location;
+	int nbComponents;
+	GLenum type;
+	bool isNormalized;
+	size_t offset;
+};
+
+// Attributes of the vertex buffer of a mesh, the locations are the same for every format (0: position, 1: normal, 2: texture coords)
+struct VertexLayout {
+	VertexFormat format;
+	unsigned int stride;
+	std::vector<VertexAttribute> attributes;
+
+	// Sets the attribute pointers of the bound VAO for the bound GL_ARRAY_BUFFER
+	void apply() const;
+
+	static const VertexLayout& get(VertexFormat format);
+};
+
+// The shaders get back the position with: position = packedPosition * scale + offset
+struct PositionDequantization {
+	glm::vec3 offset;
+	glm::vec3 scale;
+};
+
+class VertexPacking {
+public:
+	static PositionDequantization computeDequantization(const std::vector<Vertex>& vertices);
+	static PackedVertex packVertex(const Vertex& vertex, const PositionDequantization& dequantization);
+	static std::vector<PackedVertex> packVertices(const std::vector<Vertex>& vertices, const PositionDequantization& dequantization);
+
+	// Maps the unit sphere on a square by folding the lower half of an octahedron over the upper half, result in [-1, 1]
+	static glm::vec2 encodeOctahedral(const glm::vec3& normal);
+	static glm::vec3 decodeOctahedral(const glm::vec2& encoded);
+};